@@ -0,0 +1,210 @@
+#include "api/SuperZ80Api.h"
+
+#include <new>
+
+#include "console/SuperZ80Console.h"
+#include "devices/apu/APU.h"
+#include "devices/bus/Bus.h"
+#include "devices/input/InputController.h"
+
+// The opaque handle is the console itself; no wrapper state is needed.
+struct sz_console : sz::console::SuperZ80Console {};
+
+namespace {
+bool MakeWatchpoint(int kind, uint16_t first, uint16_t last, sz::bus::Watchpoint& out) {
+  if (kind < SZ_WATCH_READ || kind > SZ_WATCH_OUT) {
+    return false;
+  }
+  out.kind = static_cast<sz::bus::WatchKind>(kind);
+  out.first = first;
+  out.last = last;
+  return true;
+}
+}  // namespace
+
+extern "C" {
+
+int sz_api_version(void) {
+  return SZ_API_VERSION;
+}
+
+sz_console* sz_create(void) {
+  sz_console* console = new (std::nothrow) sz_console();
+  if (!console) {
+    return nullptr;
+  }
+  console->PowerOn();
+  console->Reset();
+  return console;
+}
+
+void sz_destroy(sz_console* console) {
+  delete console;
+}
+
+int sz_load_rom(sz_console* console, const uint8_t* data, size_t size) {
+  if (!console || !data) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  if (!console->LoadCartridge(data, size)) {
+    return SZ_ERROR_ROM;
+  }
+  console->Reset();
+  return SZ_OK;
+}
+
+int sz_reset(sz_console* console) {
+  if (!console) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->Reset();
+  return SZ_OK;
+}
+
+int sz_step_frames(sz_console* console, uint32_t frames) {
+  if (!console) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  for (uint32_t i = 0; i < frames; ++i) {
+    console->StepFrame();
+    if (console->IsStopped()) {
+      return SZ_STOPPED;
+    }
+  }
+  return SZ_OK;
+}
+
+uint64_t sz_frame_count(const sz_console* console) {
+  return console ? console->GetDebugState().frame : 0;
+}
+
+int sz_set_pad(sz_console* console, int pad, uint8_t buttons) {
+  if (!console || pad < 0 || pad >= sz::input::kPadCount) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->SetHostButtons(pad, sz::input::UnpackButtons(buttons));
+  return SZ_OK;
+}
+
+int sz_add_breakpoint(sz_console* console, uint16_t pc) {
+  if (!console) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->AddBreakpoint(pc);
+  return SZ_OK;
+}
+
+int sz_remove_breakpoint(sz_console* console, uint16_t pc) {
+  if (!console) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->RemoveBreakpoint(pc);
+  return SZ_OK;
+}
+
+int sz_add_watchpoint(sz_console* console, int kind, uint16_t first, uint16_t last) {
+  sz::bus::Watchpoint watch;
+  if (!console || !MakeWatchpoint(kind, first, last, watch) || !console->AddWatchpoint(watch)) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  return SZ_OK;
+}
+
+int sz_remove_watchpoint(sz_console* console, int kind, uint16_t first, uint16_t last) {
+  sz::bus::Watchpoint watch;
+  if (!console || !MakeWatchpoint(kind, first, last, watch)) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->RemoveWatchpoint(watch);
+  return SZ_OK;
+}
+
+int sz_clear_breakpoints(sz_console* console) {
+  if (!console) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  console->ClearBreakpoints();
+  return SZ_OK;
+}
+
+int sz_stop_info(const sz_console* console, int* kind, uint16_t* pc, uint16_t* address, uint8_t* value) {
+  if (!console || !console->IsStopped()) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  const sz::cpu::StopInfo stop = console->GetStopInfo();
+  if (kind) {
+    *kind = stop.watchpoint ? static_cast<int>(stop.hit.kind) : SZ_STOP_BREAKPOINT;
+  }
+  if (pc) {
+    *pc = stop.pc;
+  }
+  if (address) {
+    *address = stop.watchpoint ? stop.hit.address : 0;
+  }
+  if (value) {
+    *value = stop.watchpoint ? stop.hit.value : 0;
+  }
+  return SZ_OK;
+}
+
+size_t sz_state_size(const sz_console* console) {
+  return console ? console->GetSaveStateSize() : 0;
+}
+
+int sz_save_state(const sz_console* console, uint8_t* buffer, size_t size) {
+  if (!console || !buffer) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  if (console->IsStopped()) {
+    return SZ_ERROR_STATE;
+  }
+  return console->SaveState(buffer, size) ? SZ_OK : SZ_ERROR_BUFFER;
+}
+
+int sz_load_state(sz_console* console, const uint8_t* data, size_t size) {
+  if (!console || !data) {
+    return SZ_ERROR_ARGUMENT;
+  }
+  return console->LoadState(data, size) ? SZ_OK : SZ_ERROR_STATE;
+}
+
+const uint32_t* sz_framebuffer(const sz_console* console, int* width, int* height) {
+  if (!console) {
+    return nullptr;
+  }
+  const sz::ppu::Framebuffer& fb = console->GetFramebuffer();
+  if (width) {
+    *width = fb.width;
+  }
+  if (height) {
+    *height = fb.height;
+  }
+  return fb.pixels.data();
+}
+
+const int16_t* sz_audio(const sz_console* console, size_t* sample_count) {
+  if (!console) {
+    return nullptr;
+  }
+  const auto& samples = console->GetAudioSamples();
+  if (sample_count) {
+    *sample_count = samples.size();
+  }
+  return samples.data();
+}
+
+int sz_audio_sample_rate(void) {
+  return sz::apu::kSampleRate;
+}
+
+uint8_t* sz_work_ram(sz_console* console, size_t* size) {
+  if (!console) {
+    return nullptr;
+  }
+  if (size) {
+    *size = sz::bus::kWorkRamSize;
+  }
+  return console->GetWorkRam();
+}
+
+}  // extern "C"
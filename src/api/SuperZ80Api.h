@@ -0,0 +1,111 @@
+#ifndef SUPERZ80_API_SUPERZ80API_H
+#define SUPERZ80_API_SUPERZ80API_H
+
+/*
+ * C ABI for embedding the emulator (libsuperz80). Plain C89-compatible
+ * declarations so it can be loaded through ctypes/cffi or any FFI.
+ *
+ * Threading: a console handle is not thread-safe, but independent handles
+ * may be driven from different threads.
+ *
+ * Zero-copy views (framebuffer, audio, work RAM) point into the console and
+ * stay valid until the next sz_step_frames, sz_reset, sz_load_rom,
+ * sz_load_state or sz_destroy on the same handle.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(SUPERZ80_API_BUILD)
+#define SZ_API __declspec(dllexport)
+#else
+#define SZ_API __declspec(dllimport)
+#endif
+#else
+#define SZ_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the functions below. */
+#define SZ_API_VERSION 1
+
+/* Return codes. */
+#define SZ_OK 0
+#define SZ_ERROR_ARGUMENT (-1) /* null handle/buffer or out-of-range value */
+#define SZ_ERROR_BUFFER (-2)   /* caller buffer too small */
+#define SZ_ERROR_ROM (-3)      /* image empty or too large */
+#define SZ_ERROR_STATE (-4)    /* snapshot rejected (version, size, corrupt) */
+#define SZ_STOPPED 1           /* sz_step_frames hit a breakpoint or watchpoint */
+
+/* Watchpoint kinds for sz_add_watchpoint and sz_stop_info. */
+#define SZ_WATCH_READ 0
+#define SZ_WATCH_WRITE 1
+#define SZ_WATCH_IN 2  /* port range 0x00-0xFF */
+#define SZ_WATCH_OUT 3
+#define SZ_STOP_BREAKPOINT (-1)
+
+/* Pad bits for sz_set_pad. */
+#define SZ_PAD_UP 0x01
+#define SZ_PAD_DOWN 0x02
+#define SZ_PAD_LEFT 0x04
+#define SZ_PAD_RIGHT 0x08
+#define SZ_PAD_A 0x10
+#define SZ_PAD_B 0x20
+#define SZ_PAD_START 0x40
+#define SZ_PAD_SELECT 0x80
+
+typedef struct sz_console sz_console;
+
+SZ_API int sz_api_version(void);
+
+/* Powered on with no cartridge; NULL on allocation failure. */
+SZ_API sz_console* sz_create(void);
+SZ_API void sz_destroy(sz_console* console);
+
+/* Copies the image and resets the console to its reset vector. */
+SZ_API int sz_load_rom(sz_console* console, const uint8_t* data, size_t size);
+SZ_API int sz_reset(sz_console* console);
+/* Returns SZ_STOPPED, without finishing the frames, at the first
+ * breakpoint or watchpoint hit; the next call resumes from there. */
+SZ_API int sz_step_frames(sz_console* console, uint32_t frames);
+SZ_API uint64_t sz_frame_count(const sz_console* console);
+
+/* pad is 0 or 1; buttons is a mask of SZ_PAD_* bits, held until changed. */
+SZ_API int sz_set_pad(sz_console* console, int pad, uint8_t buttons);
+
+/* Debugging. Breakpoints stop before the instruction at pc runs;
+ * watchpoints stop after the instruction that made the access. Ranges are
+ * inclusive. With nothing armed, stepping runs at full speed. */
+SZ_API int sz_add_breakpoint(sz_console* console, uint16_t pc);
+SZ_API int sz_remove_breakpoint(sz_console* console, uint16_t pc);
+SZ_API int sz_add_watchpoint(sz_console* console, int kind, uint16_t first, uint16_t last);
+SZ_API int sz_remove_watchpoint(sz_console* console, int kind, uint16_t first, uint16_t last);
+SZ_API int sz_clear_breakpoints(sz_console* console);
+/* After SZ_STOPPED: kind is SZ_STOP_BREAKPOINT or an SZ_WATCH_* value;
+ * address and value describe the watched access. Any out pointer may be
+ * NULL. SZ_ERROR_ARGUMENT when the console is not stopped. */
+SZ_API int sz_stop_info(const sz_console* console, int* kind, uint16_t* pc, uint16_t* address, uint8_t* value);
+
+/* Snapshots are written to and read from caller-owned memory. A console
+ * stopped inside a frame cannot be saved (SZ_ERROR_STATE). */
+SZ_API size_t sz_state_size(const sz_console* console);
+SZ_API int sz_save_state(const sz_console* console, uint8_t* buffer, size_t size);
+SZ_API int sz_load_state(sz_console* console, const uint8_t* data, size_t size);
+
+/* ARGB8888, row-major, width * height pixels with no padding. */
+SZ_API const uint32_t* sz_framebuffer(const sz_console* console, int* width, int* height);
+/* Mono signed 16-bit samples produced by the last frame. */
+SZ_API const int16_t* sz_audio(const sz_console* console, size_t* sample_count);
+SZ_API int sz_audio_sample_rate(void);
+/* 32 KB work RAM; offset 0 is CPU address 0xC000. Writable between steps. */
+SZ_API uint8_t* sz_work_ram(sz_console* console, size_t* size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,7 +5,9 @@
 #include <SDL.h>
 
 #include "core/config.h"
+#include "core/log/ChromeTrace.h"
 #include "core/log/Logger.h"
+#include "core/log/TraceFile.h"
 #include "core/types.h"
 #include "core/util/Assert.h"
 
@@ -15,6 +17,8 @@ namespace {
 constexpr u32 kBarColors[8] = {
     0xFFFF0000u, 0xFFFF8000u, 0xFFFFFF00u, 0xFF00FF00u,
     0xFF00FFFFu, 0xFF0000FFu, 0xFF8000FFu, 0xFFFFFFFFu};
+
+constexpr u64 kDefaultHeadlessFrames = 600;
 }
 
 App::App(const AppConfig& config) : config_(config) {
@@ -24,21 +28,51 @@ int App::Run() {
   SZ_LOG_INFO("%s v%d.%d.%d", SUPERZ80_APP_NAME, SUPERZ80_VERSION_MAJOR,
               SUPERZ80_VERSION_MINOR, SUPERZ80_VERSION_PATCH);
 
+  if (config_.headless) {
+    return RunHeadless();
+  }
+
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
     SZ_LOG_ERROR("SDL_Init failed: %s", SDL_GetError());
     return 1;
   }
 
-  if (!sdl_.Init(SUPERZ80_APP_NAME, kScreenWidth, kScreenHeight, config_.scale)) {
+  if (!sdl_.Init(SUPERZ80_APP_NAME, kScreenWidth, kScreenHeight, config_.scale, config_.vsync)) {
     SDL_Quit();
     return 1;
   }
 
-  if (!console_.PowerOn()) {
+  if (!PowerOnConsole()) {
+    sdl_.Shutdown();
     SDL_Quit();
     return 1;
   }
-  console_.Reset();
+
+  if (!StartMovie() || !StartTrace() || !StartCapture()) {
+    sdl_.Shutdown();
+    SDL_Quit();
+    return 1;
+  }
+
+  presenter_.Init(sdl_, config_.upscale_filter, config_.upscale_threads);
+  input_.Init();
+  // Movies capture input per frame, so only free play samples pads live.
+  if (!recording_ && !replaying_) {
+    console_.SetPadSampler(&InputHost::SamplePad, &input_);
+  }
+
+  // Speculative frames would interleave with the real ones in a CPU trace.
+  if (config_.run_ahead_frames > 0 && exec_trace_.IsOpen()) {
+    SZ_LOG_WARN("--cpu-trace: run-ahead disabled while tracing");
+  } else {
+    run_ahead_.Start(config_.run_ahead_frames, config_.run_ahead_second_core, console_);
+  }
+
+  // Rewinding would fork the timeline a movie describes.
+  if (config_.rewind_interval_frames > 0 && !recording_ && !replaying_) {
+    rewind_.Start(console_.GetSaveStateSize(),
+                  static_cast<size_t>(config_.rewind_budget_mb) * 1024 * 1024);
+  }
 
 #if defined(SUPERZ80_ENABLE_IMGUI)
   if (config_.enable_imgui) {
@@ -46,8 +80,18 @@ int App::Run() {
   }
 #endif
 
+  if (config_.audio_latency_ms > 0) {
+    audio_.Open(sz::apu::kSampleRate, config_.audio_latency_ms);
+  }
+  pacer_.Start(sdl_.GetRefreshRate(), config_.vsync);
+
+  stop_emulation_.store(false, std::memory_order_relaxed);
+  emulation_done_.store(false, std::memory_order_relaxed);
+  emulation_thread_ = std::thread(&App::EmulationMain, this);
+
   bool running = true;
   while (running) {
+    SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "host_frame");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
 #if defined(SUPERZ80_ENABLE_IMGUI)
@@ -59,44 +103,371 @@ int App::Run() {
         running = false;
       } else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
         running = false;
+      } else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F5) {
+        commands_.TryPush(EmulatorCommand::SaveQuickState);
+      } else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F9) {
+        commands_.TryPush(EmulatorCommand::LoadQuickState);
       }
     }
+    if (emulation_done_.load(std::memory_order_acquire)) {
+      running = false;
+    }
 
-    console_.SetHostButtons(input_.ReadButtons());
-    console_.StepFrame();
-
-    auto& framebuffer = console_.GetFramebufferMutable();
-    FillTestPattern(framebuffer, console_.GetDebugState().frame);
+    const bool fresh = frames_.Update();
+    if (!fresh && !pacer_.IsPresentPaced()) {
+      // Nothing new and no vsync to wait on: idle rather than spin.
+      SDL_Delay(1);
+      continue;
+    }
 
-    presenter_.Present(sdl_, framebuffer);
+    const EmulatedFrame& frame = frames_.Front();
+    {
+      SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "present");
+      if (fresh) {
+        presenter_.Upload(sdl_, frame.framebuffer);
+      }
+      presenter_.Draw(sdl_);
+    }
 
 #if defined(SUPERZ80_ENABLE_IMGUI)
     if (config_.enable_imgui) {
+      SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "debug_ui");
+      debug_snapshots_.Update();
       debug_ui_.BeginFrame();
-      debug_ui_.Draw(console_);
+      debug_ui_.Draw(debug_snapshots_.Front());
       debug_ui_.EndFrame();
+      debug_wanted_.store(debug_ui_.WantsSnapshot(), std::memory_order_relaxed);
     }
 #endif
+
+    presenter_.Present(sdl_);
+    const u64 now = time_.NowTicks();
+    pacer_.OnPresent(now);
+    render_timing_.Mark(now);
   }
 
+  stop_emulation_.store(true, std::memory_order_release);
+  emulation_thread_.join();
+
 #if defined(SUPERZ80_ENABLE_IMGUI)
   if (config_.enable_imgui) {
     debug_ui_.Shutdown();
   }
 #endif
 
+  emulation_timing_.LogSummary("Emulation frame interval");
+  render_timing_.LogSummary("Present interval");
+  pacer_.LogSummary();
+  audio_.Close();
+  FinishMovie();
+  StopTrace();
+  StopCapture();
+  console_.SetPadSampler(nullptr, nullptr);
+  input_.Shutdown();
+  run_ahead_.Stop();
+  rewind_.Stop();
+  presenter_.Shutdown();
   sdl_.Shutdown();
   SDL_Quit();
   return 0;
 }
 
-void App::FillTestPattern(sz::ppu::Framebuffer& framebuffer, u64 frame) {
-  SZ_ASSERT(framebuffer.width == kScreenWidth);
-  SZ_ASSERT(framebuffer.height == kScreenHeight);
-  if (framebuffer.pixels.empty()) {
+void App::EmulationMain() {
+  sz::trace::Trace::SetThreadName("emulation");
+  while (!stop_emulation_.load(std::memory_order_acquire)) {
+    pacer_.WaitForNextFrame();
+    emulation_timing_.Mark(time_.NowTicks());
+    RunCommands();
+    EmulateFrame();
+    if (config_.max_frames != 0 && console_.GetDebugState().frame >= config_.max_frames) {
+      emulation_done_.store(true, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+void App::EmulateFrame() {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "emulate");
+  const sz::console::SuperZ80Console* shown = &console_;
+  const bool rewinding = rewind_.IsRunning() && input_.IsRewindHeld();
+  if (rewinding) {
+    if (rewind_.StepBack(rewind_state_)) {
+      console_.LoadState(rewind_state_.data(), rewind_state_.size());
+    }
+    // States leave the framebuffer out, so a muted clone runs one frame
+    // past the restored one to have a picture of it. Clones drop the pad
+    // sampler; the real console is untouched.
+    rewind_preview_ = console_.Clone();
+    rewind_preview_->SetAudioOutputEnabled(false);
+    rewind_preview_->StepFrame();
+    shown = rewind_preview_.get();
+  } else if (run_ahead_.IsEnabled()) {
+    LatchPads();
+    const bool capturing = capture_.IsRunning();
+    run_ahead_.StepFrame(console_, capturing);
+    QueueAudio();
+    CaptureRewindState();
+    // Capture records the real timeline, frame for frame with its audio,
+    // before the speculative frames move the console ahead.
+    if (capturing) {
+      capture_.Submit(console_.GetFramebuffer(), console_.GetAudioSamples());
+    }
+    shown = &run_ahead_.WaitForFrame(console_);
+  } else {
+    LatchPads();
+    console_.StepFrame();
+    QueueAudio();
+    CaptureRewindState();
+  }
+
+  EmulatedFrame& out = frames_.Back();
+  out.framebuffer = shown->GetFramebuffer();
+  if (!console_.HasCartridge()) {
+    FillTestPattern(out.framebuffer, shown->GetDebugState().frame);
+  }
+  frames_.Publish();
+  // Rewound frames are history, not new output; run-ahead submitted above.
+  if (capture_.IsRunning() && !rewinding && !run_ahead_.IsEnabled()) {
+    capture_.Submit(out.framebuffer, console_.GetAudioSamples());
+  }
+  // The speculative framebuffer is already copied; debug views show the
+  // real timeline.
+  run_ahead_.Rollback(console_);
+  PublishDebugSnapshot();
+}
+
+void App::PublishDebugSnapshot() {
+  if (!debug_wanted_.load(std::memory_order_relaxed)) {
+    // The first frame after the UI opens gets a snapshot straight away.
+    debug_countdown_ = 0;
+    return;
+  }
+  if (--debug_countdown_ > 0) {
+    return;
+  }
+  debug_countdown_ = config_.debug_interval_frames;
+  SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "debug_snapshot");
+  console_.CaptureDebugSnapshot(debug_snapshots_.Back());
+  debug_snapshots_.Publish();
+}
+
+void App::RunCommands() {
+  EmulatorCommand command{};
+  while (commands_.TryPop(command)) {
+    switch (command) {
+      case EmulatorCommand::SaveQuickState:
+        if (console_.SaveState(quick_state_)) {
+          SZ_LOG_INFO("Saved quick state (%zu bytes)", quick_state_.size());
+        }
+        break;
+      case EmulatorCommand::LoadQuickState:
+        if (!quick_state_.empty() && !recording_ && !replaying_ &&
+            console_.LoadState(quick_state_.data(), quick_state_.size())) {
+          SZ_LOG_INFO("Loaded quick state");
+        }
+        break;
+    }
+  }
+}
+
+int App::RunHeadless() {
+  if (!PowerOnConsole()) {
+    return 1;
+  }
+  if (!StartMovie() || !StartTrace() || !StartCapture()) {
+    return 1;
+  }
+
+  u64 frames = config_.max_frames;
+  if (frames == 0) {
+    frames = replaying_ ? movie_.GetFrameCount() : kDefaultHeadlessFrames;
+  }
+
+  const u64 start = time_.NowTicks();
+  for (u64 i = 0; i < frames; ++i) {
+    LatchPads();
+    console_.StepFrame();
+    if (capture_.IsRunning()) {
+      capture_.Submit(console_.GetFramebuffer(), console_.GetAudioSamples());
+    }
+  }
+  const u64 elapsed = time_.NowTicks() - start;
+
+  FinishMovie();
+  StopTrace();
+  StopCapture();
+
+  const double seconds = static_cast<double>(elapsed) / 1e6;
+  SZ_LOG_INFO("Headless: %llu frames in %.3f s (%.1f fps)", static_cast<unsigned long long>(frames),
+              seconds, seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0);
+  SZ_LOG_INFO("Final framebuffer hash %016llx, state hash %016llx",
+              static_cast<unsigned long long>(console_.GetFramebufferHash()),
+              static_cast<unsigned long long>(console_.GetStateHash()));
+  LogProfileSummary();
+  return 0;
+}
+
+void App::LogProfileSummary() {
+  if constexpr (!sz::scheduler::kProfilerEnabled) {
+    return;
+  }
+  const auto profile = console_.GetSchedulerDebugState().profile;
+  SZ_LOG_INFO("Profile over %llu frames (mean/p50/p99 us per frame from the last %d, total ms):",
+              static_cast<unsigned long long>(profile.frames), profile.window_frames);
+  for (int section = 0; section <= sz::scheduler::kProfileSectionCount; ++section) {
+    const bool is_frame = section == sz::scheduler::kProfileSectionCount;
+    const auto& stats = is_frame ? profile.frame : profile.sections[section];
+    SZ_LOG_INFO("  %-5s %8.1f %8.1f %8.1f %10.1f", is_frame ? "Frame" : sz::scheduler::kProfileSectionNames[section],
+                stats.mean_us, stats.p50_us, stats.p99_us, stats.total_ms);
+  }
+}
+
+bool App::StartMovie() {
+  if (!config_.record_path.empty() && !config_.replay_path.empty()) {
+    SZ_LOG_ERROR("--record and --replay are mutually exclusive");
+    return false;
+  }
+
+  const u64 power_on_hash = console_.GetStateHash();
+  if (!config_.replay_path.empty()) {
+    if (!movie_.LoadFromFile(config_.replay_path)) {
+      return false;
+    }
+    if (movie_.GetPowerOnHash() != power_on_hash) {
+      SZ_LOG_WARN("Movie power-on hash %016llx does not match console %016llx; replay may desync",
+                  static_cast<unsigned long long>(movie_.GetPowerOnHash()),
+                  static_cast<unsigned long long>(power_on_hash));
+    }
+    SZ_LOG_INFO("Replaying %s (%u frames)", config_.replay_path.c_str(), movie_.GetFrameCount());
+    replaying_ = true;
+  }
+  if (!config_.record_path.empty()) {
+    movie_.BeginRecording(power_on_hash);
+    recording_ = true;
+  }
+  return true;
+}
+
+void App::FinishMovie() {
+  if (recording_) {
+    movie_.SaveToFile(config_.record_path);
+    recording_ = false;
+  }
+  replaying_ = false;
+}
+
+bool App::StartTrace() {
+  if (!config_.cpu_trace_path.empty()) {
+    if (!exec_trace_.Open(config_.cpu_trace_path)) {
+      return false;
+    }
+    console_.SetExecTrace(&exec_trace_);
+  }
+  if (config_.trace_path.empty()) {
+    return true;
+  }
+  if (sz::trace::kCompiledMask == 0) {
+    SZ_LOG_WARN("--trace: this build has no trace categories (SUPERZ80_TRACE_MASK=0)");
+  }
+  // A .json path exports Chrome trace events; anything else is the binary
+  // record file.
+  const std::string& path = config_.trace_path;
+  if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) {
+    auto sink = std::make_unique<sz::trace::ChromeTraceSink>();
+    if (!sink->Open(path)) {
+      return false;
+    }
+    trace_sink_ = std::move(sink);
+  } else {
+    auto sink = std::make_unique<sz::trace::TraceFileSink>();
+    if (!sink->Open(path)) {
+      return false;
+    }
+    trace_sink_ = std::move(sink);
+  }
+  sz::trace::Trace::SetThreadName("main");
+  sz::trace::Trace::Start(trace_sink_.get());
+  return true;
+}
+
+void App::StopTrace() {
+  if (exec_trace_.IsOpen()) {
+    console_.SetExecTrace(nullptr);
+    exec_trace_.Close();
+  }
+  if (!sz::trace::Trace::IsActive()) {
     return;
   }
+  sz::trace::Trace::Stop();
+  trace_sink_.reset();
+  const u64 dropped = sz::trace::Trace::GetDroppedCount();
+  if (dropped != 0) {
+    SZ_LOG_WARN("Trace: dropped %llu records (drain fell behind)", static_cast<unsigned long long>(dropped));
+  }
+}
+
+bool App::StartCapture() {
+  return config_.capture_path.empty() || capture_.Start(config_.capture_path);
+}
+
+void App::StopCapture() {
+  capture_.Stop();
+}
+
+void App::LatchPads() {
+  MovieFrame frame{};
+  if (replaying_) {
+    if (!movie_.ReadFrame(frame)) {
+      SZ_LOG_INFO("Movie replay finished at frame %llu",
+                  static_cast<unsigned long long>(console_.GetDebugState().frame));
+      replaying_ = false;
+    }
+  } else if (!config_.headless) {
+    for (int pad = 0; pad < sz::input::kPadCount; ++pad) {
+      frame[static_cast<size_t>(pad)] = input_.GetPad(pad);
+    }
+  }
+
+  if (recording_) {
+    movie_.RecordFrame(frame);
+  }
+  for (int pad = 0; pad < sz::input::kPadCount; ++pad) {
+    console_.SetHostButtons(pad, sz::input::UnpackButtons(frame[static_cast<size_t>(pad)]));
+  }
+}
+
+void App::QueueAudio() {
+  audio_.Queue(console_.GetAudioSamples(), pacer_.GetAudioRatio());
+  pacer_.OnAudioLevel(audio_.GetQueuedSamples(), audio_.GetTargetSamples());
+}
 
+void App::CaptureRewindState() {
+  if (!rewind_.IsRunning() ||
+      console_.GetDebugState().frame % static_cast<u64>(config_.rewind_interval_frames) != 0) {
+    return;
+  }
+  u8* slot = rewind_.BeginCapture();
+  if (!slot) {
+    return;
+  }
+  console_.SaveState(slot, console_.GetSaveStateSize());
+  rewind_.EndCapture();
+}
+
+bool App::PowerOnConsole() {
+  if (!console_.PowerOn()) {
+    return false;
+  }
+  if (!config_.rom_path.empty() && !console_.LoadCartridgeFile(config_.rom_path)) {
+    return false;
+  }
+  console_.Reset();
+  return true;
+}
+
+void App::FillTestPattern(sz::ppu::Framebuffer& framebuffer, u64 frame) {
+  SZ_ASSERT(framebuffer.width == kScreenWidth);
+  SZ_ASSERT(framebuffer.height == kScreenHeight);
   const int bar_width = std::max(1, framebuffer.width / 8);
   const int shift = static_cast<int>(frame % framebuffer.width);
 
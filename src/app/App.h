@@ -1,11 +1,28 @@
 #ifndef SUPERZ80_APP_APP_H
 #define SUPERZ80_APP_APP_H
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "app/AudioOutput.h"
+#include "app/CaptureWriter.h"
+#include "app/FramePacer.h"
+#include "app/FrameTiming.h"
 #include "app/InputHost.h"
+#include "app/InputMovie.h"
+#include "app/RewindBuffer.h"
+#include "app/RunAhead.h"
 #include "app/SDLHost.h"
 #include "app/TimeSource.h"
+#include "app/Upscaler.h"
 #include "app/VideoPresenter.h"
 #include "console/SuperZ80Console.h"
+#include "core/log/Trace.h"
+#include "core/util/SpscRing.h"
+#include "core/util/TripleBuffer.h"
 
 #if defined(SUPERZ80_ENABLE_IMGUI)
 #include "debugui/DebugUI.h"
@@ -15,23 +32,100 @@ namespace sz::app {
 
 struct AppConfig {
   int scale = 3;
+  UpscaleFilter upscale_filter = UpscaleFilter::None;  // None: the renderer scales
+  unsigned upscale_threads = 0;  // 0: Upscaler picks
   bool enable_imgui = true;
+  int rewind_interval_frames = 2;  // 0 disables rewind
+  int rewind_budget_mb = 64;
+  int run_ahead_frames = 0;  // 0 disables run-ahead
+  bool run_ahead_second_core = false;
+  bool vsync = true;
+  int audio_latency_ms = 64;  // 0 disables audio output
+  int debug_interval_frames = 2;  // emulated frames between debug snapshots
+  bool headless = false;
+  u64 max_frames = 0;  // 0 runs until quit (or until replay ends, headless)
+  std::string record_path;
+  std::string replay_path;
+  std::string trace_path;
+  std::string cpu_trace_path;
+  std::string capture_path;  // .y4m: Y4M + WAV; otherwise a PPM sequence prefix
+  std::string rom_path;  // empty runs without a cartridge (test pattern)
+};
+
+// Render thread to emulation thread. Pads do not go through here: the
+// console samples InputHost's atomics directly at each PAD port read.
+enum class EmulatorCommand : u8 {
+  SaveQuickState,
+  LoadQuickState,
+};
+
+// One emulated frame as handed to the render thread.
+struct EmulatedFrame {
+  sz::ppu::Framebuffer framebuffer;
 };
 
+// The console runs on its own thread, paced by FramePacer, and publishes
+// each frame through a triple buffer; the main thread handles events,
+// presents the newest frame and draws the debug UI. Neither waits on the
+// other. Debug snapshots travel in a buffer of their own, captured only
+// while the debug UI shows something and at most every
+// debug_interval_frames, so inspection costs the emulation thread nothing
+// when nobody is looking.
 class App {
  public:
   explicit App(const AppConfig& config);
   int Run();
 
  private:
+  bool PowerOnConsole();
   void FillTestPattern(sz::ppu::Framebuffer& framebuffer, u64 frame);
+  void CaptureRewindState();
+  int RunHeadless();
+  // Emulation thread.
+  void EmulationMain();
+  void EmulateFrame();
+  void PublishDebugSnapshot();
+  void RunCommands();
+  void LogProfileSummary();
+  bool StartMovie();
+  void FinishMovie();
+  void LatchPads();
+  void QueueAudio();
+  bool StartTrace();
+  void StopTrace();
+  bool StartCapture();
+  void StopCapture();
 
   AppConfig config_{};
   SDLHost sdl_{};
   VideoPresenter presenter_{};
   InputHost input_{};
   TimeSource time_{};
+  AudioOutput audio_{};
+  FramePacer pacer_{};
+  sz::util::TripleBuffer<EmulatedFrame> frames_{};
+  sz::util::TripleBuffer<sz::console::DebugSnapshot> debug_snapshots_{};
+  std::atomic<bool> debug_wanted_{false};  // set by the render thread
+  int debug_countdown_ = 0;  // emulation thread
+  sz::util::SpscRing<EmulatorCommand> commands_{16};
+  std::thread emulation_thread_;
+  std::atomic<bool> stop_emulation_{false};
+  std::atomic<bool> emulation_done_{false};
+  FrameTiming emulation_timing_{};
+  FrameTiming render_timing_{};
   sz::console::SuperZ80Console console_{};
+  std::vector<u8> quick_state_{};
+  RewindBuffer rewind_{};
+  std::vector<u8> rewind_state_{};
+  // Shown while rewinding; see EmulateFrame.
+  std::unique_ptr<sz::console::SuperZ80Console> rewind_preview_;
+  RunAhead run_ahead_{};
+  InputMovie movie_{};
+  bool recording_ = false;
+  bool replaying_ = false;
+  std::unique_ptr<sz::trace::ITraceSink> trace_sink_;
+  sz::cpu::ExecTraceWriter exec_trace_{};
+  CaptureWriter capture_{};
 
 #if defined(SUPERZ80_ENABLE_IMGUI)
   sz::debugui::DebugUI debug_ui_{};
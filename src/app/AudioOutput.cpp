@@ -0,0 +1,100 @@
+#include "app/AudioOutput.h"
+
+#include <algorithm>
+
+#include "core/log/Logger.h"
+
+namespace sz::app {
+
+namespace {
+// Host stalls (window drags, the debugger) can pile up audio; past this many
+// multiples of the target the backlog is dropped instead of played late.
+constexpr int kMaxBacklogTargets = 4;
+}
+
+AudioOutput::~AudioOutput() {
+  Close();
+}
+
+bool AudioOutput::Open(int sample_rate, int latency_ms) {
+  Close();
+  if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+    SZ_LOG_WARN("Audio: SDL audio init failed: %s", SDL_GetError());
+    return false;
+  }
+
+  SDL_AudioSpec want{};
+  want.freq = sample_rate;
+  want.format = AUDIO_S16SYS;
+  want.channels = 1;
+  want.samples = 512;
+  // SDL converts to whatever the device needs, so the queue stays in
+  // console samples and its fill level is directly comparable to a frame.
+  device_ = SDL_OpenAudioDevice(nullptr, 0, &want, nullptr, 0);
+  if (device_ == 0) {
+    SZ_LOG_WARN("Audio: no output device (%s); running silent", SDL_GetError());
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    return false;
+  }
+
+  target_samples_ = sample_rate * latency_ms / 1000;
+  position_ = 0.0;
+  last_ = 0;
+  SDL_PauseAudioDevice(device_, 0);
+  SZ_LOG_INFO("Audio: %d Hz mono, target latency %d ms", sample_rate, latency_ms);
+  return true;
+}
+
+void AudioOutput::Close() {
+  if (device_ == 0) {
+    return;
+  }
+  SDL_CloseAudioDevice(device_);
+  SDL_QuitSubSystem(SDL_INIT_AUDIO);
+  device_ = 0;
+}
+
+bool AudioOutput::IsOpen() const {
+  return device_ != 0;
+}
+
+void AudioOutput::Queue(const std::vector<s16>& samples, double ratio) {
+  if (device_ == 0 || samples.empty()) {
+    return;
+  }
+  const int queued = GetQueuedSamples();
+  if (queued > target_samples_ * kMaxBacklogTargets) {
+    SDL_ClearQueuedAudio(device_);
+  } else if (queued == 0) {
+    // Startup or an underrun: pad back to the target with silence so the
+    // pacer's small stretch only ever has to correct drift.
+    resampled_.assign(static_cast<size_t>(std::max(0, target_samples_ - static_cast<int>(samples.size()))), 0);
+    SDL_QueueAudio(device_, resampled_.data(), static_cast<Uint32>(resampled_.size() * sizeof(s16)));
+  }
+
+  // Input index i sits at position i + 1; position 0 is `last_`.
+  const double step = 1.0 / ratio;
+  const double end = static_cast<double>(samples.size());
+  resampled_.clear();
+  for (; position_ < end; position_ += step) {
+    const size_t index = static_cast<size_t>(position_);
+    const double frac = position_ - static_cast<double>(index);
+    const double a = index == 0 ? last_ : samples[index - 1];
+    const double b = samples[index];
+    resampled_.push_back(static_cast<s16>(a + (b - a) * frac));
+  }
+  position_ -= end;
+  last_ = samples.back();
+
+  SDL_QueueAudio(device_, resampled_.data(), static_cast<Uint32>(resampled_.size() * sizeof(s16)));
+}
+
+int AudioOutput::GetQueuedSamples() const {
+  return device_ != 0 ? static_cast<int>(SDL_GetQueuedAudioSize(device_) / sizeof(s16)) : 0;
+}
+
+int AudioOutput::GetTargetSamples() const {
+  return target_samples_;
+}
+
+}  // namespace sz::app
@@ -0,0 +1,44 @@
+#ifndef SUPERZ80_APP_AUDIOOUTPUT_H
+#define SUPERZ80_APP_AUDIOOUTPUT_H
+
+#include <vector>
+
+#include <SDL.h>
+
+#include "core/types.h"
+
+namespace sz::app {
+
+// Mono s16 playback through SDL's audio queue. Each emulated frame's APU
+// samples are pushed with Queue; the queued amount is what FramePacer
+// steers toward its target. A linear resampler stretches or squeezes the
+// stream by a small ratio so the queue can be held steady when emulation
+// is locked to the display rather than to the audio device.
+class AudioOutput {
+ public:
+  ~AudioOutput();
+
+  // Falls back to running silent (returns false) if no device opens.
+  bool Open(int sample_rate, int latency_ms);
+  void Close();
+  bool IsOpen() const;
+
+  // Plays `samples` stretched by `ratio` (output/input sample count).
+  void Queue(const std::vector<s16>& samples, double ratio);
+
+  int GetQueuedSamples() const;
+  int GetTargetSamples() const;
+
+ private:
+  SDL_AudioDeviceID device_ = 0;
+  int target_samples_ = 0;
+  // Resampler position past `last_`, which carries over from the previous
+  // block so the interpolation is continuous across frames.
+  double position_ = 0.0;
+  s16 last_ = 0;
+  std::vector<s16> resampled_{};
+};
+
+}  // namespace sz::app
+
+#endif
@@ -0,0 +1,272 @@
+#include "app/CaptureWriter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+
+#include "core/log/Logger.h"
+#include "devices/apu/APU.h"
+#include "devices/scheduler/Scheduler.h"
+
+namespace sz::app {
+
+namespace {
+constexpr size_t kStreamBufferBytes = 1u << 20;
+// Per-frame audio headroom; a frame carries about kSampleRate / 60.
+constexpr size_t kAudioReserve = sz::apu::kSampleRate / 10;
+constexpr size_t kWavHeaderBytes = 44;
+constexpr size_t kFramePixels = static_cast<size_t>(kScreenWidth) * kScreenHeight;
+
+bool EndsWith(const std::string& text, const char* suffix) {
+  const size_t length = std::char_traits<char>::length(suffix);
+  return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+void PutLe16(u8* out, u32 value) {
+  out[0] = static_cast<u8>(value);
+  out[1] = static_cast<u8>(value >> 8);
+}
+
+void PutLe32(u8* out, u32 value) {
+  PutLe16(out, value);
+  PutLe16(out + 2, value >> 16);
+}
+
+// Canonical 44-byte header: PCM, mono, 16-bit. Sizes cap at 4 GB.
+void MakeWavHeader(u8* out, u64 data_bytes) {
+  const u32 data = static_cast<u32>(std::min<u64>(data_bytes, 0xFFFFFFFFu - kWavHeaderBytes));
+  std::copy_n("RIFF", 4, out);
+  PutLe32(out + 4, data + static_cast<u32>(kWavHeaderBytes) - 8);
+  std::copy_n("WAVEfmt ", 8, out + 8);
+  PutLe32(out + 16, 16);
+  PutLe16(out + 20, 1);  // PCM
+  PutLe16(out + 22, 1);  // channels
+  PutLe32(out + 24, sz::apu::kSampleRate);
+  PutLe32(out + 28, sz::apu::kSampleRate * 2);
+  PutLe16(out + 32, 2);  // block align
+  PutLe16(out + 34, 16);
+  std::copy_n("data", 4, out + 36);
+  PutLe32(out + 40, data);
+}
+
+FILE* OpenBuffered(const std::string& path, std::vector<char>& buffer) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    SZ_LOG_ERROR("Capture: cannot write %s", path.c_str());
+    return nullptr;
+  }
+  buffer.resize(kStreamBufferBytes);
+  std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+  return file;
+}
+}  // namespace
+
+CaptureWriter::~CaptureWriter() {
+  Stop();
+}
+
+bool CaptureWriter::Start(const std::string& path, size_t pool_frames) {
+  Stop();
+
+  y4m_ = EndsWith(path, ".y4m");
+  path_ = y4m_ ? path.substr(0, path.size() - 4) : path;
+  failed_ = false;
+  frames_written_ = 0;
+  audio_bytes_ = 0;
+  stalls_ = 0;
+  stop_ = false;
+
+  wav_file_ = OpenBuffered(path_ + ".wav", wav_stream_buffer_);
+  if (!wav_file_) {
+    return false;
+  }
+  u8 header[kWavHeaderBytes];
+  MakeWavHeader(header, 0);
+  std::fwrite(header, 1, sizeof(header), wav_file_);
+
+  if (y4m_) {
+    video_file_ = OpenBuffered(path, video_stream_buffer_);
+    if (!video_file_) {
+      std::fclose(wav_file_);
+      wav_file_ = nullptr;
+      return false;
+    }
+    // The console's exact rate, master clocks per second over per frame.
+    std::fprintf(video_file_, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n", kScreenWidth, kScreenHeight,
+                 sz::apu::kMasterClockHz, sz::scheduler::kMasterClocksPerScanline * kTotalScanlines);
+  }
+  encoded_.resize(kFramePixels * 3);
+
+  pool_frames = std::max<size_t>(pool_frames, 2);
+  pool_ = std::make_unique<Frame[]>(pool_frames);
+  free_ = std::make_unique<sz::util::SpscRing<u32>>(pool_frames);
+  filled_ = std::make_unique<sz::util::SpscRing<u32>>(pool_frames);
+  for (size_t i = 0; i < pool_frames; ++i) {
+    pool_[i].audio.reserve(kAudioReserve);
+    free_->TryPush(static_cast<u32>(i));
+  }
+
+  worker_ = std::thread(&CaptureWriter::WorkerMain, this);
+  SZ_LOG_INFO("Capture: %s%s, %zu-frame queue", path.c_str(), y4m_ ? "" : "NNNNNN.ppm", pool_frames);
+  return true;
+}
+
+bool CaptureWriter::Stop() {
+  if (!worker_.joinable()) {
+    return true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+
+  failed_ = !FinishWav() || failed_;
+  if (video_file_ && std::fclose(video_file_) != 0) {
+    failed_ = true;
+  }
+  video_file_ = nullptr;
+  pool_.reset();
+  free_.reset();
+  filled_.reset();
+
+  SZ_LOG_INFO("Capture: %" PRIu64 " frames, %.1f s of audio, %" PRIu64 " queue stall(s)%s", frames_written_,
+              static_cast<double>(audio_bytes_) / 2.0 / sz::apu::kSampleRate, stalls_,
+              failed_ ? ", WRITE ERRORS" : "");
+  return !failed_;
+}
+
+bool CaptureWriter::IsRunning() const {
+  return worker_.joinable();
+}
+
+void CaptureWriter::Submit(const sz::ppu::Framebuffer& framebuffer, const std::vector<s16>& audio) {
+  u32 slot = 0;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!free_->TryPop(slot)) {
+      ++stalls_;
+      cv_.wait(lock, [this, &slot] { return free_->TryPop(slot); });
+    }
+  }
+  Frame& frame = pool_[slot];
+  frame.video = framebuffer;
+  frame.audio.assign(audio.begin(), audio.end());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    filled_->TryPush(slot);
+  }
+  cv_.notify_all();
+}
+
+void CaptureWriter::WorkerMain() {
+  while (true) {
+    u32 slot = 0;
+    bool have = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this, &slot, &have] {
+        have = filled_->TryPop(slot);
+        return have || stop_;
+      });
+    }
+    if (!have) {
+      return;
+    }
+    // After a failure, keep draining so Submit never waits on a dead disk.
+    if (!failed_ && !WriteFrame(pool_[slot])) {
+      failed_ = true;
+      SZ_LOG_ERROR("Capture: write failed at frame %" PRIu64 "; discarding the rest", frames_written_);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_->TryPush(slot);
+    }
+    cv_.notify_all();
+  }
+}
+
+bool CaptureWriter::WriteFrame(const Frame& frame) {
+  const bool video = y4m_ ? WriteY4mFrame(frame.video) : WritePpmFrame(frame.video);
+  if (!video || !WriteAudio(frame.audio)) {
+    return false;
+  }
+  ++frames_written_;
+  return true;
+}
+
+// BT.601 limited range, which players assume for Y4M without a colour tag.
+bool CaptureWriter::WriteY4mFrame(const sz::ppu::Framebuffer& video) {
+  u8* y_plane = encoded_.data();
+  u8* u_plane = y_plane + kFramePixels;
+  u8* v_plane = u_plane + kFramePixels;
+  for (size_t i = 0; i < kFramePixels; ++i) {
+    const int r = static_cast<int>((video.pixels[i] >> 16) & 0xFF);
+    const int g = static_cast<int>((video.pixels[i] >> 8) & 0xFF);
+    const int b = static_cast<int>(video.pixels[i] & 0xFF);
+    y_plane[i] = static_cast<u8>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    u_plane[i] = static_cast<u8>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    v_plane[i] = static_cast<u8>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  }
+  static constexpr char kFrameTag[] = "FRAME\n";
+  return std::fwrite(kFrameTag, 1, sizeof(kFrameTag) - 1, video_file_) == sizeof(kFrameTag) - 1 &&
+         std::fwrite(encoded_.data(), 1, encoded_.size(), video_file_) == encoded_.size();
+}
+
+bool CaptureWriter::WritePpmFrame(const sz::ppu::Framebuffer& video) {
+  u8* out = encoded_.data();
+  for (size_t i = 0; i < kFramePixels; ++i) {
+    out[3 * i] = static_cast<u8>(video.pixels[i] >> 16);
+    out[3 * i + 1] = static_cast<u8>(video.pixels[i] >> 8);
+    out[3 * i + 2] = static_cast<u8>(video.pixels[i]);
+  }
+  char name[32];
+  std::snprintf(name, sizeof(name), "%06" PRIu64 ".ppm", frames_written_);
+  const std::string file_path = path_ + name;
+  FILE* file = std::fopen(file_path.c_str(), "wb");
+  if (!file) {
+    SZ_LOG_ERROR("Capture: cannot write %s", file_path.c_str());
+    return false;
+  }
+  std::fprintf(file, "P6\n%d %d\n255\n", kScreenWidth, kScreenHeight);
+  const bool written = std::fwrite(encoded_.data(), 1, encoded_.size(), file) == encoded_.size();
+  return std::fclose(file) == 0 && written;
+}
+
+bool CaptureWriter::WriteAudio(const std::vector<s16>& audio) {
+  if (audio.empty()) {
+    return true;
+  }
+  const size_t bytes = audio.size() * sizeof(s16);
+  if constexpr (std::endian::native == std::endian::little) {
+    if (std::fwrite(audio.data(), 1, bytes, wav_file_) != bytes) {
+      return false;
+    }
+  } else {
+    u8* out = encoded_.data();  // free again once the frame's video is written
+    for (size_t i = 0; i < audio.size(); ++i) {
+      PutLe16(out + 2 * i, static_cast<u16>(audio[i]));
+    }
+    if (std::fwrite(out, 1, bytes, wav_file_) != bytes) {
+      return false;
+    }
+  }
+  audio_bytes_ += bytes;
+  return true;
+}
+
+bool CaptureWriter::FinishWav() {
+  if (!wav_file_) {
+    return true;
+  }
+  u8 header[kWavHeaderBytes];
+  MakeWavHeader(header, audio_bytes_);
+  bool ok = std::fseek(wav_file_, 0, SEEK_SET) == 0;
+  ok = ok && std::fwrite(header, 1, sizeof(header), wav_file_) == sizeof(header);
+  const bool closed = std::fclose(wav_file_) == 0;
+  wav_file_ = nullptr;
+  return ok && closed;
+}
+
+}  // namespace sz::app
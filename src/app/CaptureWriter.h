@@ -0,0 +1,87 @@
+#ifndef SUPERZ80_APP_CAPTUREWRITER_H
+#define SUPERZ80_APP_CAPTUREWRITER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "core/util/NonCopyable.h"
+#include "core/util/SpscRing.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::app {
+
+// Writes every emulated frame and its audio to disk. A path ending in .y4m
+// records YUV4MPEG2 (4:4:4) video; any other path is the prefix of a PPM
+// image sequence (<path>000000.ppm, ...). Audio goes to a 16-bit mono WAV
+// beside it (<path without .y4m>.wav).
+//
+// The emulation thread only copies a frame into a buffer from a fixed pool
+// and queues it; a worker converts, writes and hands the buffer back. Every
+// buffer is allocated in Start, so capturing costs the emulation thread a
+// copy and no allocation. If the worker falls a whole pool behind, Submit
+// waits for a buffer rather than drop a frame, and counts the stall.
+class CaptureWriter : private sz::util::NonCopyable {
+ public:
+  ~CaptureWriter();
+
+  static constexpr size_t kDefaultPoolFrames = 32;
+
+  bool Start(const std::string& path, size_t pool_frames = kDefaultPoolFrames);
+  // Drains the queue, completes the WAV header and joins the worker.
+  // Returns false if any write failed.
+  bool Stop();
+  bool IsRunning() const;
+
+  // Emulation thread.
+  void Submit(const sz::ppu::Framebuffer& framebuffer, const std::vector<s16>& audio);
+
+ private:
+  struct Frame {
+    sz::ppu::Framebuffer video;
+    std::vector<s16> audio;
+  };
+
+  void WorkerMain();
+  bool WriteFrame(const Frame& frame);
+  bool WriteY4mFrame(const sz::ppu::Framebuffer& video);
+  bool WritePpmFrame(const sz::ppu::Framebuffer& video);
+  bool WriteAudio(const std::vector<s16>& audio);
+  bool FinishWav();
+
+  std::string path_;
+  bool y4m_ = false;
+  FILE* video_file_ = nullptr;
+  FILE* wav_file_ = nullptr;
+  std::vector<char> video_stream_buffer_;
+  std::vector<char> wav_stream_buffer_;
+
+  std::unique_ptr<Frame[]> pool_;
+  // Pool slot indices: free ones for the emulation thread, filled ones for
+  // the worker. Both fit the whole pool, so pushes never fail.
+  std::unique_ptr<sz::util::SpscRing<u32>> free_;
+  std::unique_ptr<sz::util::SpscRing<u32>> filled_;
+
+  // Worker.
+  std::vector<u8> encoded_;
+  u64 frames_written_ = 0;
+  u64 audio_bytes_ = 0;
+  bool failed_ = false;
+
+  // Emulation thread.
+  u64 stalls_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  std::thread worker_;
+};
+
+}  // namespace sz::app
+
+#endif
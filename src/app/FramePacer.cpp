@@ -0,0 +1,184 @@
+#include "app/FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/log/Logger.h"
+#include "devices/apu/APU.h"
+#include "devices/scheduler/Scheduler.h"
+
+namespace sz::app {
+
+namespace {
+constexpr double kConsoleFrameHz = static_cast<double>(sz::apu::kMasterClockHz) /
+                                   (sz::scheduler::kMasterClocksPerScanline * kTotalScanlines);
+
+// Locking needs headroom under kMaxAudioStretch for clock drift.
+constexpr double kLockTolerance = 0.004;
+// Fraction of the phase error against presents corrected per frame.
+constexpr double kPhaseGain = 0.1;
+// Presents measured this much faster than the display (or above the
+// ceiling when its rate is unknown) mean vsync is not blocking.
+constexpr double kRefreshTolerance = 0.02;
+constexpr double kMaxPlausibleRefreshHz = 500.0;
+constexpr u64 kRateCheckPresents = 240;
+
+// Behind schedule by more than this (a stall, a breakpoint), pacing
+// restarts from now instead of racing to catch up.
+constexpr double kMaxLateFrames = 4.0;
+
+// Queue level smoothing; SDL drains the queue in device-buffer chunks.
+constexpr double kFillSmoothing = 0.05;
+}
+
+void FramePacer::Start(double refresh_hz, bool vsync) {
+  vsync_ = vsync;
+  refresh_hz_ = refresh_hz;
+  present_period_us_ = refresh_hz > 0.0 ? 1e6 / refresh_hz : 0.0;
+  frame_period_us_ = 1e6 / kConsoleFrameHz;
+  frames_ = 0;
+  resyncs_ = 0;
+  fill_ = -1.0;
+  min_stretch_ = max_stretch_ = 1.0;
+  check_start_us_ = 0;
+  check_presents_ = 0;
+  presents_.store(0, std::memory_order_relaxed);
+  last_present_us_.store(0, std::memory_order_relaxed);
+  present_paced_.store(vsync, std::memory_order_relaxed);
+
+  const u64 now = time_.NowTicks();
+  const long multiple = refresh_hz > 0.0 ? std::lround(refresh_hz / kConsoleFrameHz) : 0;
+  if (vsync && multiple >= 1) {
+    const double ratio = kConsoleFrameHz * static_cast<double>(multiple) / refresh_hz;
+    if (std::abs(ratio - 1.0) <= kLockTolerance) {
+      mode_ = PaceMode::Locked;
+      refreshes_per_frame_ = static_cast<int>(multiple);
+      base_ratio_ = audio_ratio_ = ratio;
+      speed_ = 1.0;
+      next_deadline_us_ = static_cast<double>(now);
+      SZ_LOG_INFO("Pacing: locked to %.2f Hz vsync, %d refresh(es) per frame, audio x%.4f", refresh_hz,
+                  refreshes_per_frame_, ratio);
+      return;
+    }
+  }
+  StartTimed(now);
+  SZ_LOG_INFO("Pacing: timed at %.3f Hz (%s, display %.2f Hz)", kConsoleFrameHz, vsync ? "vsync" : "no vsync",
+              refresh_hz);
+}
+
+void FramePacer::StartTimed(u64 now) {
+  mode_ = PaceMode::Timed;
+  refreshes_per_frame_ = 1;
+  base_ratio_ = audio_ratio_ = 1.0;
+  speed_ = 1.0;
+  next_deadline_us_ = static_cast<double>(now);
+}
+
+void FramePacer::WaitForNextFrame() {
+  const u64 now = time_.NowTicks();
+  if (vsync_) {
+    CheckPresentRate(now);
+  }
+  double period = frame_period_us_ / speed_;
+  if (mode_ == PaceMode::Locked) {
+    period = present_period_us_ * refreshes_per_frame_;
+    AlignToPresents();
+  }
+  if (static_cast<double>(now) > next_deadline_us_ + kMaxLateFrames * period) {
+    next_deadline_us_ = static_cast<double>(now);
+    ++resyncs_;
+  }
+  time_.SleepUntil(static_cast<u64>(next_deadline_us_));
+  next_deadline_us_ += period;
+  ++frames_;
+}
+
+void FramePacer::AlignToPresents() {
+  const u64 last_present = last_present_us_.load(std::memory_order_relaxed);
+  if (last_present == 0) {
+    return;
+  }
+  double phase = std::fmod(next_deadline_us_ - static_cast<double>(last_present), present_period_us_);
+  if (phase < 0.0) {
+    phase += present_period_us_;
+  }
+  next_deadline_us_ -= (phase - present_period_us_ * 0.5) * kPhaseGain;
+}
+
+void FramePacer::CheckPresentRate(u64 now) {
+  const u64 presents = presents_.load(std::memory_order_relaxed);
+  // The first window includes startup hitches; measure from the second.
+  if (presents < kRateCheckPresents || check_presents_ == 0) {
+    check_start_us_ = now;
+    check_presents_ = std::max<u64>(presents, 1);
+    return;
+  }
+  if (presents - check_presents_ < kRateCheckPresents) {
+    return;
+  }
+  const double measured_hz =
+      static_cast<double>(presents - check_presents_) * 1e6 / static_cast<double>(now - check_start_us_);
+  check_start_us_ = now;
+  check_presents_ = presents;
+  // Slower than the display just means a slow render frame; only faster
+  // shows vsync is not blocking.
+  const double ceiling = refresh_hz_ > 0.0 ? refresh_hz_ * (1.0 + kRefreshTolerance) : kMaxPlausibleRefreshHz;
+  if (measured_hz > ceiling) {
+    SZ_LOG_WARN("Pacing: presents run at %.2f Hz against a %.2f Hz display; vsync looks ineffective, switching "
+                "to timed pacing", measured_hz, refresh_hz_);
+    vsync_ = false;
+    present_paced_.store(false, std::memory_order_relaxed);
+    StartTimed(now);
+  }
+}
+
+void FramePacer::OnAudioLevel(int queued_samples, int target_samples) {
+  if (target_samples <= 0) {
+    return;
+  }
+  const double queued = static_cast<double>(queued_samples);
+  fill_ = fill_ < 0.0 ? queued : fill_ + (queued - fill_) * kFillSmoothing;
+  // Proportional control: full stretch when the queue is empty or double
+  // the target, none at the target.
+  const double error = std::clamp((target_samples - fill_) / target_samples, -1.0, 1.0);
+  const double correction = 1.0 + kMaxAudioStretch * error;
+  if (mode_ == PaceMode::Locked) {
+    audio_ratio_ = std::clamp(base_ratio_ * correction, 1.0 - kMaxAudioStretch, 1.0 + kMaxAudioStretch);
+    NoteStretch(audio_ratio_);
+  } else {
+    speed_ = correction;
+    NoteStretch(speed_);
+  }
+}
+
+double FramePacer::GetAudioRatio() const {
+  return audio_ratio_;
+}
+
+void FramePacer::OnPresent(u64 now_us) {
+  last_present_us_.store(now_us, std::memory_order_relaxed);
+  presents_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FramePacer::IsPresentPaced() const {
+  return present_paced_.load(std::memory_order_relaxed);
+}
+
+PaceMode FramePacer::GetMode() const {
+  return mode_;
+}
+
+void FramePacer::NoteStretch(double stretch) {
+  min_stretch_ = std::min(min_stretch_, stretch);
+  max_stretch_ = std::max(max_stretch_, stretch);
+}
+
+void FramePacer::LogSummary() const {
+  SZ_LOG_INFO("Pacing: %s, %llu frames over %llu presents, %s x%.4f..x%.4f, %llu resync(s)",
+              mode_ == PaceMode::Locked ? "locked" : "timed", static_cast<unsigned long long>(frames_),
+              static_cast<unsigned long long>(presents_.load(std::memory_order_relaxed)),
+              mode_ == PaceMode::Locked ? "audio" : "speed", min_stretch_, max_stretch_,
+              static_cast<unsigned long long>(resyncs_));
+}
+
+}  // namespace sz::app
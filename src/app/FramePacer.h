@@ -0,0 +1,97 @@
+#ifndef SUPERZ80_APP_FRAMEPACER_H
+#define SUPERZ80_APP_FRAMEPACER_H
+
+#include <atomic>
+
+#include "app/TimeSource.h"
+#include "core/types.h"
+
+namespace sz::app {
+
+// Most audio stretch (either way) the pacer will apply to hold the audio
+// queue at its target; small enough to be inaudible as pitch.
+constexpr double kMaxAudioStretch = 0.005;
+
+enum class PaceMode : u8 {
+  // Vsync on and the refresh within tolerance of N x the console rate: one
+  // emulated frame per N refreshes, phase-locked to the render thread's
+  // presents so frames land evenly (60/120 Hz). Audio is resampled to
+  // absorb the rate difference.
+  Locked,
+  // Frames follow an absolute TimeSource schedule at the console rate,
+  // sped up or slowed by at most kMaxAudioStretch to keep the audio queue
+  // at its target; the render thread shows the newest frame at each
+  // refresh (75/144 Hz) or as soon as it arrives (no vsync).
+  Timed,
+};
+
+// Schedules emulated frames on the emulation thread. The audio queue is the
+// master clock: its fill level, reported after every frame, steers either
+// the resampling ratio (locked) or the frame schedule (timed). The render
+// thread only reports presents; nothing here makes either thread wait on
+// the other.
+class FramePacer {
+ public:
+  // `refresh_hz` is the display's nominal rate, 0 when unknown. Call before
+  // either thread starts using the pacer.
+  void Start(double refresh_hz, bool vsync);
+
+  // Emulation thread: sleeps until the next frame is due.
+  void WaitForNextFrame();
+  // After each emulated frame's audio is queued.
+  void OnAudioLevel(int queued_samples, int target_samples);
+  // Output/input sample ratio for AudioOutput::Queue.
+  double GetAudioRatio() const;
+
+  // Render thread, after each present.
+  void OnPresent(u64 now_us);
+  // Render thread: whether presents block on vsync. When they do not, the
+  // render loop should present only new frames rather than spin.
+  bool IsPresentPaced() const;
+
+  PaceMode GetMode() const;
+  // After both threads have stopped.
+  void LogSummary() const;
+
+ private:
+  void StartTimed(u64 now);
+  // Nudges the next deadline toward mid-refresh, so each frame is ready
+  // well before the present that shows it.
+  void AlignToPresents();
+  // A driver can ignore the vsync request; presents would then run flat
+  // out, so a measured rate that disagrees with the display drops vsync.
+  void CheckPresentRate(u64 now);
+  void NoteStretch(double stretch);
+
+  TimeSource time_{};
+  PaceMode mode_ = PaceMode::Timed;
+  bool vsync_ = true;
+  double refresh_hz_ = 0.0;
+  double present_period_us_ = 0.0;
+  int refreshes_per_frame_ = 1;
+
+  double frame_period_us_ = 0.0;
+  double next_deadline_us_ = 0.0;
+  u64 check_start_us_ = 0;
+  u64 check_presents_ = 0;
+
+  // Locked: console rate / emulated rate. Timed: 1.
+  double base_ratio_ = 1.0;
+  double audio_ratio_ = 1.0;
+  double speed_ = 1.0;  // timed schedule relative to the console rate
+  double fill_ = -1.0;  // smoothed queue level, -1 before the first report
+
+  u64 frames_ = 0;
+  u64 resyncs_ = 0;
+  double min_stretch_ = 1.0;
+  double max_stretch_ = 1.0;
+
+  // Written by the render thread.
+  std::atomic<u64> presents_{0};
+  std::atomic<u64> last_present_us_{0};
+  std::atomic<bool> present_paced_{false};
+};
+
+}  // namespace sz::app
+
+#endif
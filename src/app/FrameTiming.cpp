@@ -0,0 +1,59 @@
+#include "app/FrameTiming.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/log/Logger.h"
+
+namespace sz::app {
+
+void FrameTiming::Reset() {
+  count_ = 0;
+  started_ = false;
+}
+
+void FrameTiming::Mark(u64 now_us) {
+  if (started_) {
+    const u64 interval = std::min<u64>(now_us - last_us_, 0xFFFFFFFFu);
+    intervals_[count_ % kWindow] = static_cast<u32>(interval);
+    ++count_;
+  }
+  last_us_ = now_us;
+  started_ = true;
+}
+
+FrameTimingSummary FrameTiming::GetSummary() const {
+  FrameTimingSummary summary;
+  summary.intervals = count_;
+  const size_t n = static_cast<size_t>(std::min<u64>(count_, kWindow));
+  if (n == 0) {
+    return summary;
+  }
+  std::array<u32, kWindow> sorted{};
+  std::copy_n(intervals_.begin(), n, sorted.begin());
+  std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(n));
+
+  double sum = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += sorted[i];
+  }
+  summary.mean_us = sum / static_cast<double>(n);
+  double variance = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const double delta = sorted[i] - summary.mean_us;
+    variance += delta * delta;
+  }
+  summary.jitter_us = std::sqrt(variance / static_cast<double>(n));
+  summary.p99_us = sorted[std::min(n - 1, n * 99 / 100)];
+  summary.max_us = sorted[n - 1];
+  return summary;
+}
+
+void FrameTiming::LogSummary(const char* name) const {
+  const FrameTimingSummary summary = GetSummary();
+  SZ_LOG_INFO("%s: %llu intervals, mean %.1f us, jitter %.1f us, p99 %.1f us, max %.1f us", name,
+              static_cast<unsigned long long>(summary.intervals), summary.mean_us, summary.jitter_us,
+              summary.p99_us, summary.max_us);
+}
+
+}  // namespace sz::app
@@ -0,0 +1,40 @@
+#ifndef SUPERZ80_APP_FRAMETIMING_H
+#define SUPERZ80_APP_FRAMETIMING_H
+
+#include <array>
+#include <cstddef>
+
+#include "core/types.h"
+
+namespace sz::app {
+
+struct FrameTimingSummary {
+  u64 intervals = 0;  // since Reset, not just the window
+  double mean_us = 0.0;
+  double jitter_us = 0.0;  // standard deviation of the interval
+  double p99_us = 0.0;
+  double max_us = 0.0;
+};
+
+// Frame-to-frame interval statistics for one thread's loop (emulation or
+// render), over a sliding window. Owned and marked by that thread only.
+class FrameTiming {
+ public:
+  void Reset();
+  // Call once per frame; the first call only sets the reference point.
+  void Mark(u64 now_us);
+  FrameTimingSummary GetSummary() const;
+  void LogSummary(const char* name) const;
+
+ private:
+  static constexpr size_t kWindow = 512;
+
+  std::array<u32, kWindow> intervals_{};
+  u64 count_ = 0;
+  u64 last_us_ = 0;
+  bool started_ = false;
+};
+
+}  // namespace sz::app
+
+#endif
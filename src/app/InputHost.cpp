@@ -1,23 +1,79 @@
 #include "app/InputHost.h"
 
-#include <SDL.h>
-
 namespace sz::app {
 
-sz::input::HostButtons InputHost::ReadButtons() const {
-  sz::input::HostButtons buttons;
-  const Uint8* state = SDL_GetKeyboardState(nullptr);
+namespace {
+struct KeyBinding {
+  SDL_Scancode scancode;
+  int pad;
+  u8 bit;
+};
+
+constexpr KeyBinding kKeyBindings[] = {
+    {SDL_SCANCODE_UP, 0, 0x01},     {SDL_SCANCODE_DOWN, 0, 0x02},   {SDL_SCANCODE_LEFT, 0, 0x04},
+    {SDL_SCANCODE_RIGHT, 0, 0x08},  {SDL_SCANCODE_Z, 0, 0x10},      {SDL_SCANCODE_X, 0, 0x20},
+    {SDL_SCANCODE_RETURN, 0, 0x40}, {SDL_SCANCODE_RSHIFT, 0, 0x80}, {SDL_SCANCODE_W, 1, 0x01},
+    {SDL_SCANCODE_S, 1, 0x02},      {SDL_SCANCODE_A, 1, 0x04},      {SDL_SCANCODE_D, 1, 0x08},
+    {SDL_SCANCODE_F, 1, 0x10},      {SDL_SCANCODE_G, 1, 0x20},      {SDL_SCANCODE_1, 1, 0x40},
+    {SDL_SCANCODE_2, 1, 0x80},
+};
+}  // namespace
+
+void InputHost::Init() {
+  if (!watching_) {
+    SDL_AddEventWatch(&InputHost::OnEvent, this);
+    watching_ = true;
+  }
+}
 
-  buttons.up = state[SDL_SCANCODE_UP] != 0;
-  buttons.down = state[SDL_SCANCODE_DOWN] != 0;
-  buttons.left = state[SDL_SCANCODE_LEFT] != 0;
-  buttons.right = state[SDL_SCANCODE_RIGHT] != 0;
-  buttons.a = state[SDL_SCANCODE_Z] != 0;
-  buttons.b = state[SDL_SCANCODE_X] != 0;
-  buttons.start = state[SDL_SCANCODE_RETURN] != 0;
-  buttons.select = state[SDL_SCANCODE_RSHIFT] != 0;
+void InputHost::Shutdown() {
+  if (watching_) {
+    SDL_DelEventWatch(&InputHost::OnEvent, this);
+    watching_ = false;
+  }
+  for (auto& pad : pads_) {
+    pad.store(0, std::memory_order_relaxed);
+  }
+  rewind_held_.store(false, std::memory_order_relaxed);
+}
+
+u8 InputHost::GetPad(int pad) const {
+  return pads_[static_cast<size_t>(pad)].load(std::memory_order_relaxed);
+}
+
+bool InputHost::IsRewindHeld() const {
+  return rewind_held_.load(std::memory_order_relaxed);
+}
+
+u8 InputHost::SamplePad(void* context, int pad) {
+  return static_cast<const InputHost*>(context)->GetPad(pad);
+}
+
+// Runs as events enter SDL's queue, ahead of the app's own polling.
+int InputHost::OnEvent(void* userdata, SDL_Event* event) {
+  if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && event->key.repeat == 0) {
+    static_cast<InputHost*>(userdata)->OnKey(event->key.keysym.scancode, event->type == SDL_KEYDOWN);
+  }
+  return 0;
+}
 
-  return buttons;
+void InputHost::OnKey(SDL_Scancode scancode, bool pressed) {
+  if (scancode == SDL_SCANCODE_BACKSPACE) {
+    rewind_held_.store(pressed, std::memory_order_relaxed);
+    return;
+  }
+  for (const auto& binding : kKeyBindings) {
+    if (binding.scancode != scancode) {
+      continue;
+    }
+    auto& pad = pads_[static_cast<size_t>(binding.pad)];
+    if (pressed) {
+      pad.fetch_or(binding.bit, std::memory_order_relaxed);
+    } else {
+      pad.fetch_and(static_cast<u8>(~binding.bit), std::memory_order_relaxed);
+    }
+    return;
+  }
 }
 
 }  // namespace sz::app
@@ -1,13 +1,39 @@
 #ifndef SUPERZ80_APP_INPUTHOST_H
 #define SUPERZ80_APP_INPUTHOST_H
 
+#include <array>
+#include <atomic>
+
+#include <SDL.h>
+
+#include "core/types.h"
 #include "devices/input/InputController.h"
 
 namespace sz::app {
 
+// Keyboard state for both pads, maintained from an SDL event watch so that
+// readers never call into SDL. Pads are stored packed (see PackButtons) in
+// atomics and may be read from any thread.
+//   PAD1: arrows, Z/X, Enter/Right Shift
+//   PAD2: W/A/S/D, F/G, 1/2
 class InputHost {
  public:
-  sz::input::HostButtons ReadButtons() const;
+  void Init();
+  void Shutdown();
+
+  u8 GetPad(int pad) const;
+  bool IsRewindHeld() const;
+
+  // sz::input::PadSampler adapter; `context` is the InputHost.
+  static u8 SamplePad(void* context, int pad);
+
+ private:
+  static int OnEvent(void* userdata, SDL_Event* event);
+  void OnKey(SDL_Scancode scancode, bool pressed);
+
+  std::array<std::atomic<u8>, sz::input::kPadCount> pads_{};
+  std::atomic<bool> rewind_held_{false};
+  bool watching_ = false;
 };
 
 }  // namespace sz::app
@@ -0,0 +1,138 @@
+#include "app/InputMovie.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "core/log/Logger.h"
+#include "core/state/SaveState.h"
+
+namespace sz::app {
+
+namespace {
+constexpr u32 kMovieMagic = sz::state::MakeTag('S', 'Z', 'M', 'V');
+constexpr u16 kMovieVersion = 1;
+constexpr size_t kMovieHeaderSize = 20;
+
+void PutVarint(std::vector<u8>& out, u32 value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<u8>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<u8>(value));
+}
+
+bool GetVarint(const std::vector<u8>& in, size_t& pos, u32& value) {
+  value = 0;
+  for (int shift = 0; shift < 35 && pos < in.size(); shift += 7) {
+    const u8 byte = in[pos++];
+    value |= static_cast<u32>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+void InputMovie::BeginRecording(u64 power_on_hash) {
+  power_on_hash_ = power_on_hash;
+  frame_count_ = 0;
+  stream_.clear();
+  last_ = MovieFrame{};
+  unchanged_ = 0;
+}
+
+void InputMovie::RecordFrame(const MovieFrame& frame) {
+  if (frame != last_) {
+    PutVarint(stream_, unchanged_);
+    for (int port = 0; port < kMoviePorts; ++port) {
+      stream_.push_back(static_cast<u8>(frame[port] ^ last_[port]));
+    }
+    last_ = frame;
+    unchanged_ = 0;
+  } else {
+    ++unchanged_;
+  }
+  ++frame_count_;
+}
+
+bool InputMovie::SaveToFile(const std::string& path) const {
+  std::array<u8, kMovieHeaderSize> header{};
+  sz::state::StateWriter writer(header.data(), header.size());
+  writer.WriteU32(kMovieMagic);
+  writer.WriteU16(kMovieVersion);
+  writer.WriteU16(kMoviePorts);
+  writer.WriteU64(power_on_hash_);
+  writer.WriteU32(frame_count_);
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+  file.write(reinterpret_cast<const char*>(stream_.data()), static_cast<std::streamsize>(stream_.size()));
+  if (!file) {
+    SZ_LOG_ERROR("Failed to write movie: %s", path.c_str());
+    return false;
+  }
+  SZ_LOG_INFO("Wrote movie %s: %u frames, %zu stream bytes", path.c_str(), frame_count_,
+              stream_.size());
+  return true;
+}
+
+bool InputMovie::LoadFromFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<u8> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (!file.good() && !file.eof()) {
+    SZ_LOG_ERROR("Failed to read movie: %s", path.c_str());
+    return false;
+  }
+
+  sz::state::StateReader reader(bytes.data(), bytes.size());
+  const u32 magic = reader.ReadU32();
+  const u16 version = reader.ReadU16();
+  const u16 ports = reader.ReadU16();
+  power_on_hash_ = reader.ReadU64();
+  frame_count_ = reader.ReadU32();
+  if (!reader.Ok() || magic != kMovieMagic || version != kMovieVersion || ports != kMoviePorts) {
+    SZ_LOG_ERROR("Not a supported movie file: %s", path.c_str());
+    return false;
+  }
+
+  stream_.assign(bytes.begin() + kMovieHeaderSize, bytes.end());
+  last_ = MovieFrame{};
+  read_pos_ = 0;
+  frames_read_ = 0;
+  change_pending_ = GetVarint(stream_, read_pos_, frames_until_change_);
+  return true;
+}
+
+bool InputMovie::ReadFrame(MovieFrame& frame) {
+  if (frames_read_ >= frame_count_) {
+    return false;
+  }
+
+  if (change_pending_ && frames_until_change_ == 0) {
+    if (read_pos_ + kMoviePorts > stream_.size()) {
+      change_pending_ = false;
+    } else {
+      for (int port = 0; port < kMoviePorts; ++port) {
+        last_[port] ^= stream_[read_pos_++];
+      }
+      change_pending_ = GetVarint(stream_, read_pos_, frames_until_change_);
+    }
+  } else if (change_pending_) {
+    --frames_until_change_;
+  }
+
+  frame = last_;
+  ++frames_read_;
+  return true;
+}
+
+u64 InputMovie::GetPowerOnHash() const {
+  return power_on_hash_;
+}
+
+u32 InputMovie::GetFrameCount() const {
+  return frame_count_;
+}
+
+}  // namespace sz::app
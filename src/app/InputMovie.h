@@ -0,0 +1,52 @@
+#ifndef SUPERZ80_APP_INPUTMOVIE_H
+#define SUPERZ80_APP_INPUTMOVIE_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+
+namespace sz::app {
+
+constexpr int kMoviePorts = 2;
+using MovieFrame = std::array<u8, kMoviePorts>;  // packed HostButtons per port
+
+// Deterministic input movie.
+//   header: magic "SZMV", u16 version, u16 port count, u64 power-on state
+//           hash, u32 frame count (little-endian)
+//   stream: one record per frame whose input differs from the previous
+//           frame: varint count of unchanged frames before it, then one XOR
+//           mask byte per port. Trailing unchanged frames are implied by the
+//           header frame count.
+class InputMovie {
+ public:
+  void BeginRecording(u64 power_on_hash);
+  void RecordFrame(const MovieFrame& frame);
+  bool SaveToFile(const std::string& path) const;
+
+  bool LoadFromFile(const std::string& path);
+  // Replay cursor. Returns false once every recorded frame has been read.
+  bool ReadFrame(MovieFrame& frame);
+
+  u64 GetPowerOnHash() const;
+  u32 GetFrameCount() const;
+
+ private:
+  u64 power_on_hash_ = 0;
+  u32 frame_count_ = 0;
+  std::vector<u8> stream_{};
+
+  MovieFrame last_{};
+  u32 unchanged_ = 0;
+
+  size_t read_pos_ = 0;
+  u32 frames_read_ = 0;
+  u32 frames_until_change_ = 0;
+  bool change_pending_ = false;
+};
+
+}  // namespace sz::app
+
+#endif
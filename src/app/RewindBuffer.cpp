@@ -0,0 +1,240 @@
+#include "app/RewindBuffer.h"
+
+#include <cstring>
+
+#include "core/log/Logger.h"
+
+namespace sz::app {
+
+namespace {
+constexpr u8 kTokenZeros = 0;
+constexpr u8 kTokenLiteral = 1;
+
+// Zero runs shorter than this are folded into the surrounding literal.
+constexpr size_t kMinZeroRun = 4;
+
+size_t PutVarint(u8* out, size_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = static_cast<u8>(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = static_cast<u8>(value);
+  return n;
+}
+
+size_t GetVarint(const u8* in, size_t size, size_t& pos) {
+  size_t value = 0;
+  int shift = 0;
+  while (pos < size) {
+    const u8 byte = in[pos++];
+    value |= static_cast<size_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+    shift += 7;
+  }
+  return value;
+}
+
+// Run-length encodes a ^ b. `out` must hold at least 2 * size + 64 bytes.
+size_t EncodeXorDelta(const u8* a, const u8* b, size_t size, u8* out) {
+  size_t o = 0;
+  size_t i = 0;
+  while (i < size) {
+    size_t run = 0;
+    while (i + run < size && a[i + run] == b[i + run]) {
+      ++run;
+    }
+    if (run > 0) {
+      out[o++] = kTokenZeros;
+      o += PutVarint(out + o, run);
+      i += run;
+      continue;
+    }
+
+    size_t end = i;
+    while (end < size) {
+      if (a[end] != b[end]) {
+        ++end;
+        continue;
+      }
+      size_t z = end;
+      while (z < size && z - end < kMinZeroRun && a[z] == b[z]) {
+        ++z;
+      }
+      if (z - end >= kMinZeroRun || z == size) {
+        break;
+      }
+      end = z;
+    }
+
+    out[o++] = kTokenLiteral;
+    o += PutVarint(out + o, end - i);
+    for (; i < end; ++i) {
+      out[o++] = static_cast<u8>(a[i] ^ b[i]);
+    }
+  }
+  return o;
+}
+
+void ApplyXorDelta(const u8* delta, size_t delta_size, u8* state, size_t state_size) {
+  size_t pos = 0;
+  size_t d = 0;
+  while (d < delta_size) {
+    const u8 token = delta[d++];
+    const size_t len = GetVarint(delta, delta_size, d);
+    if (pos + len > state_size) {
+      return;
+    }
+    if (token == kTokenLiteral) {
+      for (size_t i = 0; i < len && d < delta_size; ++i) {
+        state[pos + i] ^= delta[d++];
+      }
+    }
+    pos += len;
+  }
+}
+}  // namespace
+
+RewindBuffer::~RewindBuffer() {
+  Stop();
+}
+
+void RewindBuffer::Start(size_t state_size, size_t budget_bytes) {
+  Stop();
+
+  state_size_ = state_size;
+  for (auto& slot : staging_) {
+    slot.assign(state_size, 0);
+  }
+  latest_.assign(state_size, 0);
+  encoded_.assign(state_size * 2 + 64, 0);
+  arena_.assign(budget_bytes, 0);
+  entries_.clear();
+  queued_ = 0;
+  next_to_process_ = 0;
+  write_pos_ = 0;
+  used_bytes_ = 0;
+  has_latest_ = false;
+  stop_ = false;
+
+  worker_ = std::thread(&RewindBuffer::WorkerMain, this);
+  SZ_LOG_INFO("Rewind: %zu-byte states, %zu MB history budget", state_size,
+              budget_bytes / (1024 * 1024));
+}
+
+void RewindBuffer::Stop() {
+  if (!worker_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+bool RewindBuffer::IsRunning() const {
+  return worker_.joinable();
+}
+
+u8* RewindBuffer::BeginCapture() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!worker_.joinable() || queued_ == kStagingSlots) {
+    return nullptr;
+  }
+  return staging_[(next_to_process_ + queued_) % kStagingSlots].data();
+}
+
+void RewindBuffer::EndCapture() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++queued_;
+  }
+  cv_.notify_all();
+}
+
+bool RewindBuffer::StepBack(std::vector<u8>& out) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return queued_ == 0; });
+  if (!has_latest_) {
+    return false;
+  }
+
+  if (!entries_.empty()) {
+    const Entry entry = entries_.back();
+    entries_.pop_back();
+    used_bytes_ -= entry.size;
+    ApplyXorDelta(arena_.data() + entry.offset, entry.size, latest_.data(), latest_.size());
+    write_pos_ = entry.offset;
+  }
+  out.assign(latest_.begin(), latest_.end());
+  return true;
+}
+
+size_t RewindBuffer::GetEntryCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size() + (has_latest_ ? 1 : 0);
+}
+
+size_t RewindBuffer::GetUsedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return used_bytes_;
+}
+
+void RewindBuffer::WorkerMain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    if (stop_) {
+      return;
+    }
+
+    const std::vector<u8>& snapshot = staging_[next_to_process_];
+    lock.unlock();
+
+    if (has_latest_) {
+      const size_t size = EncodeXorDelta(latest_.data(), snapshot.data(), state_size_, encoded_.data());
+      lock.lock();
+      Append(encoded_.data(), size);
+      lock.unlock();
+    }
+    std::memcpy(latest_.data(), snapshot.data(), state_size_);
+
+    lock.lock();
+    has_latest_ = true;
+    next_to_process_ = (next_to_process_ + 1) % kStagingSlots;
+    --queued_;
+    cv_.notify_all();
+  }
+}
+
+void RewindBuffer::Append(const u8* data, size_t size) {
+  if (size > arena_.size()) {
+    return;
+  }
+
+  if (write_pos_ + size > arena_.size()) {
+    // Anything left in the tail is from the previous lap, so it is older
+    // than everything at the start of the arena.
+    while (!entries_.empty() && entries_.front().offset >= write_pos_) {
+      used_bytes_ -= entries_.front().size;
+      entries_.pop_front();
+    }
+    write_pos_ = 0;
+  }
+  while (!entries_.empty() && entries_.front().offset < write_pos_ + size &&
+         entries_.front().offset + entries_.front().size > write_pos_) {
+    used_bytes_ -= entries_.front().size;
+    entries_.pop_front();
+  }
+
+  std::memcpy(arena_.data() + write_pos_, data, size);
+  entries_.push_back(Entry{write_pos_, size});
+  write_pos_ += size;
+  used_bytes_ += size;
+}
+
+}  // namespace sz::app
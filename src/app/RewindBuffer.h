@@ -0,0 +1,74 @@
+#ifndef SUPERZ80_APP_REWINDBUFFER_H
+#define SUPERZ80_APP_REWINDBUFFER_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+
+namespace sz::app {
+
+// Ring of save states for rewind. The emulation thread only copies a flat
+// snapshot into a staging slot; a worker thread XORs it against the previous
+// snapshot, run-length encodes the delta and appends it to a fixed-size
+// arena. Deltas are stored newest-to-oldest (S[k] ^ S[k+1]) so the oldest
+// entries can be evicted without breaking the chain.
+class RewindBuffer {
+ public:
+  ~RewindBuffer();
+
+  void Start(size_t state_size, size_t budget_bytes);
+  void Stop();
+  bool IsRunning() const;
+
+  // Emulation thread. Returns null if both staging slots are still queued,
+  // in which case the capture is skipped.
+  u8* BeginCapture();
+  void EndCapture();
+
+  // Emulation thread. Steps one snapshot back in time and writes it to
+  // `out`. Returns false when no history is available.
+  bool StepBack(std::vector<u8>& out);
+
+  size_t GetEntryCount() const;
+  size_t GetUsedBytes() const;
+
+ private:
+  struct Entry {
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  static constexpr size_t kStagingSlots = 2;
+
+  void WorkerMain();
+  void Append(const u8* data, size_t size);
+
+  size_t state_size_ = 0;
+  std::array<std::vector<u8>, kStagingSlots> staging_{};
+  size_t queued_ = 0;
+  size_t next_to_process_ = 0;
+  bool stop_ = false;
+
+  std::vector<u8> latest_{};
+  bool has_latest_ = false;
+  std::vector<u8> encoded_{};
+
+  std::vector<u8> arena_{};
+  size_t write_pos_ = 0;
+  size_t used_bytes_ = 0;
+  std::deque<Entry> entries_{};
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread worker_;
+};
+
+}  // namespace sz::app
+
+#endif
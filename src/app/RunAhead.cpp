@@ -0,0 +1,118 @@
+#include "app/RunAhead.h"
+
+#include "core/log/Logger.h"
+#include "core/log/Trace.h"
+
+namespace sz::app {
+
+RunAhead::~RunAhead() {
+  Stop();
+}
+
+void RunAhead::Start(int frames, bool use_second_core, const sz::console::SuperZ80Console& source) {
+  Stop();
+  frames_ = frames;
+  if (frames_ <= 0) {
+    return;
+  }
+
+  if (use_second_core) {
+    // The speculative instance mirrors the real console's cartridge; all
+    // mutable state arrives through LoadState.
+    speculative_ = std::make_unique<sz::console::SuperZ80Console>();
+    speculative_->PowerOn();
+    if (source.HasCartridge()) {
+      const std::vector<u8>& rom = source.GetCartridgeRom();
+      speculative_->LoadCartridge(rom.data(), rom.size());
+    }
+    speculative_->Reset();
+    stop_ = false;
+    job_ = false;
+    worker_ = std::thread(&RunAhead::WorkerMain, this);
+  }
+  SZ_LOG_INFO("Run-ahead: %d frame(s)%s", frames_, use_second_core ? " on a second core" : "");
+}
+
+void RunAhead::Stop() {
+  if (worker_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+  speculative_.reset();
+  frames_ = 0;
+  pending_rollback_ = false;
+}
+
+bool RunAhead::IsEnabled() const {
+  return frames_ > 0;
+}
+
+void RunAhead::StepFrame(sz::console::SuperZ80Console& console, bool keep_video) {
+  console.SetVideoOutputEnabled(keep_video);
+  console.StepFrame();
+  console.SetVideoOutputEnabled(true);
+  console.SaveState(state_);
+
+  if (speculative_) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_ = true;
+    }
+    cv_.notify_all();
+  }
+}
+
+sz::console::SuperZ80Console& RunAhead::WaitForFrame(sz::console::SuperZ80Console& console) {
+  if (speculative_) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !job_; });
+    return *speculative_;
+  }
+
+  RunSpeculativeFrames(console);
+  pending_rollback_ = true;
+  return console;
+}
+
+void RunAhead::Rollback(sz::console::SuperZ80Console& console) {
+  if (!pending_rollback_) {
+    return;
+  }
+  pending_rollback_ = false;
+  console.LoadState(state_.data(), state_.size());
+}
+
+void RunAhead::RunSpeculativeFrames(sz::console::SuperZ80Console& console) {
+  console.SetAudioOutputEnabled(false);
+  for (int i = 0; i < frames_; ++i) {
+    console.SetVideoOutputEnabled(i + 1 == frames_);
+    console.StepFrame();
+  }
+  console.SetVideoOutputEnabled(true);
+  console.SetAudioOutputEnabled(true);
+}
+
+void RunAhead::WorkerMain() {
+  sz::trace::Trace::SetThreadName("run_ahead");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || job_; });
+    if (stop_) {
+      return;
+    }
+    lock.unlock();
+
+    speculative_->LoadState(state_.data(), state_.size());
+    RunSpeculativeFrames(*speculative_);
+
+    lock.lock();
+    job_ = false;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace sz::app
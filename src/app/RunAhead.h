@@ -0,0 +1,57 @@
+#ifndef SUPERZ80_APP_RUNAHEAD_H
+#define SUPERZ80_APP_RUNAHEAD_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "console/SuperZ80Console.h"
+
+namespace sz::app {
+
+// Run-ahead latency reduction. Each host frame runs one real frame (audio
+// kept, video discarded unless asked for), snapshots it, then emulates
+// `frames` speculative frames with the same input (audio discarded, video
+// kept for the last one) and presents that. The real console is rolled
+// back to the snapshot, or, with a second core, never leaves it:
+// speculation then runs on a separate console instance on a worker thread.
+class RunAhead {
+ public:
+  ~RunAhead();
+
+  // `source` supplies the cartridge for the second-core instance.
+  void Start(int frames, bool use_second_core, const sz::console::SuperZ80Console& source);
+  void Stop();
+  bool IsEnabled() const;
+
+  // Real frame plus snapshot; with a second core this also starts the
+  // speculative frames so the caller can overlap other work. The real
+  // frame is only drawn when `keep_video` is set (for capture); until
+  // WaitForFrame it is then in `console`'s framebuffer.
+  void StepFrame(sz::console::SuperZ80Console& console, bool keep_video = false);
+  // Returns the console holding the frame to present.
+  sz::console::SuperZ80Console& WaitForFrame(sz::console::SuperZ80Console& console);
+  // Restores the real timeline after presenting. No-op with a second core.
+  void Rollback(sz::console::SuperZ80Console& console);
+
+ private:
+  void RunSpeculativeFrames(sz::console::SuperZ80Console& console);
+  void WorkerMain();
+
+  int frames_ = 0;
+  std::vector<u8> state_{};
+  bool pending_rollback_ = false;
+
+  std::unique_ptr<sz::console::SuperZ80Console> speculative_{};
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool job_ = false;
+  bool stop_ = false;
+};
+
+}  // namespace sz::app
+
+#endif
@@ -4,7 +4,7 @@
 
 namespace sz::app {
 
-bool SDLHost::Init(const std::string& title, int width, int height, int scale) {
+bool SDLHost::Init(const std::string& title, int width, int height, int scale, bool vsync) {
   scale_ = scale;
   int window_w = width * scale_;
   int window_h = height * scale_;
@@ -16,7 +16,8 @@ bool SDLHost::Init(const std::string& title, int width, int height, int scale) {
     return false;
   }
 
-  renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+  const Uint32 flags = SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0u);
+  renderer_ = SDL_CreateRenderer(window_, -1, flags);
   if (!renderer_) {
     SZ_LOG_ERROR("SDL_CreateRenderer failed: %s", SDL_GetError());
     SDL_DestroyWindow(window_);
@@ -69,4 +70,16 @@ int SDLHost::GetScale() const {
   return scale_;
 }
 
+double SDLHost::GetRefreshRate() const {
+  if (!window_) {
+    return 0.0;
+  }
+  const int display = SDL_GetWindowDisplayIndex(window_);
+  SDL_DisplayMode mode{};
+  if (display < 0 || SDL_GetCurrentDisplayMode(display, &mode) != 0) {
+    return 0.0;
+  }
+  return static_cast<double>(mode.refresh_rate);
+}
+
 }  // namespace sz::app
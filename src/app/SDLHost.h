@@ -9,13 +9,16 @@ namespace sz::app {
 
 class SDLHost {
  public:
-  bool Init(const std::string& title, int width, int height, int scale);
+  bool Init(const std::string& title, int width, int height, int scale, bool vsync);
   void Shutdown();
 
   SDL_Window* GetWindow() const;
   SDL_Renderer* GetRenderer() const;
   SDL_Texture* GetTexture() const;
   int GetScale() const;
+  // Nominal refresh of the display showing the window; 0 when SDL cannot
+  // tell.
+  double GetRefreshRate() const;
 
  private:
   SDL_Window* window_ = nullptr;
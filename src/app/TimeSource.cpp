@@ -1,12 +1,27 @@
 #include "app/TimeSource.h"
 
 #include <chrono>
+#include <thread>
 
 namespace sz::app {
 
+namespace {
+constexpr std::uint64_t kSpinTicks = 1500;
+}
+
 std::uint64_t TimeSource::NowTicks() const {
   auto now = std::chrono::steady_clock::now().time_since_epoch();
   return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
 }
 
+void TimeSource::SleepUntil(std::uint64_t ticks) const {
+  std::uint64_t now = NowTicks();
+  if (now + kSpinTicks < ticks) {
+    std::this_thread::sleep_for(std::chrono::microseconds(ticks - now - kSpinTicks));
+  }
+  while (NowTicks() < ticks) {
+    std::this_thread::yield();
+  }
+}
+
 }  // namespace sz::app
@@ -5,9 +5,13 @@
 
 namespace sz::app {
 
+// Monotonic host clock in microseconds.
 class TimeSource {
  public:
   std::uint64_t NowTicks() const;
+  // Sleeps through most of the wait and spins the last stretch, since OS
+  // sleeps commonly overshoot by a millisecond or more.
+  void SleepUntil(std::uint64_t ticks) const;
 };
 
 }  // namespace sz::app
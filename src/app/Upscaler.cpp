@@ -0,0 +1,553 @@
+#include "app/Upscaler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "core/util/Assert.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SZ_UPSCALE_SSE2 1
+#else
+#define SZ_UPSCALE_SSE2 0
+#endif
+
+namespace sz::app {
+
+namespace {
+// More bands than workers, so a worker that finishes early steals a band
+// from one stuck on a busy part of the picture.
+constexpr unsigned kBandsPerThread = 2;
+
+// CRT look: scanline gap depth, shadow-mask attenuation of the two
+// channels a column does not carry, and the overall gain that makes up
+// for both. The gain keeps every Q7 factor below 256 so products of
+// 8-bit channels still fit 16 bits.
+constexpr double kScanlineDepth = 0.5;
+constexpr double kMaskDim = 0.7;
+constexpr double kCrtBrightness = 1.25;
+constexpr int kCrtCycle = 12;
+constexpr int kCrtChannels = 4;
+
+struct FilterName {
+  UpscaleFilter filter;
+  const char* name;
+};
+
+constexpr FilterName kFilterNames[] = {
+    {UpscaleFilter::None, "none"},       {UpscaleFilter::Nearest, "nearest"}, {UpscaleFilter::Scale2x, "scale2x"},
+    {UpscaleFilter::Scale3x, "scale3x"}, {UpscaleFilter::Xbr, "xbr"},         {UpscaleFilter::Crt, "crt"},
+};
+
+#if SZ_UPSCALE_SSE2
+__m128i Load(const u32* pixels) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+void Store(u32* pixels, __m128i value) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+}
+
+__m128i Select(__m128i mask, __m128i if_set, __m128i if_clear) {
+  return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+}
+#endif
+
+// Writes each of `count` pixels (a multiple of four) `scale` times.
+void ExpandRow(const u32* src, int count, int scale, u32* dst) {
+  if (scale == 1) {
+    std::memcpy(dst, src, static_cast<size_t>(count) * sizeof(u32));
+    return;
+  }
+#if SZ_UPSCALE_SSE2
+  if (scale == 2) {
+    for (int x = 0; x < count; x += 4) {
+      const __m128i p = Load(src + x);
+      Store(dst + 2 * x, _mm_unpacklo_epi32(p, p));
+      Store(dst + 2 * x + 4, _mm_unpackhi_epi32(p, p));
+    }
+    return;
+  }
+  if (scale == 3) {
+    for (int x = 0; x < count; x += 4) {
+      const __m128i p = Load(src + x);
+      Store(dst + 3 * x, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 0, 0)));
+      Store(dst + 3 * x + 4, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 1, 1)));
+      Store(dst + 3 * x + 8, _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 2)));
+    }
+    return;
+  }
+  for (int x = 0; x < count; ++x) {
+    const __m128i p = _mm_set1_epi32(static_cast<int>(src[x]));
+    u32* out = dst + x * scale;
+    int i = 0;
+    for (; i + 4 <= scale; i += 4) {
+      Store(out + i, p);
+    }
+    std::fill_n(out + i, scale - i, src[x]);
+  }
+#else
+  for (int x = 0; x < count; ++x) {
+    std::fill_n(dst + x * scale, scale, src[x]);
+  }
+#endif
+}
+
+// Nearest resampling of a `factor`-times row to `scale` times; `columns`
+// gives the sub-pixel shown by each output column of a source pixel.
+void ResampleRow(const u32* src, int factor, int scale, const u8* columns, u32* dst) {
+  if (scale % factor == 0) {
+    ExpandRow(src, kScreenWidth * factor, scale / factor, dst);
+    return;
+  }
+  for (int x = 0; x < kScreenWidth; ++x) {
+    const u32* in = src + x * factor;
+    u32* out = dst + x * scale;
+    for (int i = 0; i < scale; ++i) {
+      out[i] = in[columns[i]];
+    }
+  }
+}
+
+// One output row of Scale2x: sub-row 0 follows the row above, 1 the row
+// below. Rows point into the padded source, so x - 1 and x + 1 are valid.
+void Scale2xRow(const u32* up, const u32* mid, const u32* down, int sub_row, u32* dst) {
+  const u32* vert = sub_row == 0 ? up : down;
+#if SZ_UPSCALE_SSE2
+  for (int x = 0; x < kScreenWidth; x += 4) {
+    const __m128i e = Load(mid + x);
+    const __m128i d = Load(mid + x - 1);
+    const __m128i f = Load(mid + x + 1);
+    const __m128i v = Load(vert + x);
+    const __m128i flat = _mm_or_si128(_mm_cmpeq_epi32(Load(up + x), Load(down + x)), _mm_cmpeq_epi32(d, f));
+    const __m128i left = Select(_mm_andnot_si128(flat, _mm_cmpeq_epi32(d, v)), d, e);
+    const __m128i right = Select(_mm_andnot_si128(flat, _mm_cmpeq_epi32(f, v)), f, e);
+    Store(dst + 2 * x, _mm_unpacklo_epi32(left, right));
+    Store(dst + 2 * x + 4, _mm_unpackhi_epi32(left, right));
+  }
+#else
+  for (int x = 0; x < kScreenWidth; ++x) {
+    const u32 d = mid[x - 1];
+    const u32 e = mid[x];
+    const u32 f = mid[x + 1];
+    const bool flat = up[x] == down[x] || d == f;
+    dst[2 * x] = !flat && d == vert[x] ? d : e;
+    dst[2 * x + 1] = !flat && f == vert[x] ? f : e;
+  }
+#endif
+}
+
+// One output row of Scale3x (AdvMAME3x rules).
+template <int kSubRow>
+void Scale3xRow(const u32* up, const u32* mid, const u32* down, u32* dst) {
+  for (int x = 0; x < kScreenWidth; ++x) {
+    const u32 a = up[x - 1];
+    const u32 b = up[x];
+    const u32 c = up[x + 1];
+    const u32 d = mid[x - 1];
+    const u32 e = mid[x];
+    const u32 f = mid[x + 1];
+    const u32 g = down[x - 1];
+    const u32 h = down[x];
+    const u32 i = down[x + 1];
+    u32* out = dst + 3 * x;
+    if (b == h || d == f) {
+      out[0] = e;
+      out[1] = e;
+      out[2] = e;
+    } else if constexpr (kSubRow == 0) {
+      out[0] = d == b ? d : e;
+      out[1] = (d == b && e != c) || (b == f && e != a) ? b : e;
+      out[2] = b == f ? f : e;
+    } else if constexpr (kSubRow == 1) {
+      out[0] = (d == b && e != g) || (d == h && e != a) ? d : e;
+      out[1] = e;
+      out[2] = (b == f && e != i) || (h == f && e != c) ? f : e;
+    } else {
+      out[0] = d == h ? d : e;
+      out[1] = (d == h && e != i) || (h == f && e != g) ? h : e;
+      out[2] = h == f ? f : e;
+    }
+  }
+}
+
+void Scale3xRow(const u32* up, const u32* mid, const u32* down, int sub_row, u32* dst) {
+  switch (sub_row) {
+    case 0:
+      Scale3xRow<0>(up, mid, down, dst);
+      break;
+    case 1:
+      Scale3xRow<1>(up, mid, down, dst);
+      break;
+    default:
+      Scale3xRow<2>(up, mid, down, dst);
+      break;
+  }
+}
+
+// Y, U and V in one word (8 bits each, U and V offset by 128).
+u32 ToYuv(u32 argb) {
+  const int r = static_cast<int>((argb >> 16) & 0xFF);
+  const int g = static_cast<int>((argb >> 8) & 0xFF);
+  const int b = static_cast<int>(argb & 0xFF);
+  const int y = (77 * r + 150 * g + 29 * b) >> 8;
+  const int u = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+  const int v = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+  return static_cast<u32>((y << 16) | (u << 8) | v);
+}
+
+// Perceptual distance, luma weighted well above chroma as in xBR.
+int YuvDistance(u32 a, u32 b) {
+  const int dy = static_cast<int>((a >> 16) & 0xFF) - static_cast<int>((b >> 16) & 0xFF);
+  const int du = static_cast<int>((a >> 8) & 0xFF) - static_cast<int>((b >> 8) & 0xFF);
+  const int dv = static_cast<int>(a & 0xFF) - static_cast<int>(b & 0xFF);
+  return 48 * std::abs(dy) + 7 * std::abs(du) + 6 * std::abs(dv);
+}
+
+// a + (b - a) * weight / 256 on all four channels, two at a time.
+u32 Blend(u32 a, u32 b, u32 weight) {
+  const u32 keep = 256 - weight;
+  const u32 rb = (((a & 0x00FF00FFu) * keep + (b & 0x00FF00FFu) * weight) >> 8) & 0x00FF00FFu;
+  const u32 ag = (((a >> 8) & 0x00FF00FFu) * keep + ((b >> 8) & 0x00FF00FFu) * weight) & 0xFF00FF00u;
+  return rb | ag;
+}
+
+// Distance between two diagonal neighbours kA and kB (offsets from the
+// same pixel), read from the precomputed planes.
+template <int kWidth, int kA, int kB>
+int Diagonal(const u16* down_right, const u16* down_left) {
+  constexpr int kUpper = kA < kB ? kA : kB;
+  constexpr int kStep = kA < kB ? kB - kA : kA - kB;
+  static_assert(kStep == kWidth + 1 || kStep == kWidth - 1);
+  if constexpr (kStep == kWidth + 1) {
+    return down_right[kUpper];
+  } else {
+    return down_left[kUpper];
+  }
+}
+
+// xBR level 1 rule for one corner of a source pixel. kDx and kDy step
+// towards the corner (one pixel, one padded row of kWidth); that makes E
+// the centre, F and H its corner-side neighbours and I the diagonal. The
+// corner is smoothed when the gradients across the F-H diagonal are
+// weaker than those across E-I, towards whichever of F and H is closer
+// to E.
+template <int kWidth, int kDx, int kDy>
+bool XbrCorner(const u32* pixel, const u32* yuv, const u16* dr, const u16* dl, u32& color) {
+  const u32 e = pixel[0];
+  const u32 f = pixel[kDx];
+  const u32 h = pixel[kDy];
+  if (e == f || e == h) {
+    return false;
+  }
+  constexpr int kI = kDx + kDy;
+  const int across = Diagonal<kWidth, 0, kDx - kDy>(dr, dl) + Diagonal<kWidth, 0, kDy - kDx>(dr, dl) +
+                     Diagonal<kWidth, kI, 2 * kDx>(dr, dl) + Diagonal<kWidth, kI, 2 * kDy>(dr, dl) +
+                     4 * Diagonal<kWidth, kDy, kDx>(dr, dl);
+  const int along = Diagonal<kWidth, kDy, -kDx>(dr, dl) + Diagonal<kWidth, kDy, kI + kDy>(dr, dl) +
+                    Diagonal<kWidth, kDx, kI + kDx>(dr, dl) + Diagonal<kWidth, kDx, -kDy>(dr, dl) +
+                    4 * Diagonal<kWidth, 0, kI>(dr, dl);
+  if (across >= along) {
+    return false;
+  }
+  color = YuvDistance(yuv[0], yuv[kDx]) <= YuvDistance(yuv[0], yuv[kDy]) ? f : h;
+  return true;
+}
+
+// Q7 channel gains, ordered like the framebuffer's bytes (B, G, R, A).
+void CrtRow(const u32* src, int count, const u16* gains, u32* dst) {
+#if SZ_UPSCALE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  int group = 0;
+  for (int x = 0; x < count; x += 4) {
+    const __m128i p = Load(src + x);
+    const u16* g = gains + group * 4 * kCrtChannels;
+    const __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(g)));
+    const __m128i hi =
+        _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(g + 8)));
+    Store(dst + x, _mm_packus_epi16(_mm_srli_epi16(lo, 7), _mm_srli_epi16(hi, 7)));
+    group = group == 2 ? 0 : group + 1;
+  }
+#else
+  for (int x = 0; x < count; ++x) {
+    const u16* g = gains + (x % kCrtCycle) * kCrtChannels;
+    u32 out = 0;
+    for (int channel = 0; channel < kCrtChannels; ++channel) {
+      const u32 value = (src[x] >> (8 * channel)) & 0xFF;
+      out |= std::min<u32>((value * g[channel]) >> 7, 0xFF) << (8 * channel);
+    }
+    dst[x] = out;
+  }
+#endif
+}
+}  // namespace
+
+bool ParseUpscaleFilter(const std::string& name, UpscaleFilter& out) {
+  for (const FilterName& entry : kFilterNames) {
+    if (name == entry.name) {
+      out = entry.filter;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* UpscaleFilterName(UpscaleFilter filter) {
+  for (const FilterName& entry : kFilterNames) {
+    if (entry.filter == filter) {
+      return entry.name;
+    }
+  }
+  return "?";
+}
+
+Upscaler::Upscaler(unsigned threads) {
+  if (threads == 0) {
+    const unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    threads = std::min(hardware - 1, kMaxAutoThreads);
+  }
+  threads_ = threads;
+  if (threads_ > 1) {
+    pool_ = std::make_unique<sz::util::WorkStealingPool>(threads_);
+  }
+  band_scratch_.resize(threads_ > 1 ? threads_ * kBandsPerThread : 1);
+  padded_.resize(static_cast<size_t>(kPaddedWidth) * kPaddedHeight);
+  const size_t bands = band_scratch_.size();
+  const size_t xbr_rows = (kScreenHeight + bands - 1) / bands + 2 * kBorder;
+  for (BandScratch& scratch : band_scratch_) {
+    scratch.yuv.resize(xbr_rows * kPaddedWidth);
+    scratch.down_right.resize(scratch.yuv.size());
+    scratch.down_left.resize(scratch.yuv.size());
+  }
+}
+
+unsigned Upscaler::GetThreadCount() const {
+  return threads_;
+}
+
+void Upscaler::Configure(int scale) {
+  scale_ = scale;
+  for (BandScratch& scratch : band_scratch_) {
+    scratch.line.assign(static_cast<size_t>(kScreenWidth) * std::max(scale, 3), 0);
+  }
+  for (int factor = 2; factor <= 3; ++factor) {
+    std::vector<u8>& columns = resample_columns_[factor - 2];
+    columns.resize(static_cast<size_t>(scale));
+    for (int i = 0; i < scale; ++i) {
+      columns[static_cast<size_t>(i)] = static_cast<u8>(i * factor / scale);
+    }
+  }
+
+  // Output pixel centres (u, v) in source-pixel units; the lower-right
+  // corner is cut along u + v = 1.5, antialiased over one output pixel.
+  xbr_taps_.clear();
+  for (int j = 0; j < scale; ++j) {
+    for (int i = 0; i < scale; ++i) {
+      const double u = (i + 0.5) / scale;
+      const double v = (j + 0.5) / scale;
+      const double coverage = std::clamp((u + v - 1.5) * scale + 0.5, 0.0, 1.0);
+      const u16 weight = static_cast<u16>(coverage * 256.0 + 0.5);
+      if (weight != 0) {
+        xbr_taps_.push_back({static_cast<u8>(i), static_cast<u8>(j), weight});
+      }
+    }
+  }
+
+  // Each source row lights its top output row fully and fades towards
+  // the gap; columns cycle through red, green and blue mask stripes.
+  crt_gains_.assign(static_cast<size_t>(scale) * kCrtCycle * kCrtChannels, 0);
+  for (int j = 0; j < scale; ++j) {
+    const double depth = scale > 1 ? static_cast<double>(j) / (scale - 1) : 0.0;
+    const double row = 1.0 - kScanlineDepth * depth * depth;
+    u16* gains = crt_gains_.data() + static_cast<size_t>(j) * kCrtCycle * kCrtChannels;
+    for (int x = 0; x < kCrtCycle; ++x) {
+      const int lit = 2 - x % 3;  // byte of the column's channel: R, G, B
+      for (int channel = 0; channel < kCrtChannels; ++channel) {
+        double gain = 1.0;
+        if (channel != 3) {
+          gain = row * kCrtBrightness * (channel == lit ? 1.0 : kMaskDim);
+        }
+        gains[x * kCrtChannels + channel] = static_cast<u16>(gain * 128.0 + 0.5);
+      }
+    }
+  }
+}
+
+void Upscaler::Run(UpscaleFilter filter, int scale, const sz::ppu::Framebuffer& source, u32* out, int out_pitch) {
+  SZ_ASSERT(scale >= 1);
+  SZ_ASSERT(source.width == kScreenWidth && source.height == kScreenHeight);
+  if (scale != scale_) {
+    Configure(scale);
+  }
+  if (filter == UpscaleFilter::Scale2x || filter == UpscaleFilter::Scale3x || filter == UpscaleFilter::Xbr) {
+    PadSource(source);
+  }
+
+  const Target target{out, out_pitch, scale};
+  if (!pool_) {
+    RunBand(filter, source, target, 0, kScreenHeight, band_scratch_[0]);
+    return;
+  }
+  const int bands = static_cast<int>(band_scratch_.size());
+  for (int band = 0; band < bands; ++band) {
+    const int first_row = kScreenHeight * band / bands;
+    const int end_row = kScreenHeight * (band + 1) / bands;
+    BandScratch* scratch = &band_scratch_[static_cast<size_t>(band)];
+    pool_->Submit([this, filter, &source, target, first_row, end_row, scratch] {
+      RunBand(filter, source, target, first_row, end_row, *scratch);
+    });
+  }
+  pool_->Wait();
+}
+
+void Upscaler::PadSource(const sz::ppu::Framebuffer& source) {
+  for (int row = 0; row < kPaddedHeight; ++row) {
+    const int y = std::clamp(row - kBorder, 0, kScreenHeight - 1);
+    const u32* src = source.pixels.data() + static_cast<size_t>(y) * kScreenWidth;
+    u32* dst = padded_.data() + static_cast<size_t>(row) * kPaddedWidth;
+    std::fill_n(dst, kBorder, src[0]);
+    std::memcpy(dst + kBorder, src, kScreenWidth * sizeof(u32));
+    std::fill_n(dst + kBorder + kScreenWidth, kBorder, src[kScreenWidth - 1]);
+  }
+}
+
+void Upscaler::RunBand(UpscaleFilter filter, const sz::ppu::Framebuffer& source, const Target& target,
+                       int first_row, int end_row, BandScratch& scratch) const {
+  switch (filter) {
+    case UpscaleFilter::None:
+    case UpscaleFilter::Nearest:
+      NearestBand(source, target, first_row, end_row);
+      break;
+    case UpscaleFilter::Scale2x:
+      ScaleKxBand(2, target, first_row, end_row, scratch);
+      break;
+    case UpscaleFilter::Scale3x:
+      ScaleKxBand(3, target, first_row, end_row, scratch);
+      break;
+    case UpscaleFilter::Xbr:
+      XbrBand(target, first_row, end_row, scratch);
+      break;
+    case UpscaleFilter::Crt:
+      CrtBand(source, target, first_row, end_row, scratch);
+      break;
+  }
+}
+
+void Upscaler::NearestBand(const sz::ppu::Framebuffer& source, const Target& target, int first_row,
+                           int end_row) const {
+  const int s = target.scale;
+  const size_t row_bytes = static_cast<size_t>(kScreenWidth) * s * sizeof(u32);
+  for (int y = first_row; y < end_row; ++y) {
+    u32* row = target.out + static_cast<ptrdiff_t>(y) * s * target.pitch;
+    ExpandRow(source.pixels.data() + static_cast<size_t>(y) * kScreenWidth, kScreenWidth, s, row);
+    for (int j = 1; j < s; ++j) {
+      std::memcpy(row + static_cast<ptrdiff_t>(j) * target.pitch, row, row_bytes);
+    }
+  }
+}
+
+void Upscaler::ScaleKxBand(int factor, const Target& target, int first_row, int end_row,
+                           BandScratch& scratch) const {
+  const int s = target.scale;
+  const size_t row_bytes = static_cast<size_t>(kScreenWidth) * s * sizeof(u32);
+  for (int y = first_row; y < end_row; ++y) {
+    const u32* mid = padded_.data() + static_cast<size_t>(y + kBorder) * kPaddedWidth + kBorder;
+    const u32* up = mid - kPaddedWidth;
+    const u32* down = mid + kPaddedWidth;
+    u32* row = target.out + static_cast<ptrdiff_t>(y) * s * target.pitch;
+    // Output row j shows sub-row j * factor / s; consecutive rows showing
+    // the same sub-row are copies.
+    int j = 0;
+    for (int sub_row = 0; sub_row < factor && j < s; ++sub_row) {
+      if (j * factor / s != sub_row) {
+        continue;
+      }
+      u32* first = row + static_cast<ptrdiff_t>(j) * target.pitch;
+      u32* line = s == factor ? first : scratch.line.data();
+      if (factor == 2) {
+        Scale2xRow(up, mid, down, sub_row, line);
+      } else {
+        Scale3xRow(up, mid, down, sub_row, line);
+      }
+      if (s != factor) {
+        ResampleRow(line, factor, s, resample_columns_[factor - 2].data(), first);
+      }
+      for (++j; j < s && j * factor / s == sub_row; ++j) {
+        std::memcpy(row + static_cast<ptrdiff_t>(j) * target.pitch, first, row_bytes);
+      }
+    }
+  }
+}
+
+void Upscaler::XbrBand(const Target& target, int first_row, int end_row, BandScratch& scratch) const {
+  constexpr int kW = kPaddedWidth;
+  // Local planes start at padded row first_row, two rows above the band,
+  // and end two rows below it.
+  const int rows = end_row - first_row + 2 * kBorder;
+  const u32* padded = padded_.data() + static_cast<size_t>(first_row) * kW;
+  const size_t count = static_cast<size_t>(rows) * kW;
+  std::transform(padded, padded + count, scratch.yuv.begin(), ToYuv);
+  for (int row = 0; row + 1 < rows; ++row) {
+    const u32* yuv = scratch.yuv.data() + static_cast<size_t>(row) * kW;
+    u16* down_right = scratch.down_right.data() + static_cast<size_t>(row) * kW;
+    u16* down_left = scratch.down_left.data() + static_cast<size_t>(row) * kW;
+    for (int x = 0; x < kW; ++x) {
+      down_right[x] = static_cast<u16>(x + 1 < kW ? YuvDistance(yuv[x], yuv[x + kW + 1]) : 0);
+      down_left[x] = static_cast<u16>(x > 0 ? YuvDistance(yuv[x], yuv[x + kW - 1]) : 0);
+    }
+  }
+
+  const int s = target.scale;
+  for (int y = first_row; y < end_row; ++y) {
+    const size_t local = static_cast<size_t>(y - first_row + kBorder) * kW + kBorder;
+    const size_t offset = static_cast<size_t>(y + kBorder) * kW + kBorder;
+    u32* row = target.out + static_cast<ptrdiff_t>(y) * s * target.pitch;
+    for (int x = 0; x < kScreenWidth; ++x) {
+      const u32* pixel = padded_.data() + offset + x;
+      const u32* yuv = scratch.yuv.data() + local + x;
+      const u16* dr = scratch.down_right.data() + local + x;
+      const u16* dl = scratch.down_left.data() + local + x;
+      // Corner index bit 0: right, bit 1: down.
+      u32 colors[4] = {};
+      const bool active[4] = {
+          XbrCorner<kW, -1, -kW>(pixel, yuv, dr, dl, colors[0]),
+          XbrCorner<kW, 1, -kW>(pixel, yuv, dr, dl, colors[1]),
+          XbrCorner<kW, -1, kW>(pixel, yuv, dr, dl, colors[2]),
+          XbrCorner<kW, 1, kW>(pixel, yuv, dr, dl, colors[3]),
+      };
+      u32* block = row + x * s;
+      for (int j = 0; j < s; ++j) {
+        std::fill_n(block + static_cast<ptrdiff_t>(j) * target.pitch, s, pixel[0]);
+      }
+      for (int corner = 0; corner < 4; ++corner) {
+        if (!active[corner]) {
+          continue;
+        }
+        for (const XbrTap& tap : xbr_taps_) {
+          const int i = corner & 1 ? tap.column : s - 1 - tap.column;
+          const int j = corner & 2 ? tap.row : s - 1 - tap.row;
+          u32& out = block[static_cast<ptrdiff_t>(j) * target.pitch + i];
+          out = Blend(out, colors[corner], tap.weight);
+        }
+      }
+    }
+  }
+}
+
+void Upscaler::CrtBand(const sz::ppu::Framebuffer& source, const Target& target, int first_row, int end_row,
+                       BandScratch& scratch) const {
+  const int s = target.scale;
+  const int width = kScreenWidth * s;
+  for (int y = first_row; y < end_row; ++y) {
+    ExpandRow(source.pixels.data() + static_cast<size_t>(y) * kScreenWidth, kScreenWidth, s, scratch.line.data());
+    u32* row = target.out + static_cast<ptrdiff_t>(y) * s * target.pitch;
+    for (int j = 0; j < s; ++j) {
+      const u16* gains = crt_gains_.data() + static_cast<size_t>(j) * kCrtCycle * kCrtChannels;
+      CrtRow(scratch.line.data(), width, gains, row + static_cast<ptrdiff_t>(j) * target.pitch);
+    }
+  }
+}
+
+}  // namespace sz::app
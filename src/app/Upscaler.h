@@ -0,0 +1,103 @@
+#ifndef SUPERZ80_APP_UPSCALER_H
+#define SUPERZ80_APP_UPSCALER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+#include "core/util/NonCopyable.h"
+#include "core/util/WorkStealingPool.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::app {
+
+enum class UpscaleFilter : u8 {
+  None,  // the renderer scales the native texture
+  Nearest,
+  Scale2x,
+  Scale3x,
+  Xbr,
+  Crt,
+};
+
+bool ParseUpscaleFilter(const std::string& name, UpscaleFilter& out);
+const char* UpscaleFilterName(UpscaleFilter filter);
+
+// CPU-side upscaling of the framebuffer to `scale` times its size, for
+// hosts whose renderer would otherwise scale in software. Work is split
+// into horizontal bands of whole source rows, run on a small pool while
+// the caller waits. Scale2x/3x compute their own 2x/3x grid and resample
+// it to `scale` with nearest neighbour, so every filter fills the window.
+class Upscaler : private sz::util::NonCopyable {
+ public:
+  // 0 threads: one per hardware thread, leaving one to the emulation
+  // thread, and at most kMaxAutoThreads.
+  explicit Upscaler(unsigned threads = 0);
+
+  static constexpr unsigned kMaxAutoThreads = 4;
+
+  unsigned GetThreadCount() const;
+  // `out` holds scale * kScreenHeight rows of `out_pitch` pixels, each at
+  // least scale * kScreenWidth wide.
+  void Run(UpscaleFilter filter, int scale, const sz::ppu::Framebuffer& source, u32* out, int out_pitch);
+
+ private:
+  // Source copy with a clamped border, so the edge filters read their
+  // neighbourhood without bounds checks.
+  static constexpr int kBorder = 2;
+  static constexpr int kPaddedWidth = kScreenWidth + 2 * kBorder;
+  static constexpr int kPaddedHeight = kScreenHeight + 2 * kBorder;
+
+  struct Target {
+    u32* out = nullptr;
+    int pitch = 0;
+    int scale = 1;
+  };
+
+  // Per band, so bands share nothing writable.
+  struct BandScratch {
+    std::vector<u32> line;
+    // xBR: YUV of the band's padded rows plus two on each side, and the
+    // distance from each of those pixels to its lower-right and lower-left
+    // neighbours; every xBR gradient term is one of these diagonals.
+    std::vector<u32> yuv;
+    std::vector<u16> down_right;
+    std::vector<u16> down_left;
+  };
+
+  void Configure(int scale);
+  void PadSource(const sz::ppu::Framebuffer& source);
+  void RunBand(UpscaleFilter filter, const sz::ppu::Framebuffer& source, const Target& target, int first_row,
+               int end_row, BandScratch& scratch) const;
+  void NearestBand(const sz::ppu::Framebuffer& source, const Target& target, int first_row, int end_row) const;
+  void ScaleKxBand(int factor, const Target& target, int first_row, int end_row, BandScratch& scratch) const;
+  void XbrBand(const Target& target, int first_row, int end_row, BandScratch& scratch) const;
+  void CrtBand(const sz::ppu::Framebuffer& source, const Target& target, int first_row, int end_row,
+               BandScratch& scratch) const;
+
+  std::unique_ptr<sz::util::WorkStealingPool> pool_;  // null: run on the caller
+  unsigned threads_ = 1;
+  int scale_ = 0;
+  std::vector<u32> padded_;
+  std::vector<BandScratch> band_scratch_;
+  // Scale2x/3x at a scale that is not a multiple: the sub-pixel column
+  // each output column within a source pixel shows.
+  std::vector<u8> resample_columns_[2];
+  // xBR: output pixels of a source pixel that the lower-right corner
+  // colour blends into, with weights (1..256); other corners mirror them.
+  struct XbrTap {
+    u8 column = 0;
+    u8 row = 0;
+    u16 weight = 0;
+  };
+  std::vector<XbrTap> xbr_taps_;
+  // CRT: per output row within a source row, Q7 channel gains for a
+  // 12-pixel cycle (three vectors of four pixels, the mask repeats every
+  // three columns), in framebuffer byte order.
+  std::vector<u16> crt_gains_;
+};
+
+}  // namespace sz::app
+
+#endif
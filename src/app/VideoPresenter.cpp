@@ -1,27 +1,87 @@
 #include "app/VideoPresenter.h"
 
 #include "core/log/Logger.h"
+#include "core/log/Trace.h"
 #include "core/types.h"
 
 namespace sz::app {
 
-void VideoPresenter::Present(SDLHost& host, const sz::ppu::Framebuffer& framebuffer) {
-  SDL_Renderer* renderer = host.GetRenderer();
-  SDL_Texture* texture = host.GetTexture();
-  if (!renderer || !texture) {
+void VideoPresenter::Init(SDLHost& host, UpscaleFilter filter, unsigned threads) {
+  if (filter == UpscaleFilter::None) {
+    return;
+  }
+  const int scale = host.GetScale();
+  if (scale == 1 && filter != UpscaleFilter::Crt) {
+    SZ_LOG_INFO("Upscale filter %s does nothing at scale 1", UpscaleFilterName(filter));
+    return;
+  }
+  scaled_texture_ = SDL_CreateTexture(host.GetRenderer(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                      kScreenWidth * scale, kScreenHeight * scale);
+  if (!scaled_texture_) {
+    SZ_LOG_WARN("Upscale filter %s disabled: SDL_CreateTexture failed: %s", UpscaleFilterName(filter),
+                SDL_GetError());
     return;
   }
+  filter_ = filter;
+  upscaler_ = std::make_unique<Upscaler>(threads);
+  SZ_LOG_INFO("Upscale filter %s at %dx on %u thread(s)", UpscaleFilterName(filter_), scale,
+              upscaler_->GetThreadCount());
+}
+
+void VideoPresenter::Shutdown() {
+  upscaler_.reset();
+  if (scaled_texture_) {
+    SDL_DestroyTexture(scaled_texture_);
+    scaled_texture_ = nullptr;
+  }
+  filter_ = UpscaleFilter::None;
+}
 
+void VideoPresenter::Upload(SDLHost& host, const sz::ppu::Framebuffer& framebuffer) {
+  if (scaled_texture_) {
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(scaled_texture_, nullptr, &pixels, &pitch) != 0) {
+      SZ_LOG_WARN("SDL_LockTexture failed: %s", SDL_GetError());
+      return;
+    }
+    {
+      SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "upscale");
+      upscaler_->Run(filter_, host.GetScale(), framebuffer, static_cast<u32*>(pixels),
+                     pitch / static_cast<int>(sizeof(u32)));
+    }
+    SDL_UnlockTexture(scaled_texture_);
+    return;
+  }
+  SDL_Texture* texture = host.GetTexture();
+  if (!texture) {
+    return;
+  }
   const int pitch = framebuffer.width * static_cast<int>(sizeof(u32));
   if (SDL_UpdateTexture(texture, nullptr, framebuffer.pixels.data(), pitch) != 0) {
     SZ_LOG_WARN("SDL_UpdateTexture failed: %s", SDL_GetError());
   }
+}
 
+void VideoPresenter::Draw(SDLHost& host) {
+  SDL_Renderer* renderer = host.GetRenderer();
+  SDL_Texture* texture = scaled_texture_ ? scaled_texture_ : host.GetTexture();
+  if (!renderer || !texture) {
+    return;
+  }
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
   SDL_RenderClear(renderer);
 
-  SDL_Rect dest{0, 0, framebuffer.width * host.GetScale(), framebuffer.height * host.GetScale()};
+  SDL_Rect dest{0, 0, kScreenWidth * host.GetScale(), kScreenHeight * host.GetScale()};
   SDL_RenderCopy(renderer, texture, nullptr, &dest);
+}
+
+void VideoPresenter::Present(SDLHost& host) {
+  SDL_Renderer* renderer = host.GetRenderer();
+  if (!renderer) {
+    return;
+  }
+  SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "vsync_wait");
   SDL_RenderPresent(renderer);
 }
 
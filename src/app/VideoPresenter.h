@@ -1,14 +1,33 @@
 #ifndef SUPERZ80_APP_VIDEOPRESENTER_H
 #define SUPERZ80_APP_VIDEOPRESENTER_H
 
+#include <memory>
+
 #include "app/SDLHost.h"
+#include "app/Upscaler.h"
 #include "devices/ppu/PPU.h"
 
 namespace sz::app {
 
+// Render-thread side of a host frame: Upload when a new emulated frame
+// arrives, Draw every host frame, overlays (the debug UI) on top, then
+// Present. With an upscale filter, Upload also scales the frame on the
+// CPU into a window-sized texture, so the renderer only copies it 1:1.
 class VideoPresenter {
  public:
-  void Present(SDLHost& host, const sz::ppu::Framebuffer& framebuffer);
+  // Falls back to renderer scaling (and logs why) when the filter has
+  // nothing to do or its texture cannot be created.
+  void Init(SDLHost& host, UpscaleFilter filter, unsigned threads);
+  void Shutdown();
+
+  void Upload(SDLHost& host, const sz::ppu::Framebuffer& framebuffer);
+  void Draw(SDLHost& host);
+  void Present(SDLHost& host);
+
+ private:
+  UpscaleFilter filter_ = UpscaleFilter::None;
+  std::unique_ptr<Upscaler> upscaler_;
+  SDL_Texture* scaled_texture_ = nullptr;
 };
 
 }  // namespace sz::app
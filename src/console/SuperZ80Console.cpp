@@ -1,105 +1,489 @@
 #include "console/SuperZ80Console.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include "core/log/Logger.h"
+#include "core/log/Trace.h"
 #include "core/types.h"
 #include "core/util/Assert.h"
+#include "core/util/Hash.h"
 
 namespace sz::console {
 
+namespace {
+void ClearFramebuffer(sz::ppu::Framebuffer& framebuffer) {
+  framebuffer.width = kScreenWidth;
+  framebuffer.height = kScreenHeight;
+  framebuffer.pixels.fill(0xFF000000u);
+}
+}  // namespace
+
+SuperZ80Console::SuperZ80Console() {
+  Wire();
+}
+
+const SuperZ80Console::Arena& SuperZ80Console::PowerOnArena() {
+  static const std::unique_ptr<const Arena> image = [] {
+    auto arena = std::make_unique<Arena>();
+    arena->cpu.Reset();
+    arena->bus.Reset();
+    arena->irq.Reset();
+    arena->scheduler.Reset();
+    arena->cartridge.Reset();
+    arena->ppu.Reset();
+    arena->dma.Reset();
+    arena->apu.Reset();
+    arena->input.Reset();
+    ClearFramebuffer(arena->framebuffer);
+    return arena;
+  }();
+  return *image;
+}
+
+void SuperZ80Console::Wire() {
+  sz::bus::Devices devices;
+  devices.cart = &arena_.cartridge;
+  devices.ppu = &arena_.ppu;
+  devices.apu = &arena_.apu;
+  devices.irq = &arena_.irq;
+  devices.input = &arena_.input;
+  devices.dma = &arena_.dma;
+  arena_.bus.Attach(devices);
+  arena_.bus.AttachWorkRam(&work_ram_);
+  arena_.bus.AttachWatchList(&watchpoints_);
+  arena_.dma.Attach(&arena_.bus, &arena_.ppu);
+  arena_.ppu.AttachFramebuffer(&arena_.framebuffer);
+  arena_.ppu.AttachMemory(&ppu_memory_);
+  arena_.ppu.SetOutputEnabled(video_output_);
+  arena_.apu.AttachSamples(&audio_samples_);
+  arena_.apu.SetOutputEnabled(audio_output_);
+  arena_.cartridge.Attach(rom_.get());
+  arena_.input.SetPadSampler(pad_sampler_, pad_sampler_context_);
+  arena_.cpu.AttachBus(&arena_.bus);
+  arena_.cpu.AttachBreakpoints(&breakpoints_);
+  arena_.cpu.SetExecTrace(exec_trace_);
+  arena_.irq.SetIntLineCallback(
+      [](void* context, bool asserted) { static_cast<sz::cpu::Z80Cpu*>(context)->SetIntLine(asserted); },
+      &arena_.cpu);
+}
+
+std::unique_ptr<SuperZ80Console> SuperZ80Console::Clone() const {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryHost, "console_clone");
+  auto clone = std::make_unique<SuperZ80Console>();
+  // The arena carries this console's internal pointers, so the clone
+  // rewires after the copy. VRAM and work RAM share pages until written.
+  std::memcpy(&clone->arena_, &arena_, sizeof(Arena));
+  clone->work_ram_ = work_ram_;
+  clone->ppu_memory_ = ppu_memory_;
+  clone->rom_ = rom_;
+  clone->audio_samples_ = audio_samples_;
+  clone->breakpoints_ = breakpoints_;
+  clone->watchpoints_ = watchpoints_;
+  clone->video_output_ = video_output_;
+  clone->audio_output_ = audio_output_;
+  clone->profiler_ = profiler_;
+  // Host hooks belong to whoever set them on the original, so the clone's
+  // stay null.
+  clone->Wire();
+  return clone;
+}
+
+size_t SuperZ80Console::GetPrivatePageCount() const {
+  return work_ram_.GetPrivatePageCount() + ppu_memory_.vram.GetPrivatePageCount();
+}
+
 bool SuperZ80Console::PowerOn() {
-  framebuffer_.width = kScreenWidth;
-  framebuffer_.height = kScreenHeight;
-  framebuffer_.pixels.assign(static_cast<size_t>(kScreenWidth * kScreenHeight), 0xFF000000u);
-  SZ_ASSERT(static_cast<int>(framebuffer_.pixels.size()) == kScreenWidth * kScreenHeight);
-  SZ_LOG_INFO("SuperZ80Console PowerOn: framebuffer %dx%d", framebuffer_.width, framebuffer_.height);
+  ClearFramebuffer(arena_.framebuffer);
+  SZ_LOG_INFO("SuperZ80Console PowerOn: framebuffer %dx%d", arena_.framebuffer.width, arena_.framebuffer.height);
+  return true;
+}
+
+bool SuperZ80Console::LoadCartridge(const u8* data, size_t size) {
+  return InsertCartridge(sz::cart::MakeRomImage(data, size));
+}
+
+bool SuperZ80Console::LoadCartridgeFile(const std::string& path) {
+  return InsertCartridge(sz::cart::ReadRomImage(path));
+}
+
+bool SuperZ80Console::InsertCartridge(sz::cart::RomImage rom) {
+  if (!rom) {
+    return false;
+  }
+  rom_ = std::move(rom);
+  arena_.cartridge.Attach(rom_.get());
   return true;
 }
 
+bool SuperZ80Console::HasCartridge() const {
+  return arena_.cartridge.IsLoaded();
+}
+
+const std::vector<u8>& SuperZ80Console::GetCartridgeRom() const {
+  return arena_.cartridge.GetRom();
+}
+
 void SuperZ80Console::Reset() {
-  scheduler_.Reset();
-  bus_.Reset();
-  irq_.Reset();
-  cartridge_.Reset();
-  ppu_.Reset();
-  apu_.Reset();
-  dma_.Reset();
-  input_.Reset();
-  cpu_.Reset();
+  std::memcpy(&arena_, &PowerOnArena(), sizeof(Arena));
+  work_ram_.Fill(0);
+  ppu_memory_.Clear();
+  audio_samples_.clear();
+  Wire();
 }
 
 void SuperZ80Console::StepFrame() {
-  scheduler_.BeginFrame();
-
-  for (int scanline = 0; scanline < kTotalScanlines; ++scanline) {
-    int cpu_budget = scheduler_.ComputeCpuBudgetTstatesForScanline();
-    cpu_.Step(cpu_budget);
-    irq_.Tick();
-    ppu_.RenderScanline(scanline, framebuffer_);
-    if (scanline == kVBlankStartScanline) {
-      // VBlank boundary hook placeholder.
+  SZ_TRACE_SCOPE(sz::trace::kCategoryScheduler, "step_frame");
+  if (!breakpoints_.IsEmpty() || !watchpoints_.IsEmpty() || arena_.stopped_scanline >= 0) {
+    RunFrame<true>();
+  } else {
+    RunFrame<false>();
+  }
+}
+
+template <bool kHooks>
+void SuperZ80Console::RunFrame() {
+  const int resumed = std::exchange(arena_.stopped_scanline, -1);
+  if (resumed < 0) {
+    arena_.scheduler.BeginFrame();
+    profiler_.BeginFrame();
+    arena_.apu.BeginFrame();
+
+    SZ_TRACE(sz::trace::kCategoryScheduler, "frame_begin", arena_.scheduler.GetDebugState().frame, 0);
+    if (exec_trace_) {
+      exec_trace_->MarkFrame(arena_.scheduler.GetDebugState().frame);
+    }
+  }
+  const int first = std::max(resumed, 0);
+
+  {
+    SZ_TRACE_SCOPE(sz::trace::kCategoryScheduler, "active_lines");
+    if (!RunScanlines<kHooks>(first, kVBlankStartScanline, resumed)) {
+      return;
+    }
+  }
+  {
+    SZ_TRACE_SCOPE(sz::trace::kCategoryScheduler, "vblank_lines");
+    if (!RunScanlines<kHooks>(std::max(first, kVBlankStartScanline), kTotalScanlines, resumed)) {
+      return;
     }
-    dma_.Tick();
-    apu_.Tick(cpu_budget);
-    scheduler_.StepScanline();
   }
 
-  scheduler_.EndFrame();
+  arena_.scheduler.EndFrame();
+  profiler_.EndFrame();
+}
+
+template <bool kHooks>
+bool SuperZ80Console::RunScanlines(int first, int end, int resumed_scanline) {
+  for (int scanline = first; scanline < end; ++scanline) {
+    SZ_TRACE_TIMESTAMP(arena_.scheduler.GetDebugState().cpu_tstates_total, arena_.scheduler.GetDebugState().frame,
+                       scanline);
+    profiler_.Mark();
+    if (scanline == kVBlankStartScanline && scanline != resumed_scanline) {
+      // VBlank latches at the start of line 192, so the CPU sees it within
+      // the same scanline's budget.
+      arena_.irq.Raise(sz::irq::kSourceVBlank);
+      SZ_TRACE(sz::trace::kCategoryIrq, "vblank_raise", arena_.irq.ReadStatus(), arena_.irq.ReadEnable());
+      profiler_.Lap(sz::scheduler::kProfileIrq);
+    }
+    int cpu_budget = arena_.scheduler.ComputeCpuBudgetTstatesForScanline();
+    arena_.cpu.Step<kHooks>(cpu_budget);
+    profiler_.Lap(sz::scheduler::kProfileCpu);
+    if constexpr (kHooks) {
+      if (arena_.cpu.IsStopped()) {
+        // The rest of the line (CPU, then PPU, DMA and APU) runs on resume.
+        // Show the lines finished so far while stopped.
+        arena_.stopped_scanline = scanline;
+        arena_.ppu.CatchUp();
+        return false;
+      }
+    }
+    arena_.ppu.EndScanline(scanline);
+    profiler_.Lap(sz::scheduler::kProfilePpu);
+    arena_.dma.Tick(scanline + 1);
+    profiler_.Lap(sz::scheduler::kProfileDma);
+    arena_.apu.Tick(cpu_budget);
+    profiler_.Lap(sz::scheduler::kProfileApu);
+    arena_.scheduler.StepScanline();
+  }
+  return true;
 }
 
 const sz::ppu::Framebuffer& SuperZ80Console::GetFramebuffer() const {
-  return framebuffer_;
+  return arena_.framebuffer;
 }
 
 sz::ppu::Framebuffer& SuperZ80Console::GetFramebufferMutable() {
-  return framebuffer_;
+  return arena_.framebuffer;
+}
+
+u8* SuperZ80Console::GetWorkRam() {
+  return work_ram_.Contiguous();
 }
 
 DebugState SuperZ80Console::GetDebugState() const {
   DebugState state;
-  auto sched = scheduler_.GetDebugState();
+  auto sched = arena_.scheduler.GetDebugState();
   state.scanline = sched.scanline;
   state.frame = sched.frame;
   return state;
 }
 
-void SuperZ80Console::SetHostButtons(const sz::input::HostButtons& buttons) {
-  input_.SetHostButtons(buttons);
+void SuperZ80Console::SetHostButtons(int pad, const sz::input::HostButtons& buttons) {
+  arena_.input.SetHostButtons(pad, buttons);
+}
+
+void SuperZ80Console::SetPadSampler(sz::input::PadSampler sampler, void* context) {
+  pad_sampler_ = sampler;
+  pad_sampler_context_ = context;
+  arena_.input.SetPadSampler(sampler, context);
+}
+
+void SuperZ80Console::SetExecTrace(sz::cpu::ExecTraceWriter* writer) {
+  exec_trace_ = writer;
+  arena_.cpu.SetExecTrace(writer);
+}
+
+size_t SuperZ80Console::GetSaveStateSize() const {
+  sz::state::StateWriter measure(nullptr, 0);
+  SaveSections(measure);
+  return sz::state::kHeaderSize + measure.Position();
+}
+
+bool SuperZ80Console::SaveState(u8* data, size_t size) const {
+  const size_t total = GetSaveStateSize();
+  if (!data || size < total) {
+    return false;
+  }
+  // The format has no notion of a half-run scanline.
+  if (arena_.stopped_scanline >= 0) {
+    SZ_LOG_WARN("SaveState: console is stopped inside a frame");
+    return false;
+  }
+
+  sz::state::StateWriter writer(data, total);
+  writer.WriteU32(sz::state::kMagic);
+  writer.WriteU16(sz::state::kVersion);
+  writer.WriteU16(0);
+  writer.WriteU32(static_cast<u32>(total));
+  SaveSections(writer);
+  SZ_ASSERT(writer.Position() == total);
+  return writer.Ok();
+}
+
+bool SuperZ80Console::SaveState(std::vector<u8>& out) const {
+  out.resize(GetSaveStateSize());
+  return SaveState(out.data(), out.size());
+}
+
+bool SuperZ80Console::LoadState(const u8* data, size_t size) {
+  if (!data || size < sz::state::kHeaderSize) {
+    SZ_LOG_WARN("LoadState: snapshot too small (%zu bytes)", size);
+    return false;
+  }
+
+  sz::state::StateReader reader(data, size);
+  const u32 magic = reader.ReadU32();
+  const u16 version = reader.ReadU16();
+  reader.ReadU16();
+  const u32 total = reader.ReadU32();
+  if (magic != sz::state::kMagic || version != sz::state::kVersion || total != size ||
+      total != GetSaveStateSize()) {
+    SZ_LOG_WARN("LoadState: rejected snapshot (version %u, %u bytes)", version, total);
+    return false;
+  }
+
+  // Keep what decoding overwrites and put it back unless every section
+  // reads back in range, so a corrupt snapshot leaves the console
+  // untouched. The memory copies share pages, and loading unshares only
+  // the pages whose bytes differ.
+  std::vector<u8> devices(kDeviceBytes);
+  std::memcpy(devices.data(), &arena_, kDeviceBytes);
+  const sz::bus::WorkRam work_ram = work_ram_;
+  const sz::ppu::PpuMemory ppu_memory = ppu_memory_;
+  LoadSections(reader);
+  if (!reader.Ok()) {
+    std::memcpy(static_cast<void*>(&arena_), devices.data(), kDeviceBytes);
+    work_ram_ = work_ram;
+    ppu_memory_ = ppu_memory;
+    SZ_LOG_WARN("LoadState: rejected corrupt snapshot; console state unchanged");
+    return false;
+  }
+  arena_.stopped_scanline = -1;
+  return true;
+}
+
+u64 SuperZ80Console::GetFramebufferHash() const {
+  return sz::util::Fnv1a64(arena_.framebuffer.pixels.data(), arena_.framebuffer.pixels.size() * sizeof(u32));
+}
+
+u64 SuperZ80Console::GetAudioHash() const {
+  const auto& samples = arena_.apu.GetSamples();
+  return sz::util::Fnv1a64(samples.data(), samples.size() * sizeof(s16));
+}
+
+const std::vector<s16>& SuperZ80Console::GetAudioSamples() const {
+  return arena_.apu.GetSamples();
+}
+
+u64 SuperZ80Console::GetStateHash() const {
+  std::vector<u8> state;
+  SaveState(state);
+  return sz::util::Fnv1a64(state.data(), state.size());
+}
+
+void SuperZ80Console::SetVideoOutputEnabled(bool enabled) {
+  video_output_ = enabled;
+  arena_.ppu.SetOutputEnabled(enabled);
+}
+
+void SuperZ80Console::SetAudioOutputEnabled(bool enabled) {
+  audio_output_ = enabled;
+  arena_.apu.SetOutputEnabled(enabled);
+}
+
+void SuperZ80Console::SaveSections(sz::state::StateWriter& writer) const {
+  using sz::state::MakeTag;
+  writer.BeginSection(MakeTag('C', 'P', 'U', ' '));
+  arena_.cpu.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('S', 'C', 'H', 'D'));
+  arena_.scheduler.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('B', 'U', 'S', ' '));
+  arena_.bus.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('C', 'A', 'R', 'T'));
+  arena_.cartridge.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('I', 'R', 'Q', ' '));
+  arena_.irq.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('P', 'P', 'U', ' '));
+  arena_.ppu.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('A', 'P', 'U', ' '));
+  arena_.apu.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('D', 'M', 'A', ' '));
+  arena_.dma.SaveState(writer);
+  writer.EndSection();
+  writer.BeginSection(MakeTag('I', 'N', 'P', 'T'));
+  arena_.input.SaveState(writer);
+  writer.EndSection();
+}
+
+void SuperZ80Console::LoadSections(sz::state::StateReader& reader) {
+  using sz::state::MakeTag;
+  reader.BeginSection(MakeTag('C', 'P', 'U', ' '));
+  arena_.cpu.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('S', 'C', 'H', 'D'));
+  arena_.scheduler.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('B', 'U', 'S', ' '));
+  arena_.bus.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('C', 'A', 'R', 'T'));
+  arena_.cartridge.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('I', 'R', 'Q', ' '));
+  arena_.irq.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('P', 'P', 'U', ' '));
+  arena_.ppu.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('A', 'P', 'U', ' '));
+  arena_.apu.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('D', 'M', 'A', ' '));
+  arena_.dma.LoadState(reader);
+  reader.EndSection();
+  reader.BeginSection(MakeTag('I', 'N', 'P', 'T'));
+  arena_.input.LoadState(reader);
+  reader.EndSection();
 }
 
 sz::scheduler::DebugState SuperZ80Console::GetSchedulerDebugState() const {
-  return scheduler_.GetDebugState();
+  sz::scheduler::DebugState state = arena_.scheduler.GetDebugState();
+  state.profile = profiler_.GetDebugState();
+  return state;
 }
 
 sz::bus::DebugState SuperZ80Console::GetBusDebugState() const {
-  return bus_.GetDebugState();
+  return arena_.bus.GetDebugState();
 }
 
 sz::irq::DebugState SuperZ80Console::GetIRQDebugState() const {
-  return irq_.GetDebugState();
+  return arena_.irq.GetDebugState();
 }
 
 sz::ppu::DebugState SuperZ80Console::GetPPUDebugState() const {
-  return ppu_.GetDebugState();
+  return arena_.ppu.GetDebugState();
 }
 
 sz::apu::DebugState SuperZ80Console::GetAPUDebugState() const {
-  return apu_.GetDebugState();
+  return arena_.apu.GetDebugState();
 }
 
 sz::dma::DebugState SuperZ80Console::GetDMADebugState() const {
-  return dma_.GetDebugState();
+  return arena_.dma.GetDebugState();
 }
 
 sz::cart::DebugState SuperZ80Console::GetCartridgeDebugState() const {
-  return cartridge_.GetDebugState();
+  return arena_.cartridge.GetDebugState();
 }
 
 sz::input::DebugState SuperZ80Console::GetInputDebugState() const {
-  return input_.GetDebugState();
+  return arena_.input.GetDebugState();
 }
 
 sz::cpu::DebugState SuperZ80Console::GetCpuDebugState() const {
-  return cpu_.GetDebugState();
+  return arena_.cpu.GetDebugState();
+}
+
+void SuperZ80Console::AddBreakpoint(u16 pc) {
+  breakpoints_.Add(pc);
+}
+
+void SuperZ80Console::RemoveBreakpoint(u16 pc) {
+  breakpoints_.Remove(pc);
+}
+
+bool SuperZ80Console::AddWatchpoint(const sz::bus::Watchpoint& watch) {
+  return watchpoints_.Add(watch);
+}
+
+void SuperZ80Console::RemoveWatchpoint(const sz::bus::Watchpoint& watch) {
+  watchpoints_.Remove(watch);
+}
+
+void SuperZ80Console::ClearBreakpoints() {
+  breakpoints_.Clear();
+  watchpoints_.Clear();
+}
+
+bool SuperZ80Console::IsStopped() const {
+  return arena_.stopped_scanline >= 0;
+}
+
+sz::cpu::StopInfo SuperZ80Console::GetStopInfo() const {
+  return arena_.cpu.GetStopInfo();
+}
+
+void SuperZ80Console::CaptureDebugSnapshot(DebugSnapshot& out) const {
+  out.console = GetDebugState();
+  out.cpu = GetCpuDebugState();
+  out.bus = GetBusDebugState();
+  out.ppu = GetPPUDebugState();
+  out.apu = GetAPUDebugState();
+  out.dma = GetDMADebugState();
+  out.irq = GetIRQDebugState();
+  out.scheduler = GetSchedulerDebugState();
+  out.cartridge = GetCartridgeDebugState();
+  out.input = GetInputDebugState();
+  arena_.ppu.CaptureVideoMemory(out.video);
 }
 
 }  // namespace sz::console
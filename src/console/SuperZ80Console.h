@@ -1,7 +1,16 @@
 #ifndef SUPERZ80_CONSOLE_SUPERZ80CONSOLE_H
 #define SUPERZ80_CONSOLE_SUPERZ80CONSOLE_H
 
-#include "cpu/Z80CpuStub.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "core/state/SaveState.h"
+#include "core/util/NonCopyable.h"
+#include "cpu/ExecTrace.h"
+#include "cpu/Z80Cpu.h"
 #include "devices/apu/APU.h"
 #include "devices/bus/Bus.h"
 #include "devices/cart/Cartridge.h"
@@ -18,16 +27,98 @@ struct DebugState {
   u64 frame = 0;
 };
 
-class SuperZ80Console {
+// Every device's debug state at one instant, for viewers that must not call
+// into a console another thread is running. Video memory is refreshed
+// incrementally, so keep reusing the same snapshot objects.
+struct DebugSnapshot {
+  DebugState console;
+  sz::cpu::DebugState cpu;
+  sz::bus::DebugState bus;
+  sz::ppu::DebugState ppu;
+  sz::apu::DebugState apu;
+  sz::dma::DebugState dma;
+  sz::irq::DebugState irq;
+  sz::scheduler::DebugState scheduler;
+  sz::cart::DebugState cartridge;
+  sz::input::DebugState input;
+  sz::ppu::VideoMemory video;
+};
+
+// Devices hold pointers to each other (CPU -> bus -> IRQ -> CPU) and to the
+// memory outside the arena, so the console is rewired after every copy of
+// its arena and is never copied or moved itself.
+class SuperZ80Console : private sz::util::NonCopyable {
  public:
+  SuperZ80Console();
+
   bool PowerOn();
+  // The image is copied; Reset afterwards to start from its reset vector.
+  bool LoadCartridge(const u8* data, size_t size);
+  bool LoadCartridgeFile(const std::string& path);
+  bool HasCartridge() const;
+  const std::vector<u8>& GetCartridgeRom() const;
+  // Copies the power-on image over the arena and zeroes VRAM and work RAM.
   void Reset();
+  // Runs to the end of the frame, or to the first breakpoint or watchpoint
+  // hit. After a hit the next call resumes the same frame from there.
   void StepFrame();
+
+  // Forks the console at this exact point. The clone is fully independent
+  // and evolves deterministically from the same state: the arena is copied
+  // in one block, VRAM and work RAM are shared copy-on-write per page, and
+  // the ROM image is shared. Pad samplers and exec traces are not
+  // inherited. Not safe while another thread is stepping this console.
+  std::unique_ptr<SuperZ80Console> Clone() const;
+  // VRAM and work RAM pages held by this console alone; the rest are still
+  // shared with clones.
+  size_t GetPrivatePageCount() const;
+
   const sz::ppu::Framebuffer& GetFramebuffer() const;
   sz::ppu::Framebuffer& GetFramebufferMutable();
   DebugState GetDebugState() const;
+  // sz::bus::kWorkRamSize contiguous bytes, for embedders and memory
+  // viewers. Valid until the console is cloned.
+  u8* GetWorkRam();
+
+  // Buttons latched for the coming frame. A pad sampler, when set, replaces
+  // them with a live host read at each PAD port access.
+  void SetHostButtons(int pad, const sz::input::HostButtons& buttons);
+  void SetPadSampler(sz::input::PadSampler sampler, void* context);
 
-  void SetHostButtons(const sz::input::HostButtons& buttons);
+  // Instruction-level CPU trace with a frame marker per StepFrame; null
+  // stops tracing.
+  void SetExecTrace(sz::cpu::ExecTraceWriter* writer);
+
+  // Binary save states (see core/state/SaveState.h for the layout). The
+  // framebuffer is output, not state, and is regenerated by the next frame.
+  // A rejected snapshot (bad header, truncated, or a field out of range)
+  // leaves the console unchanged.
+  size_t GetSaveStateSize() const;
+  bool SaveState(u8* data, size_t size) const;
+  bool SaveState(std::vector<u8>& out) const;
+  bool LoadState(const u8* data, size_t size);
+  u64 GetFramebufferHash() const;
+  // Samples produced by the last StepFrame (mono, APU sample rate).
+  u64 GetAudioHash() const;
+  const std::vector<s16>& GetAudioSamples() const;
+  u64 GetStateHash() const;
+
+  // Output suppression for run-ahead. Emulated state evolves identically
+  // whether output is enabled or not.
+  void SetVideoOutputEnabled(bool enabled);
+  void SetAudioOutputEnabled(bool enabled);
+
+  // Debugger. While anything is armed (or a frame is stopped) StepFrame runs
+  // the instrumented CPU core; otherwise the plain core runs and the checks
+  // cost nothing. Breakpoints survive Reset and LoadState. A console stopped
+  // inside a frame refuses SaveState until the frame is finished.
+  void AddBreakpoint(u16 pc);
+  void RemoveBreakpoint(u16 pc);
+  bool AddWatchpoint(const sz::bus::Watchpoint& watch);
+  void RemoveWatchpoint(const sz::bus::Watchpoint& watch);
+  void ClearBreakpoints();  // watchpoints too
+  bool IsStopped() const;
+  sz::cpu::StopInfo GetStopInfo() const;
 
   sz::scheduler::DebugState GetSchedulerDebugState() const;
   sz::bus::DebugState GetBusDebugState() const;
@@ -38,19 +129,67 @@ class SuperZ80Console {
   sz::cart::DebugState GetCartridgeDebugState() const;
   sz::input::DebugState GetInputDebugState() const;
   sz::cpu::DebugState GetCpuDebugState() const;
+  void CaptureDebugSnapshot(DebugSnapshot& out) const;
 
  private:
-  sz::scheduler::Scheduler scheduler_{};
-  sz::bus::Bus bus_{};
-  sz::irq::IRQController irq_{};
-  sz::cart::Cartridge cartridge_{};
-  sz::ppu::PPU ppu_{};
-  sz::apu::APU apu_{};
-  sz::dma::DMAEngine dma_{};
-  sz::input::InputController input_{};
-  sz::cpu::Z80CpuStub cpu_{};
-
-  sz::ppu::Framebuffer framebuffer_{};
+  template <bool kHooks>
+  void RunFrame();
+  // Lines [first, end) of the current frame; the frame is split into the
+  // active and VBlank batches so timelines show them separately. False when
+  // the CPU stopped at a debug hit, with arena_.stopped_scanline set.
+  template <bool kHooks>
+  bool RunScanlines(int first, int end, int resumed_scanline);
+  // Every device and the framebuffer, in one trivially copyable block at
+  // fixed offsets, so Clone and Reset copy it with one memcpy. Ordered by
+  // how often the inner loop touches it: the CPU, bus, IRQ, scheduler and
+  // cartridge are hit on every instruction and share the first cache
+  // lines; the PPU's registers and line buffers are per scanline; the rest
+  // is per frame or port access, and the framebuffer comes last.
+  struct Arena {
+    alignas(64) sz::cpu::Z80Cpu cpu{};
+    sz::bus::Bus bus{};
+    sz::irq::IRQController irq{};
+    sz::scheduler::Scheduler scheduler{};
+    sz::cart::Cartridge cartridge{};
+    int stopped_scanline = -1;  // line a debug stop interrupted, or -1
+    alignas(64) sz::ppu::PPU ppu{};
+    alignas(64) sz::dma::DMAEngine dma{};
+    sz::apu::APU apu{};
+    sz::input::InputController input{};
+    sz::ppu::Framebuffer framebuffer{};
+  };
+  static_assert(std::is_trivially_copyable_v<Arena>, "Clone and Reset copy the arena with memcpy");
+  // The devices: the arena up to the framebuffer, which is output, not state.
+  static constexpr size_t kDeviceBytes = offsetof(Arena, framebuffer);
+  static_assert(kDeviceBytes + sizeof(sz::ppu::Framebuffer) == sizeof(Arena), "the framebuffer comes last");
+
+  // The devices' own Reset values, built once.
+  static const Arena& PowerOnArena();
+  // Points the devices at each other and at everything outside the arena,
+  // and reapplies the host settings; run after every copy into the arena.
+  void Wire();
+  // Takes the image unless it is null (rejected).
+  bool InsertCartridge(sz::cart::RomImage rom);
+  void SaveSections(sz::state::StateWriter& writer) const;
+  void LoadSections(sz::state::StateReader& reader);
+
+  Arena arena_{};
+
+  // Outside the arena: memory that clones share (VRAM and work RAM page by
+  // page, the ROM image whole), the variable-length audio output, and
+  // what the host set, which survives Reset and LoadState.
+  sz::bus::WorkRam work_ram_{};
+  sz::ppu::PpuMemory ppu_memory_{};
+  sz::cart::RomImage rom_{};
+  std::vector<s16> audio_samples_{};
+  sz::cpu::BreakpointList breakpoints_{};
+  sz::bus::WatchList watchpoints_{};
+  sz::cpu::ExecTraceWriter* exec_trace_ = nullptr;
+  sz::input::PadSampler pad_sampler_ = nullptr;
+  void* pad_sampler_context_ = nullptr;
+  bool video_output_ = true;
+  bool audio_output_ = true;
+  sz::scheduler::FrameProfiler profiler_{};
 };
 
 }  // namespace sz::console
@@ -0,0 +1,109 @@
+#include "core/log/ChromeTrace.h"
+
+#include "core/log/Logger.h"
+
+namespace sz::trace {
+
+namespace {
+constexpr size_t kFileBufferSize = 1 << 20;
+constexpr int kProcessId = 1;
+
+// Tag and thread names come from string literals in the source, but quote
+// and backslash would still break the JSON.
+void WriteJsonString(std::FILE* file, const std::string& text) {
+  std::fputc('"', file);
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', file);
+    }
+    std::fputc(static_cast<unsigned char>(c) < 0x20 ? ' ' : c, file);
+  }
+  std::fputc('"', file);
+}
+}  // namespace
+
+ChromeTraceSink::~ChromeTraceSink() {
+  if (file_) {
+    std::fclose(file_);
+  }
+}
+
+bool ChromeTraceSink::Open(const std::string& path) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    SZ_LOG_ERROR("Trace: cannot open %s for writing", path.c_str());
+    return false;
+  }
+  std::setvbuf(file_, nullptr, _IOFBF, kFileBufferSize);
+  std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file_);
+  BeginEvent();
+  std::fprintf(file_, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"args\":{\"name\":\"Super_Z80\"}}",
+               kProcessId);
+  return true;
+}
+
+void ChromeTraceSink::OnNames(const std::vector<std::string>& tag_names,
+                              const std::vector<std::string>& thread_names) {
+  tag_names_ = tag_names;
+  if (!file_) {
+    return;
+  }
+  for (size_t i = 0; i < thread_names.size(); ++i) {
+    if (i < thread_names_.size() && thread_names_[i] == thread_names[i]) {
+      continue;
+    }
+    BeginEvent();
+    std::fprintf(file_, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%zu,\"args\":{\"name\":", kProcessId,
+                 i);
+    WriteJsonString(file_, thread_names[i]);
+    std::fputs("}}", file_);
+  }
+  thread_names_ = thread_names;
+}
+
+void ChromeTraceSink::OnRecords(const TraceRecord* records, size_t count) {
+  if (!file_) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const TraceRecord& record = records[i];
+    BeginEvent();
+    std::fputs("{\"name\":", file_);
+    WriteJsonString(file_, record.tag < tag_names_.size() ? tag_names_[record.tag] : std::string("?"));
+    // Timestamps are microseconds; keep nanosecond resolution.
+    std::fprintf(file_, ",\"pid\":%d,\"tid\":%u,\"ts\":%llu.%03llu", kProcessId, record.thread,
+                 static_cast<unsigned long long>(record.host_ns / 1000),
+                 static_cast<unsigned long long>(record.host_ns % 1000));
+    if (record.phase == kPhaseSpan) {
+      std::fprintf(file_, ",\"ph\":\"X\",\"dur\":%u.%03u", record.duration_ns / 1000, record.duration_ns % 1000);
+    } else {
+      std::fputs(",\"ph\":\"i\",\"s\":\"t\"", file_);
+    }
+    std::fprintf(file_, ",\"args\":{\"frame\":%u,\"line\":%u,\"cycle\":%llu", record.frame, record.scanline,
+                 static_cast<unsigned long long>(record.cycle));
+    if (record.phase != kPhaseSpan) {
+      std::fprintf(file_, ",\"a\":%u,\"b\":%u", record.a, record.b);
+    }
+    std::fputs("}}", file_);
+  }
+  event_count_ += count;
+}
+
+void ChromeTraceSink::OnEnd(const std::vector<std::string>& /*tag_names*/) {
+  if (!file_) {
+    return;
+  }
+  std::fputs("\n]}\n", file_);
+  std::fclose(file_);
+  file_ = nullptr;
+  SZ_LOG_INFO("Trace: wrote %llu events", static_cast<unsigned long long>(event_count_));
+}
+
+void ChromeTraceSink::BeginEvent() {
+  if (!first_event_) {
+    std::fputs(",\n", file_);
+  }
+  first_event_ = false;
+}
+
+}  // namespace sz::trace
@@ -0,0 +1,38 @@
+#ifndef SUPERZ80_CORE_LOG_CHROMETRACE_H
+#define SUPERZ80_CORE_LOG_CHROMETRACE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/log/Trace.h"
+
+namespace sz::trace {
+
+// Streams records as Chrome trace-event JSON (loads in Perfetto and
+// chrome://tracing). Spans become complete ("X") events and everything else
+// thread-scoped instants, on the host clock; the emulated cycle, frame and
+// scanline travel as args. Memory stays bounded: events are formatted into
+// the stdio buffer as they are drained.
+class ChromeTraceSink : public ITraceSink {
+ public:
+  ~ChromeTraceSink() override;
+
+  bool Open(const std::string& path);
+  void OnNames(const std::vector<std::string>& tag_names, const std::vector<std::string>& thread_names) override;
+  void OnRecords(const TraceRecord* records, size_t count) override;
+  void OnEnd(const std::vector<std::string>& tag_names) override;
+
+ private:
+  void BeginEvent();
+
+  std::FILE* file_ = nullptr;
+  std::vector<std::string> tag_names_;
+  std::vector<std::string> thread_names_;
+  bool first_event_ = true;
+  u64 event_count_ = 0;
+};
+
+}  // namespace sz::trace
+
+#endif
@@ -1,14 +1,49 @@
 #include "core/log/Logger.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <thread>
+
+#include "core/util/MpscQueue.h"
 
 namespace sz::log {
 
 namespace {
-std::mutex g_log_mutex;
-Level g_level = Level::Info;
+constexpr size_t kMaxQueuedArgs = 12;
+constexpr size_t kQueuedTextSize = 256;
+constexpr size_t kQueueCapacity = 2048;
+constexpr size_t kMessageSize = 2048;
+
+// Queued message. String arguments are copied into `text`; a null `fmt`
+// means `text` already holds the formatted message.
+struct LogRecord {
+  Level level = Level::Info;
+  const char* fmt = nullptr;
+  size_t arg_count = 0;
+  std::array<LogArg, kMaxQueuedArgs> args{};
+  std::array<char, kQueuedTextSize> text{};
+};
+
+std::mutex g_output_mutex;
+std::atomic<int> g_level{static_cast<int>(Level::Info)};
+
+std::unique_ptr<sz::util::MpscQueue<LogRecord>> g_queue;
+std::thread g_writer;
+std::atomic<bool> g_async{false};
+std::atomic<bool> g_running{false};
+// Threads between seeing g_async set and counting their push; StopAsync
+// waits for none before the final flush.
+std::atomic<int> g_pushing{0};
+std::atomic<unsigned long long> g_enqueued{0};
+std::atomic<unsigned long long> g_written{0};
+std::atomic<unsigned long long> g_dropped{0};
+
+thread_local ScopedLogCapture* t_capture = nullptr;
 
 const char* LevelToString(Level level) {
   switch (level) {
@@ -27,26 +62,221 @@ const char* LevelToString(Level level) {
   }
 }
 
-bool ShouldLog(Level level) {
-  return static_cast<int>(level) <= static_cast<int>(g_level);
+long long AsSigned(const LogArg& arg) {
+  switch (arg.type) {
+    case LogArg::Type::UInt:
+      return static_cast<long long>(arg.u);
+    case LogArg::Type::Double:
+      return static_cast<long long>(arg.d);
+    default:
+      return arg.i;
+  }
+}
+
+unsigned long long AsUnsigned(const LogArg& arg) {
+  switch (arg.type) {
+    case LogArg::Type::Int:
+      return static_cast<unsigned long long>(arg.i);
+    case LogArg::Type::Double:
+      return static_cast<unsigned long long>(arg.d);
+    default:
+      return arg.u;
+  }
+}
+
+double AsDouble(const LogArg& arg) {
+  switch (arg.type) {
+    case LogArg::Type::Int:
+      return static_cast<double>(arg.i);
+    case LogArg::Type::UInt:
+      return static_cast<double>(arg.u);
+    default:
+      return arg.d;
+  }
+}
+
+// printf over captured arguments. Each conversion is re-issued to snprintf
+// with a length modifier matching the captured type, so "%d" with a size_t
+// or "%llu" with an int both print correctly. '*' widths are not supported.
+void FormatMessage(const char* fmt, const LogArg* args, size_t count, char* out, size_t out_size) {
+  size_t pos = 0;
+  size_t next = 0;
+  auto append = [&](const char* text, size_t length) {
+    const size_t room = out_size - 1 - pos;
+    const size_t n = length < room ? length : room;
+    std::memcpy(out + pos, text, n);
+    pos += n;
+  };
+
+  while (*fmt && pos + 1 < out_size) {
+    if (*fmt != '%') {
+      out[pos++] = *fmt++;
+      continue;
+    }
+    if (fmt[1] == '%') {
+      out[pos++] = '%';
+      fmt += 2;
+      continue;
+    }
+
+    char spec[32] = {'%'};
+    size_t spec_len = 1;
+    ++fmt;
+    while (*fmt && std::strchr("-+ #0123456789.", *fmt) && spec_len < 24) {
+      spec[spec_len++] = *fmt++;
+    }
+    while (*fmt && std::strchr("hljztL", *fmt)) {
+      ++fmt;
+    }
+    const char conversion = *fmt;
+    if (!conversion) {
+      break;
+    }
+    ++fmt;
+    if (next >= count) {
+      append("(missing)", 9);
+      continue;
+    }
+
+    // Straight into the output, so only the output's size limits a piece.
+    const LogArg& arg = args[next++];
+    char* piece = out + pos;
+    const size_t room = out_size - pos;
+    int written = 0;
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        spec[spec_len++] = 'l';
+        spec[spec_len++] = 'l';
+        spec[spec_len++] = 'd';
+        written = std::snprintf(piece, room, spec, AsSigned(arg));
+        break;
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+        spec[spec_len++] = 'l';
+        spec[spec_len++] = 'l';
+        spec[spec_len++] = conversion;
+        written = std::snprintf(piece, room, spec, AsUnsigned(arg));
+        break;
+      case 'c':
+        spec[spec_len++] = 'c';
+        written = std::snprintf(piece, room, spec, static_cast<int>(AsSigned(arg)));
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        spec[spec_len++] = conversion;
+        written = std::snprintf(piece, room, spec, AsDouble(arg));
+        break;
+      case 's':
+        spec[spec_len++] = 's';
+        written = std::snprintf(piece, room, spec,
+                                arg.type != LogArg::Type::String ? "(?)" : (arg.s ? arg.s : "(null)"));
+        break;
+      case 'p':
+        spec[spec_len++] = 'p';
+        written = std::snprintf(piece, room, spec, arg.p);
+        break;
+      default:
+        written = std::snprintf(piece, room, "(?)");
+        break;
+    }
+    if (written > 0) {
+      pos += static_cast<size_t>(written) < room ? static_cast<size_t>(written) : room - 1;
+    }
+  }
+  out[pos] = '\0';
+}
+
+void Print(Level level, const char* message) {
+  std::lock_guard<std::mutex> lock(g_output_mutex);
+  std::fprintf(level == Level::Error ? stderr : stdout, "[%s] %s\n", LevelToString(level), message);
+}
+
+void FillRecord(LogRecord& record, Level level, const char* fmt, const LogArg* args, size_t count) {
+  record.level = level;
+  if (count > kMaxQueuedArgs) {
+    record.fmt = nullptr;
+    record.arg_count = 0;
+    FormatMessage(fmt, args, count, record.text.data(), record.text.size());
+    return;
+  }
+
+  record.fmt = fmt;
+  record.arg_count = count;
+  size_t used = 0;
+  for (size_t i = 0; i < count; ++i) {
+    record.args[i] = args[i];
+    if (args[i].type != LogArg::Type::String || !args[i].s) {
+      continue;
+    }
+    // Long strings are truncated to the space left in the record.
+    char* dest = record.text.data() + used;
+    const size_t room = record.text.size() - used;
+    if (room > 0) {
+      size_t length = 0;
+      while (length + 1 < room && args[i].s[length] != '\0') {
+        ++length;
+      }
+      std::memcpy(dest, args[i].s, length);
+      dest[length] = '\0';
+      used += length + 1;
+    }
+    record.args[i].s = room > 0 ? dest : "";
+  }
+}
+
+void WriterLoop() {
+  char message[kMessageSize];
+  unsigned long long reported_drops = 0;
+  for (;;) {
+    LogRecord* record = g_queue->Front();
+    if (!record) {
+      if (!g_running.load(std::memory_order_acquire)) {
+        break;
+      }
+      const unsigned long long drops = g_dropped.load(std::memory_order_relaxed);
+      if (drops != reported_drops) {
+        std::snprintf(message, sizeof(message), "%llu log messages dropped (queue full)", drops - reported_drops);
+        Print(Level::Warn, message);
+        reported_drops = drops;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    if (record->fmt) {
+      FormatMessage(record->fmt, record->args.data(), record->arg_count, message, sizeof(message));
+      Print(record->level, message);
+    } else {
+      Print(record->level, record->text.data());
+    }
+    g_queue->Pop();
+    g_written.fetch_add(1, std::memory_order_release);
+  }
 }
 }  // namespace
 
 void Logger::SetLevel(Level level) {
-  std::lock_guard<std::mutex> lock(g_log_mutex);
-  g_level = level;
+  g_level.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 Level Logger::GetLevel() {
-  std::lock_guard<std::mutex> lock(g_log_mutex);
-  return g_level;
+  return static_cast<Level>(g_level.load(std::memory_order_relaxed));
 }
 
-void Logger::Log(Level level, const char* fmt, ...) {
-  std::va_list args;
-  va_start(args, fmt);
-  LogV(level, fmt, args);
-  va_end(args);
+bool Logger::ShouldLog(Level level) {
+  if (t_capture) {
+    return static_cast<int>(level) <= static_cast<int>(t_capture->level_);
+  }
+  return static_cast<int>(level) <= g_level.load(std::memory_order_relaxed);
 }
 
 void Logger::LogV(Level level, const char* fmt, std::va_list args) {
@@ -54,10 +284,92 @@ void Logger::LogV(Level level, const char* fmt, std::va_list args) {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(g_log_mutex);
-  std::array<char, 2048> buffer{};
+  std::array<char, kMessageSize> buffer{};
   std::vsnprintf(buffer.data(), buffer.size(), fmt, args);
-  std::fprintf(level == Level::Error ? stderr : stdout, "[%s] %s\n", LevelToString(level), buffer.data());
+  LogArg arg;
+  arg.type = LogArg::Type::String;
+  arg.s = buffer.data();
+  Write(level, "%s", &arg, 1);
+}
+
+void Logger::StartAsync() {
+  if (g_running.load(std::memory_order_acquire)) {
+    return;
+  }
+  if (!g_queue) {
+    // Created once and kept across restarts.
+    g_queue = std::make_unique<sz::util::MpscQueue<LogRecord>>(kQueueCapacity);
+  }
+  g_running.store(true, std::memory_order_release);
+  g_writer = std::thread(WriterLoop);
+  g_async.store(true, std::memory_order_release);
+}
+
+void Logger::StopAsync() {
+  if (!g_running.load(std::memory_order_acquire)) {
+    return;
+  }
+  // Sequentially consistent with Write: a thread either sees g_async clear
+  // or is counted in g_pushing here, so every queued record gets written.
+  g_async.store(false, std::memory_order_seq_cst);
+  while (g_pushing.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+  Flush();
+  g_running.store(false, std::memory_order_release);
+  g_writer.join();
+}
+
+void Logger::Flush() {
+  if (!g_running.load(std::memory_order_acquire)) {
+    return;
+  }
+  const unsigned long long target = g_enqueued.load(std::memory_order_acquire);
+  while (g_written.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+}
+
+void Logger::Write(Level level, const char* fmt, const LogArg* args, size_t count) {
+  if (t_capture) {
+    char message[kMessageSize];
+    FormatMessage(fmt, args, count, message, sizeof(message));
+    t_capture->lines_.push_back(std::string("[") + LevelToString(level) + "] " + message);
+    if (level != Level::Error) {
+      return;
+    }
+  }
+  if (level != Level::Error && g_async.load(std::memory_order_acquire)) {
+    g_pushing.fetch_add(1, std::memory_order_seq_cst);
+    if (g_async.load(std::memory_order_seq_cst)) {
+      const bool queued = g_queue->TryPush(
+          [&](LogRecord& record) { FillRecord(record, level, fmt, args, count); });
+      if (queued) {
+        g_enqueued.fetch_add(1, std::memory_order_release);
+      } else {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      g_pushing.fetch_sub(1, std::memory_order_release);
+      return;
+    }
+    // StopAsync got in first; print directly like a synchronous logger.
+    g_pushing.fetch_sub(1, std::memory_order_release);
+  }
+
+  // Errors keep ordering with anything already queued, then go out directly.
+  Flush();
+  char message[kMessageSize];
+  FormatMessage(fmt, args, count, message, sizeof(message));
+  Print(level, message);
+}
+
+ScopedLogCapture::ScopedLogCapture(std::vector<std::string>& lines, Level level)
+    : lines_(lines), level_(level), previous_(t_capture) {
+  t_capture = this;
+}
+
+ScopedLogCapture::~ScopedLogCapture() {
+  t_capture = previous_;
 }
 
 }  // namespace sz::log
@@ -2,7 +2,16 @@
 #define SUPERZ80_CORE_LOG_LOGGER_H
 
 #include <cstdarg>
+#include <cstddef>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+// Least severe level compiled in: 0 error, 1 warn, 2 info, 3 debug, 4 trace.
+// CMake defaults this to 2 for release configurations and 4 otherwise.
+#ifndef SUPERZ80_LOG_MIN_LEVEL
+#define SUPERZ80_LOG_MIN_LEVEL 4
+#endif
 
 namespace sz::log {
 
@@ -14,20 +23,112 @@ enum class Level {
   Trace
 };
 
+// One printf argument, captured by value. Strings are captured by pointer
+// here and copied by the logger before Log() returns.
+struct LogArg {
+  enum class Type : unsigned char { Int, UInt, Double, Pointer, String };
+
+  Type type = Type::Int;
+  union {
+    long long i = 0;
+    unsigned long long u;
+    double d;
+    const void* p;
+    const char* s;
+  };
+};
+
+template <typename T>
+LogArg MakeLogArg(T value) {
+  LogArg arg;
+  if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+    arg.type = LogArg::Type::String;
+    arg.s = value;
+  } else if constexpr (std::is_pointer_v<T>) {
+    arg.type = LogArg::Type::Pointer;
+    arg.p = value;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    arg.type = LogArg::Type::Double;
+    arg.d = static_cast<double>(value);
+  } else if constexpr (std::is_enum_v<T>) {
+    arg.type = LogArg::Type::Int;
+    arg.i = static_cast<long long>(value);
+  } else if constexpr (std::is_signed_v<T>) {
+    arg.type = LogArg::Type::Int;
+    arg.i = value;
+  } else {
+    arg.type = LogArg::Type::UInt;
+    arg.u = value;
+  }
+  return arg;
+}
+
+class ScopedLogCapture;
+
+// printf-style logging. Formats must be string literals: in async mode the
+// format pointer is kept until the background thread writes the message.
 class Logger {
  public:
   static void SetLevel(Level level);
   static Level GetLevel();
-  static void Log(Level level, const char* fmt, ...);
+  static bool ShouldLog(Level level);
+
+  template <typename... Args>
+  static void Log(Level level, const char* fmt, Args... args) {
+    if (!ShouldLog(level)) {
+      return;
+    }
+    const LogArg packed[] = {MakeLogArg(args)..., LogArg{}};
+    Write(level, fmt, packed, sizeof...(Args));
+  }
   static void LogV(Level level, const char* fmt, std::va_list args);
+
+  // Async mode: callers only copy their arguments into a lock-free queue;
+  // a background thread formats and writes. Errors flush the queue and are
+  // written synchronously so nothing is lost before an abort.
+  static void StartAsync();
+  static void StopAsync();
+  static void Flush();
+
+ private:
+  static void Write(Level level, const char* fmt, const LogArg* args, size_t count);
+};
+
+// While alive, the calling thread's messages go to `lines` ("[LEVEL] text"
+// per entry) under a level of their own, without touching the shared
+// output lock or async queue. Batch runs give each session one, so
+// concurrent sessions share no logging state. Errors are printed as well,
+// because an assert aborts before anyone reads the capture. Captures nest.
+class ScopedLogCapture {
+ public:
+  explicit ScopedLogCapture(std::vector<std::string>& lines, Level level = Level::Warn);
+  ~ScopedLogCapture();
+  ScopedLogCapture(const ScopedLogCapture&) = delete;
+  ScopedLogCapture& operator=(const ScopedLogCapture&) = delete;
+
+ private:
+  friend class Logger;
+
+  std::vector<std::string>& lines_;
+  Level level_;
+  ScopedLogCapture* previous_ = nullptr;
 };
 
 }  // namespace sz::log
 
-#define SZ_LOG_ERROR(fmt, ...) ::sz::log::Logger::Log(::sz::log::Level::Error, fmt, ##__VA_ARGS__)
-#define SZ_LOG_WARN(fmt, ...) ::sz::log::Logger::Log(::sz::log::Level::Warn, fmt, ##__VA_ARGS__)
-#define SZ_LOG_INFO(fmt, ...) ::sz::log::Logger::Log(::sz::log::Level::Info, fmt, ##__VA_ARGS__)
-#define SZ_LOG_DEBUG(fmt, ...) ::sz::log::Logger::Log(::sz::log::Level::Debug, fmt, ##__VA_ARGS__)
-#define SZ_LOG_TRACE(fmt, ...) ::sz::log::Logger::Log(::sz::log::Level::Trace, fmt, ##__VA_ARGS__)
+// Calls below SUPERZ80_LOG_MIN_LEVEL sit in a discarded branch: arguments
+// still count as used, but no code is generated.
+#define SZ_LOG_AT(min_level, level, fmt, ...)                              \
+  do {                                                                     \
+    if constexpr (SUPERZ80_LOG_MIN_LEVEL >= (min_level)) {                 \
+      ::sz::log::Logger::Log(::sz::log::Level::level, fmt, ##__VA_ARGS__); \
+    }                                                                      \
+  } while (0)
+
+#define SZ_LOG_ERROR(fmt, ...) SZ_LOG_AT(0, Error, fmt, ##__VA_ARGS__)
+#define SZ_LOG_WARN(fmt, ...) SZ_LOG_AT(1, Warn, fmt, ##__VA_ARGS__)
+#define SZ_LOG_INFO(fmt, ...) SZ_LOG_AT(2, Info, fmt, ##__VA_ARGS__)
+#define SZ_LOG_DEBUG(fmt, ...) SZ_LOG_AT(3, Debug, fmt, ##__VA_ARGS__)
+#define SZ_LOG_TRACE(fmt, ...) SZ_LOG_AT(4, Trace, fmt, ##__VA_ARGS__)
 
 #endif
@@ -1,23 +1,305 @@
 #include "core/log/Trace.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "core/util/SpscRing.h"
+
 namespace sz::trace {
 
 namespace {
+constexpr size_t kRingCapacity = 1 << 16;
+constexpr size_t kDrainBatch = 4096;
+// TraceRecord::thread is a u8. Threads beyond this many at once drop
+// their records.
+constexpr size_t kMaxThreads = 256;
+
+using Ring = sz::util::SpscRing<TraceRecord>;
+
+// One per thread that has emitted. When the thread exits, the drain frees
+// the ring once it is empty and the index goes to the next new thread.
+struct Slot {
+  std::shared_ptr<Ring> ring;  // null: free
+  std::string name;
+  bool exited = false;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<Slot> slots;  // indexed by TraceRecord::thread
+  std::vector<std::string> tag_names;
+  bool names_dirty = false;
+};
+
+// A ring and the records it held when the drain looked at it.
+struct Claim {
+  std::shared_ptr<Ring> ring;
+  size_t count = 0;
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
 NullTraceSink g_null_sink;
 ITraceSink* g_sink = &g_null_sink;
+std::atomic<bool> g_active{false};
+std::atomic<bool> g_draining{false};
+std::atomic<u64> g_dropped{0};
+std::atomic<s64> g_start_ns{0};
+std::thread g_drain_thread;
+
+s64 SteadyNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+thread_local TraceRecord t_stamp{};
+
+// The thread's ring. Rings outlive their threads so late records still
+// reach the drain; the destructor only marks the slot for reclaiming.
+struct LocalSlot {
+  std::shared_ptr<Ring> ring;
+  bool unavailable = false;  // every slot was taken; this thread drops
+
+  ~LocalSlot() {
+    if (ring) {
+      Registry& registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.slots[t_stamp.thread].exited = true;
+    }
+  }
+};
+thread_local LocalSlot t_slot;
+
+Ring* LocalRing() {
+  if (t_slot.ring || t_slot.unavailable) {
+    return t_slot.ring.get();
+  }
+  auto ring = std::make_shared<Ring>(kRingCapacity);
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto free_slot = std::find_if(registry.slots.begin(), registry.slots.end(),
+                                [](const Slot& slot) { return slot.ring == nullptr; });
+  if (free_slot == registry.slots.end()) {
+    if (registry.slots.size() == kMaxThreads) {
+      t_slot.unavailable = true;
+      return nullptr;
+    }
+    free_slot = registry.slots.emplace(registry.slots.end());
+  }
+  t_stamp.thread = static_cast<u8>(free_slot - registry.slots.begin());
+  free_slot->ring = ring;
+  free_slot->name = "thread " + std::to_string(t_stamp.thread);
+  free_slot->exited = false;
+  registry.names_dirty = true;
+  t_slot.ring = std::move(ring);
+  return t_slot.ring.get();
+}
+
+// The sink's file I/O runs outside the registry lock, so threads that
+// register or intern a tag never wait on the disk. Only records already
+// queued when the lock was held are popped: their tags and threads are in
+// the names announced just before.
+size_t DrainOnce(std::array<TraceRecord, kDrainBatch>& batch, std::vector<Claim>& claims) {
+  Registry& registry = GetRegistry();
+  std::vector<std::string> tag_names;
+  std::vector<std::string> thread_names;
+  bool announce = false;
+  claims.clear();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.names_dirty) {
+      tag_names = registry.tag_names;
+      for (const Slot& slot : registry.slots) {
+        thread_names.push_back(slot.name);
+      }
+      registry.names_dirty = false;
+      announce = true;
+    }
+    for (Slot& slot : registry.slots) {
+      if (!slot.ring) {
+        continue;
+      }
+      const size_t count = slot.ring->Available();
+      if (count == 0 && slot.exited) {
+        slot.ring.reset();  // drained and nobody left to push
+        slot.exited = false;
+      } else if (count != 0) {
+        claims.push_back({slot.ring, count});
+      }
+    }
+  }
+
+  if (announce) {
+    g_sink->OnNames(tag_names, thread_names);
+  }
+  size_t total = 0;
+  for (Claim& claim : claims) {
+    while (claim.count != 0) {
+      const size_t count = claim.ring->PopBatch(batch.data(), std::min(claim.count, batch.size()));
+      g_sink->OnRecords(batch.data(), count);
+      claim.count -= count;
+      total += count;
+    }
+  }
+  claims.clear();
+  return total;
+}
+
+void DrainLoop() {
+  auto batch = std::make_unique<std::array<TraceRecord, kDrainBatch>>();
+  std::vector<Claim> claims;
+  while (g_draining.load(std::memory_order_acquire)) {
+    if (DrainOnce(*batch, claims) == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  // Twice: the first pass can still find records queued while it ran.
+  DrainOnce(*batch, claims);
+  DrainOnce(*batch, claims);
+}
 }  // namespace
 
-void NullTraceSink::OnEvent(const TraceEvent& /*event*/) {
+void NullTraceSink::OnRecords(const TraceRecord* /*records*/, size_t /*count*/) {
+  // no-op
+}
+
+void NullTraceSink::OnEnd(const std::vector<std::string>& /*tag_names*/) {
   // no-op
 }
 
-void Trace::SetSink(ITraceSink* sink) {
+void Trace::Start(ITraceSink* sink) {
+  Stop();
+
+  // Discard anything left from a previous session before the drain owns
+  // the consumer side again.
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    TraceRecord discard;
+    for (Slot& slot : registry.slots) {
+      if (!slot.ring) {
+        continue;
+      }
+      while (slot.ring->TryPop(discard)) {
+      }
+      if (slot.exited) {
+        slot.ring.reset();
+        slot.exited = false;
+      }
+    }
+  }
+
   g_sink = sink ? sink : &g_null_sink;
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.names_dirty = true;
+  }
+  g_dropped.store(0, std::memory_order_relaxed);
+  g_start_ns.store(SteadyNanoseconds(), std::memory_order_relaxed);
+  g_draining.store(true, std::memory_order_release);
+  g_drain_thread = std::thread(DrainLoop);
+  g_active.store(true, std::memory_order_release);
+}
+
+void Trace::Stop() {
+  if (!g_drain_thread.joinable()) {
+    return;
+  }
+  g_active.store(false, std::memory_order_release);
+  g_draining.store(false, std::memory_order_release);
+  g_drain_thread.join();
+
+  std::vector<std::string> tag_names;
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    tag_names = registry.tag_names;
+  }
+  g_sink->OnEnd(tag_names);
+  g_sink = &g_null_sink;
+}
+
+bool Trace::IsActive() {
+  return g_active.load(std::memory_order_relaxed);
+}
+
+u64 Trace::GetDroppedCount() {
+  return g_dropped.load(std::memory_order_relaxed);
+}
+
+void Trace::SetTimestamp(u64 cycle, u64 frame, int scanline) {
+  t_stamp.cycle = cycle;
+  t_stamp.frame = static_cast<u32>(frame);
+  t_stamp.scanline = static_cast<u16>(scanline);
+}
+
+void Trace::SetThreadName(const char* name) {
+  if constexpr (kCompiledMask == 0) {
+    return;  // no ring for a thread that can never emit
+  }
+  if (!LocalRing()) {
+    return;
+  }
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.slots[t_stamp.thread].name = name;
+  registry.names_dirty = true;
+}
+
+u16 Trace::InternTag(const char* name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (size_t i = 0; i < registry.tag_names.size(); ++i) {
+    if (registry.tag_names[i] == name) {
+      return static_cast<u16>(i);
+    }
+  }
+  registry.tag_names.emplace_back(name);
+  registry.names_dirty = true;
+  return static_cast<u16>(registry.tag_names.size() - 1);
 }
 
-void Trace::Emit(const TraceEvent& event) {
-  if (g_sink) {
-    g_sink->OnEvent(event);
+u64 Trace::HostNanoseconds() {
+  return static_cast<u64>(SteadyNanoseconds() - g_start_ns.load(std::memory_order_relaxed));
+}
+
+void Trace::Emit(u16 tag, u32 a, u32 b) {
+  if (!g_active.load(std::memory_order_relaxed)) {
+    return;
+  }
+  Ring* ring = LocalRing();
+  TraceRecord record = t_stamp;
+  record.host_ns = HostNanoseconds();
+  record.tag = tag;
+  record.a = a;
+  record.b = b;
+  if (!ring || !ring->TryPush(record)) {
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Trace::EmitSpan(u16 tag, u64 start_ns) {
+  if (!g_active.load(std::memory_order_relaxed)) {
+    return;
+  }
+  Ring* ring = LocalRing();
+  const u64 end_ns = HostNanoseconds();
+  TraceRecord record = t_stamp;
+  record.host_ns = start_ns;
+  record.duration_ns = static_cast<u32>(std::min<u64>(end_ns - start_ns, 0xFFFFFFFFu));
+  record.phase = kPhaseSpan;
+  record.tag = tag;
+  if (!ring || !ring->TryPush(record)) {
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
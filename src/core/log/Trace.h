@@ -1,35 +1,150 @@
 #ifndef SUPERZ80_CORE_LOG_TRACE_H
 #define SUPERZ80_CORE_LOG_TRACE_H
 
+#include <cstddef>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "core/types.h"
 
+// Categories compiled into the build. A trace point whose category is not in
+// the mask generates no code. Set through the SUPERZ80_TRACE_MASK cache
+// variable; 0 (the default) removes tracing entirely.
+#ifndef SUPERZ80_TRACE_MASK
+#define SUPERZ80_TRACE_MASK 0u
+#endif
+
 namespace sz::trace {
 
-struct TraceEvent {
-  u64 frame = 0;
-  int scanline = 0;
-  std::string tag;
+constexpr u32 kCategoryCpu = 0x01;
+constexpr u32 kCategoryIrq = 0x02;
+constexpr u32 kCategoryPpu = 0x04;
+constexpr u32 kCategoryDma = 0x08;
+constexpr u32 kCategoryApu = 0x10;
+constexpr u32 kCategoryBus = 0x20;
+constexpr u32 kCategoryScheduler = 0x40;
+constexpr u32 kCategoryHost = 0x80;
+constexpr u32 kCategoryCart = 0x100;
+
+constexpr u32 kCompiledMask = static_cast<u32>(SUPERZ80_TRACE_MASK);
+
+constexpr u8 kPhaseInstant = 0;
+constexpr u8 kPhaseSpan = 1;  // host_ns is the start, duration_ns the length
+
+// Fixed-size record; what a trace file stores verbatim.
+struct TraceRecord {
+  u64 cycle = 0;    // CPU T-states since power-on
+  u64 host_ns = 0;  // host steady clock since Trace::Start
+  u32 frame = 0;
+  u16 scanline = 0;
+  u16 tag = 0;  // interned, see Trace::InternTag
+  u32 a = 0;
+  u32 b = 0;
+  u32 duration_ns = 0;
+  u8 phase = kPhaseInstant;
+  u8 thread = 0;  // emitting thread, see Trace::SetThreadName
+  u16 reserved = 0;
 };
+static_assert(std::is_trivially_copyable_v<TraceRecord>);
+static_assert(sizeof(TraceRecord) == 40);
 
+// Receives drained records on the trace thread, never on the emitting one.
 class ITraceSink {
  public:
   virtual ~ITraceSink() = default;
-  virtual void OnEvent(const TraceEvent& event) = 0;
+  // Called before any record that uses a tag or thread index the sink has
+  // not been told about yet. Streaming sinks use it to resolve names early.
+  virtual void OnNames(const std::vector<std::string>& /*tag_names*/,
+                       const std::vector<std::string>& /*thread_names*/) {}
+  virtual void OnRecords(const TraceRecord* records, size_t count) = 0;
+  virtual void OnEnd(const std::vector<std::string>& tag_names) = 0;
 };
 
 class NullTraceSink : public ITraceSink {
  public:
-  void OnEvent(const TraceEvent& event) override;
+  void OnRecords(const TraceRecord* records, size_t count) override;
+  void OnEnd(const std::vector<std::string>& tag_names) override;
 };
 
+// Records go into a lock-free ring owned by the emitting thread; a
+// background thread drains every ring into the sink. A full ring drops the
+// record and counts it instead of blocking emulation.
 class Trace {
  public:
-  static void SetSink(ITraceSink* sink);
-  static void Emit(const TraceEvent& event);
+  static void Start(ITraceSink* sink);
+  static void Stop();
+  static bool IsActive();
+  static u64 GetDroppedCount();
+
+  // Stamps every following record emitted on this thread.
+  static void SetTimestamp(u64 cycle, u64 frame, int scanline);
+  // Labels the calling thread's track in exported timelines.
+  static void SetThreadName(const char* name);
+  static u16 InternTag(const char* name);
+  static u64 HostNanoseconds();
+  static void Emit(u16 tag, u32 a, u32 b);
+  static void EmitSpan(u16 tag, u64 start_ns);
+};
+
+// Emits one span record covering the enclosing scope; see SZ_TRACE_SCOPE.
+template <bool Enabled>
+class TraceScope {
+ public:
+  template <typename TagFn>
+  explicit TraceScope(TagFn&& /*tag*/) {}
+};
+
+template <>
+class TraceScope<true> {
+ public:
+  template <typename TagFn>
+  explicit TraceScope(TagFn&& tag) : active_(Trace::IsActive()) {
+    if (active_) {
+      tag_ = tag();
+      start_ns_ = Trace::HostNanoseconds();
+    }
+  }
+  ~TraceScope() {
+    if (active_) {
+      Trace::EmitSpan(tag_, start_ns_);
+    }
+  }
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  bool active_ = false;
+  u16 tag_ = 0;
+  u64 start_ns_ = 0;
 };
 
 }  // namespace sz::trace
 
+#define SZ_TRACE_CONCAT_INNER(a, b) a##b
+#define SZ_TRACE_CONCAT(a, b) SZ_TRACE_CONCAT_INNER(a, b)
+
+#define SZ_TRACE(category, tag, a, b)                                                      \
+  do {                                                                                     \
+    if constexpr ((::sz::trace::kCompiledMask & (category)) != 0) {                        \
+      static const u16 sz_trace_tag = ::sz::trace::Trace::InternTag(tag);                  \
+      ::sz::trace::Trace::Emit(sz_trace_tag, static_cast<u32>(a), static_cast<u32>(b));    \
+    }                                                                                      \
+  } while (0)
+
+// Times the rest of the enclosing block as one span.
+#define SZ_TRACE_SCOPE(category, tag)                                                      \
+  ::sz::trace::TraceScope<(::sz::trace::kCompiledMask & (category)) != 0> SZ_TRACE_CONCAT( \
+      sz_trace_scope_, __LINE__)([] {                                                      \
+    static const u16 sz_trace_tag = ::sz::trace::Trace::InternTag(tag);                    \
+    return sz_trace_tag;                                                                   \
+  })
+
+#define SZ_TRACE_TIMESTAMP(cycle, frame, scanline)                                         \
+  do {                                                                                     \
+    if constexpr (::sz::trace::kCompiledMask != 0) {                                       \
+      ::sz::trace::Trace::SetTimestamp(cycle, frame, scanline);                            \
+    }                                                                                      \
+  } while (0)
+
 #endif
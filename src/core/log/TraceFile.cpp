@@ -0,0 +1,84 @@
+#include "core/log/TraceFile.h"
+
+#include "core/log/Logger.h"
+
+namespace sz::trace {
+
+namespace {
+constexpr size_t kFileBufferSize = 1 << 20;
+}  // namespace
+
+TraceFileSink::~TraceFileSink() {
+  if (file_) {
+    std::fclose(file_);
+  }
+}
+
+bool TraceFileSink::Open(const std::string& path) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    SZ_LOG_ERROR("Trace: cannot open %s for writing", path.c_str());
+    return false;
+  }
+  std::setvbuf(file_, nullptr, _IOFBF, kFileBufferSize);
+  WriteU32(kTraceFileMagic);
+  WriteU16(kTraceFileVersion);
+  WriteU16(static_cast<u16>(sizeof(TraceRecord)));
+  return true;
+}
+
+void TraceFileSink::OnRecords(const TraceRecord* records, size_t count) {
+  if (!file_) {
+    return;
+  }
+  // TraceRecord has no padding, and every supported host is little-endian.
+  Write(records, count * sizeof(TraceRecord));
+  record_count_ += count;
+}
+
+void TraceFileSink::OnEnd(const std::vector<std::string>& tag_names) {
+  if (!file_) {
+    return;
+  }
+  const u64 tag_offset = offset_;
+  WriteU32(static_cast<u32>(tag_names.size()));
+  for (const auto& name : tag_names) {
+    WriteU16(static_cast<u16>(name.size()));
+    Write(name.data(), name.size());
+  }
+  WriteU64(record_count_);
+  WriteU64(tag_offset);
+  WriteU32(kTraceFileFooterMagic);
+
+  std::fclose(file_);
+  file_ = nullptr;
+  SZ_LOG_INFO("Trace: wrote %llu records", static_cast<unsigned long long>(record_count_));
+}
+
+void TraceFileSink::Write(const void* data, size_t size) {
+  std::fwrite(data, 1, size, file_);
+  offset_ += size;
+}
+
+void TraceFileSink::WriteU16(u16 value) {
+  const u8 bytes[2] = {static_cast<u8>(value), static_cast<u8>(value >> 8)};
+  Write(bytes, sizeof(bytes));
+}
+
+void TraceFileSink::WriteU32(u32 value) {
+  u8 bytes[4];
+  for (size_t i = 0; i < 4; ++i) {
+    bytes[i] = static_cast<u8>(value >> (8 * i));
+  }
+  Write(bytes, sizeof(bytes));
+}
+
+void TraceFileSink::WriteU64(u64 value) {
+  u8 bytes[8];
+  for (size_t i = 0; i < 8; ++i) {
+    bytes[i] = static_cast<u8>(value >> (8 * i));
+  }
+  Write(bytes, sizeof(bytes));
+}
+
+}  // namespace sz::trace
@@ -0,0 +1,44 @@
+#ifndef SUPERZ80_CORE_LOG_TRACEFILE_H
+#define SUPERZ80_CORE_LOG_TRACEFILE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/log/Trace.h"
+
+namespace sz::trace {
+
+// Binary trace file layout (little-endian):
+//   header : magic "SZTR", u16 version, u16 record size
+//   records: TraceRecord images, back to back
+//   tags   : u32 count, then per tag u16 length + name bytes
+//   footer : u64 record count, u64 tag table offset, magic "SZTE"
+constexpr u32 kTraceFileMagic = 0x52545A53u;        // "SZTR"
+constexpr u32 kTraceFileFooterMagic = 0x45545A53u;  // "SZTE"
+constexpr u16 kTraceFileVersion = 2;
+constexpr size_t kTraceFileHeaderSize = 8;
+constexpr size_t kTraceFileFooterSize = 20;
+
+class TraceFileSink : public ITraceSink {
+ public:
+  ~TraceFileSink() override;
+
+  bool Open(const std::string& path);
+  void OnRecords(const TraceRecord* records, size_t count) override;
+  void OnEnd(const std::vector<std::string>& tag_names) override;
+
+ private:
+  void Write(const void* data, size_t size);
+  void WriteU16(u16 value);
+  void WriteU32(u32 value);
+  void WriteU64(u64 value);
+
+  std::FILE* file_ = nullptr;
+  u64 record_count_ = 0;
+  u64 offset_ = 0;
+};
+
+}  // namespace sz::trace
+
+#endif
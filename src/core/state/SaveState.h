@@ -0,0 +1,210 @@
+#ifndef SUPERZ80_CORE_STATE_SAVESTATE_H
+#define SUPERZ80_CORE_STATE_SAVESTATE_H
+
+#include <cstddef>
+#include <cstring>
+
+#include "core/types.h"
+
+namespace sz::state {
+
+// Save-state layout (all integers little-endian):
+//   header  : magic "SZST", u16 version, u16 reserved, u32 total size
+//   sections: u32 tag, u32 payload size, payload
+// Sections appear in a fixed order; a version bump is required whenever any
+// section payload changes shape.
+constexpr u32 kMagic = 0x54535A53u;  // "SZST"
+constexpr u16 kVersion = 4;
+constexpr size_t kHeaderSize = 12;
+
+constexpr u32 MakeTag(char a, char b, char c, char d) {
+  return static_cast<u32>(static_cast<u8>(a)) | (static_cast<u32>(static_cast<u8>(b)) << 8) |
+         (static_cast<u32>(static_cast<u8>(c)) << 16) | (static_cast<u32>(static_cast<u8>(d)) << 24);
+}
+
+// Writes into a caller-owned, pre-sized buffer. Constructed with a null
+// buffer it only measures, which is how the console sizes a snapshot.
+class StateWriter {
+ public:
+  StateWriter(u8* data, size_t size) : data_(data), size_(size) {}
+
+  void WriteU8(u8 value) {
+    if (Reserve(1)) {
+      data_[pos_] = value;
+    }
+    pos_ += 1;
+  }
+
+  void WriteU16(u16 value) {
+    if (Reserve(2)) {
+      data_[pos_] = static_cast<u8>(value);
+      data_[pos_ + 1] = static_cast<u8>(value >> 8);
+    }
+    pos_ += 2;
+  }
+
+  void WriteU32(u32 value) {
+    if (Reserve(4)) {
+      for (size_t i = 0; i < 4; ++i) {
+        data_[pos_ + i] = static_cast<u8>(value >> (8 * i));
+      }
+    }
+    pos_ += 4;
+  }
+
+  void WriteU64(u64 value) {
+    if (Reserve(8)) {
+      for (size_t i = 0; i < 8; ++i) {
+        data_[pos_ + i] = static_cast<u8>(value >> (8 * i));
+      }
+    }
+    pos_ += 8;
+  }
+
+  void WriteBool(bool value) { WriteU8(value ? 1 : 0); }
+  void WriteS32(s32 value) { WriteU32(static_cast<u32>(value)); }
+
+  void WriteBytes(const u8* bytes, size_t count) {
+    if (Reserve(count)) {
+      std::memcpy(data_ + pos_, bytes, count);
+    }
+    pos_ += count;
+  }
+
+  void BeginSection(u32 tag) {
+    WriteU32(tag);
+    section_start_ = pos_;
+    WriteU32(0);
+  }
+
+  void EndSection() {
+    const size_t payload = pos_ - section_start_ - 4;
+    if (data_ && ok_) {
+      for (size_t i = 0; i < 4; ++i) {
+        data_[section_start_ + i] = static_cast<u8>(payload >> (8 * i));
+      }
+    }
+  }
+
+  size_t Position() const { return pos_; }
+  bool Ok() const { return ok_; }
+
+ private:
+  bool Reserve(size_t count) {
+    if (!data_) {
+      return false;
+    }
+    if (pos_ + count > size_) {
+      ok_ = false;
+      return false;
+    }
+    return ok_;
+  }
+
+  u8* data_ = nullptr;
+  size_t size_ = 0;
+  size_t pos_ = 0;
+  size_t section_start_ = 0;
+  bool ok_ = true;
+};
+
+// Reads a snapshot produced by StateWriter. Any overrun or section mismatch
+// latches Ok() to false; subsequent reads return zero. Devices latch it too,
+// through Expect, when a field they loaded is out of range.
+class StateReader {
+ public:
+  StateReader(const u8* data, size_t size) : data_(data), size_(size) {}
+
+  u8 ReadU8() {
+    if (!Take(1)) {
+      return 0;
+    }
+    return data_[pos_ - 1];
+  }
+
+  u16 ReadU16() {
+    if (!Take(2)) {
+      return 0;
+    }
+    const u8* p = data_ + pos_ - 2;
+    return static_cast<u16>(p[0] | (p[1] << 8));
+  }
+
+  u32 ReadU32() {
+    if (!Take(4)) {
+      return 0;
+    }
+    const u8* p = data_ + pos_ - 4;
+    u32 value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      value |= static_cast<u32>(p[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  u64 ReadU64() {
+    if (!Take(8)) {
+      return 0;
+    }
+    const u8* p = data_ + pos_ - 8;
+    u64 value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      value |= static_cast<u64>(p[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  bool ReadBool() { return ReadU8() != 0; }
+  s32 ReadS32() { return static_cast<s32>(ReadU32()); }
+
+  void ReadBytes(u8* bytes, size_t count) {
+    if (!Take(count)) {
+      std::memset(bytes, 0, count);
+      return;
+    }
+    std::memcpy(bytes, data_ + pos_ - count, count);
+  }
+
+  void BeginSection(u32 tag) {
+    if (ReadU32() != tag) {
+      ok_ = false;
+    }
+    const u32 payload = ReadU32();
+    section_end_ = pos_ + payload;
+  }
+
+  void EndSection() {
+    if (pos_ != section_end_) {
+      ok_ = false;
+    }
+  }
+
+  void Expect(bool valid) {
+    if (!valid) {
+      ok_ = false;
+    }
+  }
+
+  size_t Position() const { return pos_; }
+  bool Ok() const { return ok_; }
+
+ private:
+  bool Take(size_t count) {
+    if (!ok_ || pos_ + count > size_) {
+      ok_ = false;
+      return false;
+    }
+    pos_ += count;
+    return true;
+  }
+
+  const u8* data_ = nullptr;
+  size_t size_ = 0;
+  size_t pos_ = 0;
+  size_t section_end_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace sz::state
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SUPERZ80_CORE_UTIL_COWMEMORY_H
+#define SUPERZ80_CORE_UTIL_COWMEMORY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "core/types.h"
+
+namespace sz::util {
+
+// Fixed-size memory split into pages that copies share until written.
+// Copying the object only bumps page reference counts; the first write to
+// a shared page gives the writer a private copy of that page alone. Shared
+// pages are never written, so copies may be used from different threads.
+template <size_t kSize, size_t kPageSize>
+class CowMemory {
+  static_assert(kPageSize > 0 && kSize % kPageSize == 0);
+
+ public:
+  static constexpr size_t kPageCount = kSize / kPageSize;
+
+  CowMemory() {
+    for (size_t page = 0; page < kPageCount; ++page) {
+      pages_[page] = std::make_shared<Page>();
+      data_[page] = pages_[page]->data();
+      owned_[page] = true;
+    }
+  }
+
+  // Sharing demotes the source's pages too (owned_ is mutable for that);
+  // which side copies a page first is unobservable.
+  CowMemory(const CowMemory& other)
+      : pages_(other.pages_), data_(other.data_), block_(other.block_), block_pages_(other.block_pages_) {
+    owned_.fill(false);
+    other.owned_.fill(false);
+  }
+
+  CowMemory& operator=(const CowMemory& other) {
+    if (this != &other) {
+      pages_ = other.pages_;
+      data_ = other.data_;
+      block_ = other.block_;
+      block_pages_ = other.block_pages_;
+      owned_.fill(false);
+      other.owned_.fill(false);
+    }
+    return *this;
+  }
+
+  static constexpr size_t Size() { return kSize; }
+
+  u8 Read(size_t addr) const { return data_[addr / kPageSize][addr % kPageSize]; }
+
+  void Write(size_t addr, u8 value) { WritablePage(addr / kPageSize)[addr % kPageSize] = value; }
+
+  // Pointer to `addr` that stays readable to the end of its page.
+  const u8* ReadPointer(size_t addr) const { return data_[addr / kPageSize] + addr % kPageSize; }
+
+  // Unshares the page holding `addr`; writable to the end of that page.
+  u8* WritePointer(size_t addr) { return WritablePage(addr / kPageSize) + addr % kPageSize; }
+
+  // The whole memory as one writable array. Every page is unshared and
+  // laid out in order in one block, gathered into a new one if needed.
+  // Writes keep pages in the block, so the pointer stays valid until the
+  // object is copied or assigned.
+  u8* Contiguous() {
+    if (block_pages_ != kPageCount || block_.use_count() != static_cast<long>(kPageCount) + 1) {
+      auto block = std::make_shared<Block>();
+      for (size_t page = 0; page < kPageCount; ++page) {
+        (*block)[page] = *pages_[page];
+        pages_[page] = std::shared_ptr<Page>(block, &(*block)[page]);
+        data_[page] = (*block)[page].data();
+      }
+      block_ = std::move(block);
+      block_pages_ = kPageCount;
+    } else {
+      std::atomic_thread_fence(std::memory_order_acquire);  // as in Unshare
+    }
+    owned_.fill(true);
+    return data_[0];
+  }
+
+  void Fill(u8 value) {
+    for (size_t page = 0; page < kPageCount; ++page) {
+      std::fill_n(WritablePage(page), kPageSize, value);
+    }
+  }
+
+  template <typename Fn>
+  void ForEachPage(Fn&& fn) const {
+    for (size_t page = 0; page < kPageCount; ++page) {
+      fn(static_cast<const u8*>(data_[page]), kPageSize);
+    }
+  }
+
+  // Calls fn(incoming, current, size) per page; fn fills `incoming` with
+  // the page's new bytes. Only pages whose bytes change are unshared.
+  template <typename Fn>
+  void UpdatePages(Fn&& fn) {
+    Page incoming;
+    for (size_t page = 0; page < kPageCount; ++page) {
+      fn(incoming.data(), static_cast<const u8*>(data_[page]), kPageSize);
+      if (std::memcmp(incoming.data(), data_[page], kPageSize) != 0) {
+        std::memcpy(WritablePage(page), incoming.data(), kPageSize);
+      }
+    }
+  }
+
+  // Pages held only by this object.
+  size_t GetPrivatePageCount() const {
+    size_t count = 0;
+    for (size_t page = 0; page < kPageCount; ++page) {
+      count += IsUnique(page) ? 1 : 0;
+    }
+    return count;
+  }
+
+ private:
+  using Page = std::array<u8, kPageSize>;
+  using Block = std::array<Page, kPageCount>;
+  static_assert(sizeof(Block) == kSize, "pages of a block must be back to back");
+
+  bool InBlock(size_t page) const { return block_ && data_[page] == (*block_)[page].data(); }
+
+  // A page inside the block shares the block's count: it is unique when
+  // nobody else holds any of the block's pages.
+  bool IsUnique(size_t page) const {
+    return InBlock(page) ? block_.use_count() == static_cast<long>(block_pages_) + 1
+                         : pages_[page].use_count() == 1;
+  }
+
+  u8* WritablePage(size_t page) {
+    if (!owned_[page]) {
+      Unshare(page);
+    }
+    return data_[page];
+  }
+
+  void Unshare(size_t page) {
+    // The last holder can take the page back without copying; nobody else
+    // can gain a reference to it but this object's own copies.
+    if (!IsUnique(page)) {
+      const bool in_block = InBlock(page);
+      pages_[page] = std::make_shared<Page>(*pages_[page]);
+      data_[page] = pages_[page]->data();
+      if (in_block && --block_pages_ == 0) {
+        block_.reset();
+      }
+    } else {
+      // Pairs with the release of the last other holder, whose reads of
+      // the page must finish before we write it.
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    owned_[page] = true;
+  }
+
+  std::array<std::shared_ptr<Page>, kPageCount> pages_;
+  std::array<u8*, kPageCount> data_{};  // pages_[i]->data(), kept for the read path
+  mutable std::array<bool, kPageCount> owned_{};
+  // Set by Contiguous; block_pages_ of pages_ point into it.
+  std::shared_ptr<Block> block_;
+  size_t block_pages_ = 0;
+};
+
+}  // namespace sz::util
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SUPERZ80_CORE_UTIL_HASH_H
+#define SUPERZ80_CORE_UTIL_HASH_H
+
+#include <cstddef>
+
+#include "core/types.h"
+
+namespace sz::util {
+
+constexpr u64 kFnv1aOffset = 0xCBF29CE484222325ull;
+constexpr u64 kFnv1aPrime = 0x00000100000001B3ull;
+
+// 64-bit FNV-1a. Stable across hosts; used for frame and state fingerprints.
+inline u64 Fnv1a64(const void* data, size_t size, u64 hash = kFnv1aOffset) {
+  const u8* bytes = static_cast<const u8*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnv1aPrime;
+  }
+  return hash;
+}
+
+}  // namespace sz::util
+
+#endif
@@ -0,0 +1,130 @@
+#include "core/util/Lz.h"
+
+#include <array>
+#include <cstring>
+
+namespace sz::util {
+
+namespace {
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 0xFFFF;
+constexpr int kHashBits = 14;
+
+u32 Load32(const u8* p) {
+  u32 value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+void PutLength(std::vector<u8>& out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<u8>(length));
+}
+
+void EmitSequence(std::vector<u8>& out, const u8* literals, size_t literal_count, size_t offset,
+                  size_t match_length) {
+  const size_t match_code = match_length - kMinMatch;
+  out.push_back(static_cast<u8>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                (match_code < 15 ? match_code : 15)));
+  if (literal_count >= 15) {
+    PutLength(out, literal_count - 15);
+  }
+  out.insert(out.end(), literals, literals + literal_count);
+  out.push_back(static_cast<u8>(offset));
+  out.push_back(static_cast<u8>(offset >> 8));
+  if (match_code >= 15) {
+    PutLength(out, match_code - 15);
+  }
+}
+
+bool GetLength(const u8* data, size_t size, size_t& pos, size_t& length) {
+  u8 byte = 0;
+  do {
+    if (pos >= size) {
+      return false;
+    }
+    byte = data[pos++];
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+void LzCompress(const u8* data, size_t size, std::vector<u8>& out) {
+  std::array<u32, 1u << kHashBits> table{};  // position + 1; 0 = empty
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + kMinMatch <= size) {
+    const u32 sequence = Load32(data + pos);
+    const u32 hash = (sequence * 2654435761u) >> (32 - kHashBits);
+    const size_t candidate = table[hash];
+    table[hash] = static_cast<u32>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || Load32(data + candidate - 1) != sequence) {
+      ++pos;
+      continue;
+    }
+
+    const size_t match = candidate - 1;
+    size_t length = kMinMatch;
+    while (pos + length < size && data[match + length] == data[pos + length]) {
+      ++length;
+    }
+    EmitSequence(out, data + anchor, pos - anchor, pos - match, length);
+    pos += length;
+    anchor = pos;
+  }
+
+  // Final literal-only sequence; the decoder stops after its literals.
+  const size_t literal_count = size - anchor;
+  out.push_back(static_cast<u8>((literal_count < 15 ? literal_count : 15) << 4));
+  if (literal_count >= 15) {
+    PutLength(out, literal_count - 15);
+  }
+  out.insert(out.end(), data + anchor, data + size);
+}
+
+bool LzDecompress(const u8* data, size_t size, u8* out, size_t out_size) {
+  size_t in = 0;
+  size_t written = 0;
+  while (in < size) {
+    const u8 token = data[in++];
+    size_t literal_count = token >> 4;
+    if (literal_count == 15 && !GetLength(data, size, in, literal_count)) {
+      return false;
+    }
+    if (literal_count > size - in || literal_count > out_size - written) {
+      return false;
+    }
+    std::memcpy(out + written, data + in, literal_count);
+    in += literal_count;
+    written += literal_count;
+    if (in == size) {
+      break;
+    }
+
+    if (size - in < 2) {
+      return false;
+    }
+    const size_t offset = data[in] | (data[in + 1] << 8);
+    in += 2;
+    size_t length = token & 0x0F;
+    if (length == 15 && !GetLength(data, size, in, length)) {
+      return false;
+    }
+    length += kMinMatch;
+    if (offset == 0 || offset > written || length > out_size - written) {
+      return false;
+    }
+    // Byte-wise: matches may overlap their own output.
+    for (size_t i = 0; i < length; ++i) {
+      out[written + i] = out[written - offset + i];
+    }
+    written += length;
+  }
+  return written == out_size;
+}
+
+}  // namespace sz::util
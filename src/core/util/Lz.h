@@ -0,0 +1,20 @@
+#ifndef SUPERZ80_CORE_UTIL_LZ_H
+#define SUPERZ80_CORE_UTIL_LZ_H
+
+#include <cstddef>
+#include <vector>
+
+#include "core/types.h"
+
+namespace sz::util {
+
+// Small LZ77 block codec in the LZ4 style: a token byte holds literal and
+// match lengths (4 bits each, 15 extends with 255-run bytes), followed by
+// literals and a 16-bit back offset. Fast enough to keep up with trace
+// streams on a writer thread; not meant for archival ratios.
+void LzCompress(const u8* data, size_t size, std::vector<u8>& out);
+bool LzDecompress(const u8* data, size_t size, u8* out, size_t out_size);
+
+}  // namespace sz::util
+
+#endif
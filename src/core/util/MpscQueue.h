@@ -0,0 +1,86 @@
+#ifndef SUPERZ80_CORE_UTIL_MPSCQUEUE_H
+#define SUPERZ80_CORE_UTIL_MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "core/util/NonCopyable.h"
+
+namespace sz::util {
+
+// Bounded lock-free queue for many producers and one consumer (Vyukov's
+// sequence-per-cell design). Capacity is rounded up to a power of two.
+// Producers fill a slot in place through a callback, so large records are
+// written once.
+template <typename T>
+class MpscQueue : private NonCopyable {
+ public:
+  explicit MpscQueue(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    cells_ = std::make_unique<Cell[]>(rounded);
+    mask_ = rounded - 1;
+    for (size_t i = 0; i < rounded; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Calls fill(T&) on a claimed slot; returns false if the queue is full.
+  template <typename Fill>
+  bool TryPush(Fill&& fill) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    fill(cell->value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns a pointer to the oldest item, or nullptr if the
+  // queue is empty (or the oldest slot is still being filled).
+  T* Front() {
+    Cell& cell = cells_[dequeue_pos_ & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+      return nullptr;
+    }
+    return &cell.value;
+  }
+
+  // Consumer only. Releases the slot returned by Front().
+  void Pop() {
+    Cell& cell = cells_[dequeue_pos_ & mask_];
+    cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    ++dequeue_pos_;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    T value{};
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) size_t dequeue_pos_ = 0;
+};
+
+}  // namespace sz::util
+
+#endif
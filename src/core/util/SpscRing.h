@@ -0,0 +1,78 @@
+#ifndef SUPERZ80_CORE_UTIL_SPSCRING_H
+#define SUPERZ80_CORE_UTIL_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "core/util/Assert.h"
+#include "core/util/NonCopyable.h"
+
+namespace sz::util {
+
+// Bounded single-producer/single-consumer queue. Capacity is rounded up to a
+// power of two. Neither side blocks: a full push or an empty pop fails.
+template <typename T>
+class SpscRing : private NonCopyable {
+ public:
+  explicit SpscRing(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    slots_.resize(rounded);
+    mask_ = rounded - 1;
+  }
+
+  bool TryPush(const T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[head & mask_] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = slots_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops up to `max` items into `out`; returns the number popped.
+  size_t PopBatch(T* out, size_t max) {
+    SZ_ASSERT(out != nullptr || max == 0);
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t count = head_.load(std::memory_order_acquire) - tail;
+    if (count > max) {
+      count = max;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = slots_[(tail + i) & mask_];
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Consumer side: items that can be popped now.
+  size_t Available() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  std::vector<T> slots_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> head_{0};  // producer
+  alignas(64) std::atomic<size_t> tail_{0};  // consumer
+};
+
+}  // namespace sz::util
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SUPERZ80_CORE_UTIL_TRIPLEBUFFER_H
+#define SUPERZ80_CORE_UTIL_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <memory>
+
+#include "core/types.h"
+#include "core/util/NonCopyable.h"
+
+namespace sz::util {
+
+// Lock-free triple buffer for one writer and one reader. The writer fills
+// Back() and publishes it; the reader picks up the newest published slot
+// with Update(). Neither side ever waits: the three slots rotate through a
+// single atomic exchange, and a value the reader never got to is simply
+// overwritten by the next one. Slots are heap-allocated so large values
+// (framebuffers) can sit in objects that live on the stack.
+template <typename T>
+class TripleBuffer : private NonCopyable {
+ public:
+  TripleBuffer() : slots_(std::make_unique<T[]>(3)) {}
+
+  // Writer.
+  T& Back() { return slots_[back_]; }
+  void Publish() {
+    const u8 previous = middle_.exchange(static_cast<u8>(back_ | kFresh), std::memory_order_acq_rel);
+    back_ = previous & kIndexMask;
+  }
+
+  // Reader. Swaps in the newest published value; returns false (and keeps
+  // the current front) when nothing was published since the last call.
+  bool Update() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    const u8 previous = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & kIndexMask;
+    return true;
+  }
+  const T& Front() const { return slots_[front_]; }
+
+ private:
+  static constexpr u8 kIndexMask = 0x03;
+  static constexpr u8 kFresh = 0x04;
+
+  std::unique_ptr<T[]> slots_;
+  // Index of the slot in transit, plus kFresh when the reader has not
+  // taken it yet.
+  alignas(64) std::atomic<u8> middle_{1};
+  alignas(64) u8 back_ = 0;  // writer
+  alignas(64) u8 front_ = 2;  // reader
+};
+
+}  // namespace sz::util
+
+#endif
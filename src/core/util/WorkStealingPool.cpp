@@ -0,0 +1,137 @@
+#include "core/util/WorkStealingPool.h"
+
+#include <algorithm>
+
+#include "core/util/Assert.h"
+
+namespace sz::util {
+
+namespace {
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local int t_worker = -1;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers_.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Started only once every deque exists, since workers steal from all.
+  for (unsigned i = 0; i < threads; ++i) {
+    workers_[i]->thread = std::thread(&WorkStealingPool::WorkerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+unsigned WorkStealingPool::GetThreadCount() const {
+  return static_cast<unsigned>(workers_.size());
+}
+
+void WorkStealingPool::Submit(Task task) {
+  SZ_ASSERT(task);
+  const unsigned target = t_pool == this ? static_cast<unsigned>(t_worker)
+                                         : next_worker_.fetch_add(1, std::memory_order_relaxed) % GetThreadCount();
+  pending_.fetch_add(1, std::memory_order_acq_rel);
+  {
+    std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+    workers_[target]->tasks.push_back(std::move(task));
+    queued_.fetch_add(1, std::memory_order_acq_rel);
+  }
+  {
+    // Taking the wake mutex orders this notify after any worker that is
+    // between its queued_ check and its wait.
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  wake_.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  idle_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+}
+
+std::vector<WorkStealingPool::WorkerStats> WorkStealingPool::GetStats() const {
+  std::vector<WorkerStats> stats(workers_.size());
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    stats[i].executed = workers_[i]->executed.load(std::memory_order_relaxed);
+    stats[i].stolen = workers_[i]->stolen.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+int WorkStealingPool::CurrentWorker() {
+  return t_worker;
+}
+
+bool WorkStealingPool::PopLocal(unsigned index, Task& task) {
+  Worker& worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  queued_.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+bool WorkStealingPool::Steal(unsigned thief, Task& task) {
+  const unsigned count = GetThreadCount();
+  for (unsigned offset = 1; offset < count; ++offset) {
+    Worker& victim = *workers_[(thief + offset) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      queued_.fetch_sub(1, std::memory_order_acq_rel);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::WorkerLoop(unsigned index) {
+  t_pool = this;
+  t_worker = static_cast<int>(index);
+  Worker& self = *workers_[index];
+  for (;;) {
+    Task task;
+    bool stolen = false;
+    if (!PopLocal(index, task)) {
+      stolen = Steal(index, task);
+    }
+    if (task) {
+      task();
+      self.executed.fetch_add(1, std::memory_order_relaxed);
+      if (stolen) {
+        self.stolen.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        idle_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+    if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace sz::util
@@ -0,0 +1,70 @@
+#ifndef SUPERZ80_CORE_UTIL_WORKSTEALINGPOOL_H
+#define SUPERZ80_CORE_UTIL_WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "core/util/NonCopyable.h"
+
+namespace sz::util {
+
+// Fixed set of worker threads, each with its own task deque. A worker pops
+// its newest task; an idle worker steals the oldest task of another. Tasks
+// submitted from inside a task stay on the submitting worker's deque.
+// Deques are mutex-guarded per worker, so submitters and thieves only
+// contend on the deque they touch.
+class WorkStealingPool : private NonCopyable {
+ public:
+  using Task = std::function<void()>;
+
+  struct WorkerStats {
+    u64 executed = 0;
+    u64 stolen = 0;  // of `executed`, taken from another worker's deque
+  };
+
+  // 0 threads: one per hardware thread.
+  explicit WorkStealingPool(unsigned threads = 0);
+  ~WorkStealingPool();
+
+  unsigned GetThreadCount() const;
+  void Submit(Task task);
+  // Blocks until every task submitted so far, and any they submitted, ran.
+  void Wait();
+  std::vector<WorkerStats> GetStats() const;
+
+  // Index of the calling worker thread in its pool, or -1 outside a pool.
+  static int CurrentWorker();
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::atomic<u64> executed{0};
+    std::atomic<u64> stolen{0};
+    std::thread thread;
+  };
+
+  void WorkerLoop(unsigned index);
+  bool PopLocal(unsigned index, Task& task);
+  bool Steal(unsigned thief, Task& task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<unsigned> next_worker_{0};
+  std::atomic<size_t> queued_{0};   // sitting in a deque
+  std::atomic<size_t> pending_{0};  // submitted and not yet finished
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  bool stopping_ = false;
+};
+
+}  // namespace sz::util
+
+#endif
@@ -0,0 +1,424 @@
+#include "cpu/ExecTrace.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "core/log/Logger.h"
+#include "core/util/Lz.h"
+
+namespace sz::cpu {
+
+namespace {
+constexpr size_t kBlockRecords = 1 << 14;
+constexpr unsigned kMaxWorkers = 4;
+constexpr size_t kMaxChunkSize = 64u << 20;
+
+constexpr u8 kHeadKindMask = 0x03;
+constexpr u8 kHeadOpcode = 0x04;
+constexpr u8 kHeadMisc = 0x08;
+constexpr u8 kHeadPc = 0x10;
+constexpr u8 kHeadRegs = 0x20;
+
+constexpr u16 ExecTraceRecord::* kRegFields[] = {
+    &ExecTraceRecord::af, &ExecTraceRecord::bc, &ExecTraceRecord::de, &ExecTraceRecord::hl,
+    &ExecTraceRecord::ix, &ExecTraceRecord::iy, &ExecTraceRecord::sp,
+};
+
+// Head, 10-byte varint, pc, opcode, misc, mask and seven registers.
+constexpr size_t kMaxEncodedSize = 1 + 10 + 2 + 4 + 2 + 1 + 14;
+
+u8* PutVarint(u8* out, u64 value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<u8>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<u8>(value);
+  return out;
+}
+
+u8* PutU16(u8* out, u16 value) {
+  out[0] = static_cast<u8>(value);
+  out[1] = static_cast<u8>(value >> 8);
+  return out + 2;
+}
+
+bool GetVarint(const u8*& data, const u8* end, u64& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && data < end; shift += 7) {
+    const u8 byte = *data++;
+    value |= static_cast<u64>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Cycle deltas go negative when a snapshot is loaded mid-trace.
+u64 ZigZag(s64 value) {
+  return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+
+s64 UnZigZag(u64 value) {
+  return static_cast<s64>(value >> 1) ^ -static_cast<s64>(value & 1);
+}
+
+u32 PackOpcode(const ExecTraceRecord& record) {
+  return static_cast<u32>(record.opcode[0]) | (static_cast<u32>(record.opcode[1]) << 8) |
+         (static_cast<u32>(record.opcode[2]) << 16) | (static_cast<u32>(record.opcode[3]) << 24);
+}
+
+u16 PredictPc(const ExecTraceRecord& prev, u8 prev_length) {
+  if (prev.kind != kExecTraceInstruction) {
+    return prev.pc;
+  }
+  return static_cast<u16>(prev.pc + prev_length);
+}
+
+void PutU32(std::FILE* file, u32 value) {
+  const u8 bytes[4] = {static_cast<u8>(value), static_cast<u8>(value >> 8), static_cast<u8>(value >> 16),
+                       static_cast<u8>(value >> 24)};
+  std::fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+bool GetU32(std::FILE* file, u32& value) {
+  u8 bytes[4];
+  if (std::fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+    return false;
+  }
+  value = static_cast<u32>(bytes[0]) | (static_cast<u32>(bytes[1]) << 8) | (static_cast<u32>(bytes[2]) << 16) |
+          (static_cast<u32>(bytes[3]) << 24);
+  return true;
+}
+}  // namespace
+
+ExecTraceCodec::ExecTraceCodec() : opcode_cache_(0x10000), length_cache_(0x10000) {
+  Reset();
+}
+
+void ExecTraceCodec::Reset() {
+  prev_ = ExecTraceRecord{};
+  prev_length_ = 1;
+  // A zeroed cache holds NOPs, which are one byte long.
+  std::fill(opcode_cache_.begin(), opcode_cache_.end(), 0u);
+  std::fill(length_cache_.begin(), length_cache_.end(), u8{1});
+}
+
+void ExecTraceCodec::Encode(const ExecTraceRecord& record, std::vector<u8>& out) {
+  // Built on the stack and appended once; per-byte push_back dominated.
+  u8 buffer[kMaxEncodedSize];
+  u8* cursor = buffer;
+  if (record.kind == kExecTraceFrame) {
+    *cursor++ = kExecTraceFrame;
+    cursor = PutVarint(cursor, record.cycle);
+    out.insert(out.end(), buffer, cursor);
+    return;
+  }
+
+  u8 head = record.kind;
+  const u32 opcode = PackOpcode(record);
+  if (record.pc != PredictPc(prev_, prev_length_)) {
+    head |= kHeadPc;
+  }
+  if (opcode_cache_[record.pc] != opcode) {
+    head |= kHeadOpcode;
+  }
+  if (record.i != prev_.i || record.flags != prev_.flags) {
+    head |= kHeadMisc;
+  }
+  u8 reg_mask = 0;
+  for (size_t k = 0; k < std::size(kRegFields); ++k) {
+    if (record.*kRegFields[k] != prev_.*kRegFields[k]) {
+      reg_mask |= static_cast<u8>(1u << k);
+    }
+  }
+  if (reg_mask != 0) {
+    head |= kHeadRegs;
+  }
+
+  *cursor++ = head;
+  cursor = PutVarint(cursor, ZigZag(static_cast<s64>(record.cycle - prev_.cycle)));
+  if (head & kHeadPc) {
+    cursor = PutU16(cursor, record.pc);
+  }
+  if (head & kHeadOpcode) {
+    for (const u8 byte : record.opcode) {
+      *cursor++ = byte;
+    }
+    opcode_cache_[record.pc] = opcode;
+    length_cache_[record.pc] = static_cast<u8>(InstructionLength(record.opcode.data()));
+  }
+  if (head & kHeadMisc) {
+    *cursor++ = record.i;
+    *cursor++ = record.flags;
+  }
+  if (head & kHeadRegs) {
+    *cursor++ = reg_mask;
+    for (size_t k = 0; k < std::size(kRegFields); ++k) {
+      if (reg_mask & (1u << k)) {
+        cursor = PutU16(cursor, record.*kRegFields[k]);
+      }
+    }
+  }
+  out.insert(out.end(), buffer, cursor);
+  prev_ = record;
+  prev_length_ = length_cache_[record.pc];
+}
+
+bool ExecTraceCodec::Decode(const u8*& data, const u8* end, ExecTraceRecord& record) {
+  if (data >= end) {
+    return false;
+  }
+  const u8 head = *data++;
+  const u8 kind = head & kHeadKindMask;
+  if (kind == kExecTraceFrame) {
+    record = ExecTraceRecord{};
+    record.kind = kExecTraceFrame;
+    return GetVarint(data, end, record.cycle);
+  }
+
+  ExecTraceRecord next = prev_;
+  next.kind = kind;
+  u64 delta = 0;
+  if (!GetVarint(data, end, delta)) {
+    return false;
+  }
+  next.cycle = prev_.cycle + static_cast<u64>(UnZigZag(delta));
+
+  auto need = [&](size_t count) { return static_cast<size_t>(end - data) >= count; };
+  if (head & kHeadPc) {
+    if (!need(2)) {
+      return false;
+    }
+    next.pc = static_cast<u16>(data[0] | (data[1] << 8));
+    data += 2;
+  } else {
+    next.pc = PredictPc(prev_, prev_length_);
+  }
+  if (head & kHeadOpcode) {
+    if (!need(next.opcode.size())) {
+      return false;
+    }
+    for (auto& byte : next.opcode) {
+      byte = *data++;
+    }
+    opcode_cache_[next.pc] = PackOpcode(next);
+    length_cache_[next.pc] = static_cast<u8>(InstructionLength(next.opcode.data()));
+  } else {
+    const u32 cached = opcode_cache_[next.pc];
+    for (size_t i = 0; i < next.opcode.size(); ++i) {
+      next.opcode[i] = static_cast<u8>(cached >> (8 * i));
+    }
+  }
+  if (head & kHeadMisc) {
+    if (!need(2)) {
+      return false;
+    }
+    next.i = data[0];
+    next.flags = data[1];
+    data += 2;
+  }
+  if (head & kHeadRegs) {
+    if (!need(1)) {
+      return false;
+    }
+    const u8 reg_mask = *data++;
+    for (size_t k = 0; k < std::size(kRegFields); ++k) {
+      if (reg_mask & (1u << k)) {
+        if (!need(2)) {
+          return false;
+        }
+        next.*kRegFields[k] = static_cast<u16>(data[0] | (data[1] << 8));
+        data += 2;
+      }
+    }
+  }
+
+  prev_ = next;
+  prev_length_ = length_cache_[next.pc];
+  record = next;
+  return true;
+}
+
+ExecTraceWriter::~ExecTraceWriter() {
+  Close();
+}
+
+bool ExecTraceWriter::Open(const std::string& path) {
+  Close();
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    SZ_LOG_ERROR("CPU trace: cannot open %s for writing", path.c_str());
+    return false;
+  }
+  PutU32(file_, kExecTraceMagic);
+  PutU32(file_, kExecTraceVersion);
+
+  // Chunks are coded independently, so several can be in flight at once.
+  const unsigned workers = std::clamp(std::thread::hardware_concurrency(), 2u, kMaxWorkers + 1) - 1;
+  records_written_ = 0;
+  bytes_written_ = 8;
+  stopping_ = false;
+  next_sequence_ = 0;
+  next_write_ = 0;
+  full_.clear();
+  free_.clear();
+  for (unsigned i = 0; i < workers + 1; ++i) {
+    free_.push_back(std::make_unique<Block>(kBlockRecords));
+  }
+  block_ = std::make_unique<Block>(kBlockRecords);
+  fill_ = 0;
+  for (unsigned i = 0; i < workers; ++i) {
+    workers_.emplace_back(&ExecTraceWriter::WorkerLoop, this);
+  }
+  return true;
+}
+
+void ExecTraceWriter::Close() {
+  if (!file_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    full_.push_back(PendingBlock{std::move(block_), fill_, next_sequence_++});
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  std::fclose(file_);
+  file_ = nullptr;
+  fill_ = 0;
+  SZ_LOG_INFO("CPU trace: %llu records, %llu bytes (%.2f bytes/record)",
+              static_cast<unsigned long long>(records_written_), static_cast<unsigned long long>(bytes_written_),
+              records_written_ ? static_cast<double>(bytes_written_) / static_cast<double>(records_written_) : 0.0);
+}
+
+void ExecTraceWriter::MarkFrame(u64 frame) {
+  ExecTraceRecord& record = Append();
+  record = ExecTraceRecord{};
+  record.kind = kExecTraceFrame;
+  record.cycle = frame;
+}
+
+void ExecTraceWriter::SubmitBlock() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  full_.push_back(PendingBlock{std::move(block_), fill_, next_sequence_++});
+  cv_.notify_all();
+  cv_.wait(lock, [this] { return !free_.empty(); });
+  block_ = std::move(free_.back());
+  free_.pop_back();
+  fill_ = 0;
+}
+
+void ExecTraceWriter::WorkerLoop() {
+  ExecTraceCodec codec;
+  std::vector<u8> encoded;
+  std::vector<u8> compressed;
+  for (;;) {
+    PendingBlock item;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return !full_.empty() || stopping_; });
+      if (full_.empty()) {
+        return;
+      }
+      item = std::move(full_.front());
+      full_.pop_front();
+    }
+
+    codec.Reset();
+    encoded.clear();
+    for (size_t i = 0; i < item.count; ++i) {
+      codec.Encode((*item.block)[i], encoded);
+    }
+    compressed.clear();
+    sz::util::LzCompress(encoded.data(), encoded.size(), compressed);
+
+    // Chunks are written in submission order; only the worker holding the
+    // next sequence number touches the file.
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return next_write_ == item.sequence; });
+    }
+    if (item.count != 0) {
+      PutU32(file_, static_cast<u32>(encoded.size()));
+      PutU32(file_, static_cast<u32>(compressed.size()));
+      std::fwrite(compressed.data(), 1, compressed.size(), file_);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      records_written_ += item.count;
+      bytes_written_ += item.count != 0 ? 8 + compressed.size() : 0;
+      ++next_write_;
+      free_.push_back(std::move(item.block));
+    }
+    cv_.notify_all();
+  }
+}
+
+ExecTraceReader::~ExecTraceReader() {
+  if (file_) {
+    std::fclose(file_);
+  }
+}
+
+bool ExecTraceReader::Open(const std::string& path) {
+  file_ = std::fopen(path.c_str(), "rb");
+  if (!file_) {
+    SZ_LOG_ERROR("CPU trace: cannot open %s", path.c_str());
+    return false;
+  }
+  u32 magic = 0;
+  u32 version = 0;
+  if (!GetU32(file_, magic) || !GetU32(file_, version) || magic != kExecTraceMagic ||
+      (version & 0xFFFF) != kExecTraceVersion) {
+    SZ_LOG_ERROR("CPU trace: %s is not a version %u trace", path.c_str(), kExecTraceVersion);
+    return false;
+  }
+  return true;
+}
+
+bool ExecTraceReader::Next(ExecTraceRecord& record) {
+  while (pos_ >= chunk_.size()) {
+    if (!ok_ || !LoadChunk()) {
+      return false;
+    }
+  }
+  const u8* data = chunk_.data() + pos_;
+  if (!codec_.Decode(data, chunk_.data() + chunk_.size(), record)) {
+    ok_ = false;
+    return false;
+  }
+  pos_ = static_cast<size_t>(data - chunk_.data());
+  return true;
+}
+
+bool ExecTraceReader::LoadChunk() {
+  u32 raw_size = 0;
+  u32 compressed_size = 0;
+  if (!GetU32(file_, raw_size)) {
+    return false;  // clean end of file
+  }
+  if (!GetU32(file_, compressed_size) || raw_size > kMaxChunkSize || compressed_size > kMaxChunkSize) {
+    ok_ = false;
+    return false;
+  }
+  compressed_.resize(compressed_size);
+  chunk_.resize(raw_size);
+  pos_ = 0;
+  codec_.Reset();
+  if (std::fread(compressed_.data(), 1, compressed_size, file_) != compressed_size ||
+      !sz::util::LzDecompress(compressed_.data(), compressed_.size(), chunk_.data(), chunk_.size())) {
+    ok_ = false;
+    chunk_.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace sz::cpu
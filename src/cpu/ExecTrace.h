@@ -0,0 +1,140 @@
+#ifndef SUPERZ80_CPU_EXECTRACE_H
+#define SUPERZ80_CPU_EXECTRACE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "core/util/NonCopyable.h"
+#include "cpu/Z80Disassembler.h"
+
+namespace sz::cpu {
+
+constexpr u8 kExecTraceInstruction = 0;  // about to execute at pc
+constexpr u8 kExecTraceInterrupt = 1;    // interrupt accepted; pc is the return address
+constexpr u8 kExecTraceFrame = 2;        // frame boundary; cycle holds the frame number
+
+// One trace entry as the CPU captures it. Registers are sampled before the
+// instruction runs; R and the alternate set are not recorded.
+struct ExecTraceRecord {
+  u64 cycle = 0;
+  u16 pc = 0;
+  u16 af = 0;
+  u16 bc = 0;
+  u16 de = 0;
+  u16 hl = 0;
+  u16 ix = 0;
+  u16 iy = 0;
+  u16 sp = 0;
+  std::array<u8, kMaxInstructionLength> opcode{};
+  u8 i = 0;
+  u8 flags = 0;  // bit 0 IFF1, bit 1 IFF2, bits 2-3 IM
+  u8 kind = kExecTraceInstruction;
+  u8 reserved = 0;
+};
+
+// Delta coder shared by writer and reader. Each record costs a head byte,
+// a cycle delta and only the fields that changed. The PC is predicted from
+// the previous instruction's length, and opcode bytes (with their decoded
+// length) are cached per address, so straight-line code mostly stores the
+// registers that moved.
+class ExecTraceCodec {
+ public:
+  ExecTraceCodec();
+  void Reset();
+  void Encode(const ExecTraceRecord& record, std::vector<u8>& out);
+  bool Decode(const u8*& data, const u8* end, ExecTraceRecord& record);
+
+ private:
+  ExecTraceRecord prev_{};
+  u8 prev_length_ = 1;
+  std::vector<u32> opcode_cache_;
+  std::vector<u8> length_cache_;
+};
+
+// Trace file: header (magic "SZXT", u16 version, u16 reserved), then chunks
+// of u32 raw size, u32 compressed size and an LZ-compressed run of encoded
+// records. Each chunk starts from a reset coder, so chunks decode
+// independently.
+constexpr u32 kExecTraceMagic = 0x54585A53u;  // "SZXT"
+constexpr u16 kExecTraceVersion = 1;
+
+// The CPU appends records on the emulation thread; full blocks go to a small
+// pool of worker threads that encode and compress them in parallel and
+// write them back in order. When every block is in flight the emulation
+// thread waits rather than losing records.
+class ExecTraceWriter : private sz::util::NonCopyable {
+ public:
+  ExecTraceWriter() = default;
+  ~ExecTraceWriter();
+
+  bool Open(const std::string& path);
+  void Close();
+  bool IsOpen() const { return file_ != nullptr; }
+
+  ExecTraceRecord& Append() {
+    if (fill_ == block_->size()) {
+      SubmitBlock();
+    }
+    return (*block_)[fill_++];
+  }
+  void MarkFrame(u64 frame);
+
+ private:
+  using Block = std::vector<ExecTraceRecord>;
+  struct PendingBlock {
+    std::unique_ptr<Block> block;
+    size_t count = 0;
+    u64 sequence = 0;
+  };
+
+  void SubmitBlock();
+  void WorkerLoop();
+
+  std::FILE* file_ = nullptr;
+  std::unique_ptr<Block> block_;
+  size_t fill_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<PendingBlock> full_;
+  std::vector<std::unique_ptr<Block>> free_;
+  u64 next_sequence_ = 0;
+  u64 next_write_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+  u64 records_written_ = 0;
+  u64 bytes_written_ = 0;
+};
+
+class ExecTraceReader : private sz::util::NonCopyable {
+ public:
+  ExecTraceReader() = default;
+  ~ExecTraceReader();
+
+  bool Open(const std::string& path);
+  // False at end of file or on a corrupt chunk (see Ok()).
+  bool Next(ExecTraceRecord& record);
+  bool Ok() const { return ok_; }
+
+ private:
+  bool LoadChunk();
+
+  std::FILE* file_ = nullptr;
+  ExecTraceCodec codec_;
+  std::vector<u8> chunk_;
+  std::vector<u8> compressed_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace sz::cpu
+
+#endif
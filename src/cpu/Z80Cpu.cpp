@@ -0,0 +1,1212 @@
+#include "cpu/Z80Cpu.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "core/log/Trace.h"
+#include "core/util/Assert.h"
+#include "cpu/ExecTrace.h"
+
+namespace sz::cpu {
+
+namespace {
+constexpr u8 kFlagC = 0x01;
+constexpr u8 kFlagN = 0x02;
+constexpr u8 kFlagPV = 0x04;
+constexpr u8 kFlagX = 0x08;
+constexpr u8 kFlagH = 0x10;
+constexpr u8 kFlagY = 0x20;
+constexpr u8 kFlagZ = 0x40;
+constexpr u8 kFlagS = 0x80;
+
+constexpr std::array<u8, 256> MakeSz53pTable() {
+  std::array<u8, 256> table{};
+  for (int i = 0; i < 256; ++i) {
+    u8 flags = static_cast<u8>(i & (kFlagS | kFlagY | kFlagX));
+    if (i == 0) {
+      flags |= kFlagZ;
+    }
+    int bits = 0;
+    for (int b = 0; b < 8; ++b) {
+      bits += (i >> b) & 1;
+    }
+    if ((bits & 1) == 0) {
+      flags |= kFlagPV;
+    }
+    table[static_cast<size_t>(i)] = flags;
+  }
+  return table;
+}
+
+// S, Z, Y, X and parity for every byte value.
+constexpr std::array<u8, 256> kSz53p = MakeSz53pTable();
+
+constexpr u8 Sz53(u8 value) {
+  return static_cast<u8>(kSz53p[value] & ~kFlagPV);
+}
+
+constexpr u8 kInterruptModes[8] = {0, 0, 1, 2, 0, 0, 1, 2};
+}  // namespace
+
+void BreakpointList::Add(u16 pc) {
+  if (!Contains(pc)) {
+    breakpoints_.push_back(pc);
+    pages_.set(pc >> 8);
+  }
+}
+
+void BreakpointList::Remove(u16 pc) {
+  std::erase(breakpoints_, pc);
+  pages_.reset();
+  for (const u16 address : breakpoints_) {
+    pages_.set(address >> 8);
+  }
+}
+
+void BreakpointList::Clear() {
+  breakpoints_.clear();
+  pages_.reset();
+}
+
+bool BreakpointList::Contains(u16 pc) const {
+  return pages_[pc >> 8] && std::find(breakpoints_.begin(), breakpoints_.end(), pc) != breakpoints_.end();
+}
+
+void Z80Cpu::AttachBus(sz::bus::Bus* bus) {
+  bus_ = bus;
+}
+
+void Z80Cpu::AttachBreakpoints(const BreakpointList* breakpoints) {
+  breakpoints_ = breakpoints;
+}
+
+void Z80Cpu::Reset() {
+  regs_ = Registers{};
+  last_budget_ = 0;
+  tstate_debt_ = 0;
+  tstates_ = 0;
+  ei_shadow_ = false;
+  stopped_ = false;
+  UpdateIrqCheck();
+}
+
+template <bool kHooks>
+void Z80Cpu::Step(int tstates_budget) {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryCpu, "cpu_step");
+  SZ_ASSERT(bus_ != nullptr);
+  last_budget_ = tstates_budget;
+  // Resuming after a stop: the instruction at PC is the one that hit, so it
+  // runs without checking its breakpoint again. Only the kHooks core stops,
+  // and the console resumes with the same core.
+  bool resuming = false;
+  if constexpr (kHooks) {
+    resuming = std::exchange(stopped_, false);
+  }
+
+  // Instructions are atomic, so an overshoot is paid back from this budget.
+  int executed = tstate_debt_;
+  const int start = executed;
+  while (executed < tstates_budget) {
+    if constexpr (kHooks) {
+      if (CheckStop(resuming)) {
+        break;
+      }
+      resuming = false;
+    }
+    if (irq_check_) {
+      if (ei_shadow_) {
+        // The instruction after EI always runs before an interrupt is taken.
+        ei_shadow_ = false;
+        if (exec_trace_) {
+          RecordTrace(kExecTraceInstruction, executed - start);
+        }
+        executed += ExecuteInstruction<kHooks>();
+        UpdateIrqCheck();
+        continue;
+      }
+      if (int_line_ && regs_.iff1) {
+        if (exec_trace_) {
+          RecordTrace(kExecTraceInterrupt, executed - start);
+        }
+        executed += AcceptInterrupt<kHooks>();
+        continue;
+      }
+      if (regs_.halted) {
+        // HALT executes NOPs until an interrupt; skip straight to the budget.
+        const int nops = (tstates_budget - executed + 3) / 4;
+        regs_.r = static_cast<u8>((regs_.r & 0x80) | ((regs_.r + nops) & 0x7F));
+        executed += nops * 4;
+        continue;
+      }
+      if (exec_trace_) {
+        RecordTrace(kExecTraceInstruction, executed - start);
+      }
+    }
+    executed += ExecuteInstruction<kHooks>();
+  }
+
+  tstates_ += static_cast<u64>(executed - start);
+  tstate_debt_ = executed - tstates_budget;
+  if constexpr (kHooks) {
+    // A watchpoint hit by the line's last instruction still stops here.
+    if (!stopped_ && bus_->HasWatchHit()) {
+      CheckStop(false);
+    }
+    // While stopped, the debt holds the T-states this line has already
+    // run, so calling Step again with the same budget picks up from there.
+    if (stopped_) {
+      tstate_debt_ = executed;
+    }
+  }
+}
+
+template void Z80Cpu::Step<false>(int tstates_budget);
+template void Z80Cpu::Step<true>(int tstates_budget);
+
+bool Z80Cpu::CheckStop(bool resuming) {
+  sz::bus::WatchHit hit;
+  if (bus_->TakeWatchHit(hit)) {
+    stop_ = StopInfo{};
+    stop_.watchpoint = true;
+    stop_.hit = hit;
+  } else if (!resuming && !regs_.halted && breakpoints_->Contains(regs_.pc)) {
+    stop_ = StopInfo{};
+  } else {
+    return false;
+  }
+  stop_.pc = regs_.pc;
+  stopped_ = true;
+  SZ_TRACE(sz::trace::kCategoryCpu, "debug_stop", regs_.pc, stop_.watchpoint);
+  return true;
+}
+
+bool Z80Cpu::IsStopped() const {
+  return stopped_;
+}
+
+StopInfo Z80Cpu::GetStopInfo() const {
+  return stop_;
+}
+
+void Z80Cpu::SetIntLine(bool asserted) {
+  int_line_ = asserted;
+  UpdateIrqCheck();
+}
+
+void Z80Cpu::SetExecTrace(ExecTraceWriter* writer) {
+  exec_trace_ = writer;
+  UpdateIrqCheck();
+}
+
+DebugState Z80Cpu::GetDebugState() const {
+  DebugState state;
+  state.last_budget = last_budget_;
+  state.regs = regs_;
+  state.tstates = tstates_;
+  state.int_line = int_line_;
+  state.ei_shadow = ei_shadow_;
+  return state;
+}
+
+void Z80Cpu::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteU16(regs_.af);
+  writer.WriteU16(regs_.bc);
+  writer.WriteU16(regs_.de);
+  writer.WriteU16(regs_.hl);
+  writer.WriteU16(regs_.af_alt);
+  writer.WriteU16(regs_.bc_alt);
+  writer.WriteU16(regs_.de_alt);
+  writer.WriteU16(regs_.hl_alt);
+  writer.WriteU16(regs_.ix);
+  writer.WriteU16(regs_.iy);
+  writer.WriteU16(regs_.sp);
+  writer.WriteU16(regs_.pc);
+  writer.WriteU8(regs_.i);
+  writer.WriteU8(regs_.r);
+  writer.WriteU8(regs_.im);
+  writer.WriteBool(regs_.iff1);
+  writer.WriteBool(regs_.iff2);
+  writer.WriteBool(regs_.halted);
+  writer.WriteBool(ei_shadow_);
+  writer.WriteS32(last_budget_);
+  writer.WriteS32(tstate_debt_);
+  writer.WriteU64(tstates_);
+}
+
+void Z80Cpu::LoadState(sz::state::StateReader& reader) {
+  regs_.af = reader.ReadU16();
+  regs_.bc = reader.ReadU16();
+  regs_.de = reader.ReadU16();
+  regs_.hl = reader.ReadU16();
+  regs_.af_alt = reader.ReadU16();
+  regs_.bc_alt = reader.ReadU16();
+  regs_.de_alt = reader.ReadU16();
+  regs_.hl_alt = reader.ReadU16();
+  regs_.ix = reader.ReadU16();
+  regs_.iy = reader.ReadU16();
+  regs_.sp = reader.ReadU16();
+  regs_.pc = reader.ReadU16();
+  regs_.i = reader.ReadU8();
+  regs_.r = reader.ReadU8();
+  regs_.im = reader.ReadU8();
+  regs_.iff1 = reader.ReadBool();
+  regs_.iff2 = reader.ReadBool();
+  regs_.halted = reader.ReadBool();
+  ei_shadow_ = reader.ReadBool();
+  last_budget_ = reader.ReadS32();
+  tstate_debt_ = reader.ReadS32();
+  tstates_ = reader.ReadU64();
+  reader.Expect(regs_.im <= 2 && tstate_debt_ >= 0);
+  stopped_ = false;
+  // int_line_ is restored by the IRQ controller, which loads after the CPU.
+  UpdateIrqCheck();
+}
+
+void Z80Cpu::UpdateIrqCheck() {
+  irq_check_ = ei_shadow_ || regs_.halted || (int_line_ && regs_.iff1) || exec_trace_ != nullptr;
+}
+
+void Z80Cpu::RecordTrace(u8 kind, int elapsed) {
+  ExecTraceRecord& record = exec_trace_->Append();
+  record.cycle = tstates_ + static_cast<u64>(elapsed);
+  record.pc = regs_.pc;
+  record.af = regs_.af;
+  record.bc = regs_.bc;
+  record.de = regs_.de;
+  record.hl = regs_.hl;
+  record.ix = regs_.ix;
+  record.iy = regs_.iy;
+  record.sp = regs_.sp;
+  // Memory reads have no side effects, so peeking ahead is safe; the plain
+  // accessor keeps the peek from tripping read watchpoints.
+  for (size_t i = 0; i < record.opcode.size(); ++i) {
+    record.opcode[i] = Read8<false>(static_cast<u16>(regs_.pc + i));
+  }
+  record.i = regs_.i;
+  record.flags = static_cast<u8>((regs_.iff1 ? 0x01 : 0) | (regs_.iff2 ? 0x02 : 0) | (regs_.im << 2));
+  record.kind = kind;
+  record.reserved = 0;
+}
+
+template <bool kHooks>
+int Z80Cpu::AcceptInterrupt() {
+  regs_.halted = false;
+  regs_.iff1 = false;
+  regs_.iff2 = false;
+  regs_.r = static_cast<u8>((regs_.r & 0x80) | ((regs_.r + 1) & 0x7F));
+  SZ_TRACE(sz::trace::kCategoryCpu, "int_accept", regs_.pc, regs_.im);
+  Push<kHooks>(regs_.pc);
+
+  int tstates = 13;
+  if (regs_.im == 2) {
+    // No device drives the data bus during acknowledge; it floats to 0xFF.
+    regs_.pc = Read16<kHooks>(static_cast<u16>((regs_.i << 8) | 0xFF));
+    tstates = 19;
+  } else {
+    // IM 1 vectors to 0x0038; IM 0 executes the floating 0xFF, RST 38h.
+    regs_.pc = 0x0038;
+  }
+  UpdateIrqCheck();
+  return tstates;
+}
+
+template <bool kHooks>
+u16 Z80Cpu::Read16(u16 addr) {
+  const u8 lo = Read8<kHooks>(addr);
+  const u8 hi = Read8<kHooks>(static_cast<u16>(addr + 1));
+  return static_cast<u16>(lo | (hi << 8));
+}
+
+template <bool kHooks>
+void Z80Cpu::Write16(u16 addr, u16 value) {
+  Write8<kHooks>(addr, static_cast<u8>(value));
+  Write8<kHooks>(static_cast<u16>(addr + 1), static_cast<u8>(value >> 8));
+}
+
+// Fetches skip the watch hooks: a Read watchpoint reports data reads only,
+// and execution is what PC breakpoints are for.
+u8 Z80Cpu::FetchOpcode() {
+  regs_.r = static_cast<u8>((regs_.r & 0x80) | ((regs_.r + 1) & 0x7F));
+  return Read8<false>(regs_.pc++);
+}
+
+u8 Z80Cpu::Fetch8() {
+  return Read8<false>(regs_.pc++);
+}
+
+u16 Z80Cpu::Fetch16() {
+  const u16 value = Read16<false>(regs_.pc);
+  regs_.pc = static_cast<u16>(regs_.pc + 2);
+  return value;
+}
+
+template <bool kHooks>
+void Z80Cpu::Push(u16 value) {
+  --regs_.sp;
+  Write8<kHooks>(regs_.sp, static_cast<u8>(value >> 8));
+  --regs_.sp;
+  Write8<kHooks>(regs_.sp, static_cast<u8>(value));
+}
+
+template <bool kHooks>
+u16 Z80Cpu::Pop() {
+  const u16 value = Read16<kHooks>(regs_.sp);
+  regs_.sp = static_cast<u16>(regs_.sp + 2);
+  return value;
+}
+
+u8 Z80Cpu::GetReg8(int index, const u16& hl) const {
+  switch (index) {
+    case 0:
+      return static_cast<u8>(regs_.bc >> 8);
+    case 1:
+      return static_cast<u8>(regs_.bc);
+    case 2:
+      return static_cast<u8>(regs_.de >> 8);
+    case 3:
+      return static_cast<u8>(regs_.de);
+    case 4:
+      return static_cast<u8>(hl >> 8);
+    case 5:
+      return static_cast<u8>(hl);
+    default:
+      return A();
+  }
+}
+
+void Z80Cpu::SetReg8(int index, u8 value, u16& hl) {
+  switch (index) {
+    case 0:
+      regs_.bc = static_cast<u16>((regs_.bc & 0x00FF) | (value << 8));
+      break;
+    case 1:
+      regs_.bc = static_cast<u16>((regs_.bc & 0xFF00) | value);
+      break;
+    case 2:
+      regs_.de = static_cast<u16>((regs_.de & 0x00FF) | (value << 8));
+      break;
+    case 3:
+      regs_.de = static_cast<u16>((regs_.de & 0xFF00) | value);
+      break;
+    case 4:
+      hl = static_cast<u16>((hl & 0x00FF) | (value << 8));
+      break;
+    case 5:
+      hl = static_cast<u16>((hl & 0xFF00) | value);
+      break;
+    default:
+      SetA(value);
+      break;
+  }
+}
+
+u16& Z80Cpu::RegPair(int index, u16& hl) {
+  switch (index) {
+    case 0:
+      return regs_.bc;
+    case 1:
+      return regs_.de;
+    case 2:
+      return hl;
+    default:
+      return regs_.sp;
+  }
+}
+
+u16& Z80Cpu::RegPair2(int index, u16& hl) {
+  return index == 3 ? regs_.af : RegPair(index, hl);
+}
+
+bool Z80Cpu::Condition(int index) const {
+  const u8 f = F();
+  switch (index) {
+    case 0:
+      return (f & kFlagZ) == 0;
+    case 1:
+      return (f & kFlagZ) != 0;
+    case 2:
+      return (f & kFlagC) == 0;
+    case 3:
+      return (f & kFlagC) != 0;
+    case 4:
+      return (f & kFlagPV) == 0;
+    case 5:
+      return (f & kFlagPV) != 0;
+    case 6:
+      return (f & kFlagS) == 0;
+    default:
+      return (f & kFlagS) != 0;
+  }
+}
+
+template <bool kHooks>
+u16 Z80Cpu::IndexedAddress(u16 index) {
+  const s8 displacement = static_cast<s8>(Fetch8());
+  return static_cast<u16>(index + displacement);
+}
+
+void Z80Cpu::Alu(int op, u8 value) {
+  const u8 a = A();
+  switch (op) {
+    case 0:    // ADD
+    case 1: {  // ADC
+      const int carry = (op == 1 && (F() & kFlagC)) ? 1 : 0;
+      const int result = a + value + carry;
+      const u8 r = static_cast<u8>(result);
+      u8 f = static_cast<u8>(Sz53(r) | ((a ^ value ^ r) & kFlagH));
+      if (((a ^ ~value) & (a ^ r)) & 0x80) {
+        f |= kFlagPV;
+      }
+      if (result > 0xFF) {
+        f |= kFlagC;
+      }
+      SetA(r);
+      SetF(f);
+      break;
+    }
+    case 2:    // SUB
+    case 3:    // SBC
+    case 7: {  // CP
+      const int carry = (op == 3 && (F() & kFlagC)) ? 1 : 0;
+      const int result = a - value - carry;
+      const u8 r = static_cast<u8>(result);
+      u8 f = static_cast<u8>((kSz53p[r] & (kFlagS | kFlagZ)) | kFlagN | ((a ^ value ^ r) & kFlagH));
+      if (((a ^ value) & (a ^ r)) & 0x80) {
+        f |= kFlagPV;
+      }
+      if (result < 0) {
+        f |= kFlagC;
+      }
+      if (op == 7) {
+        // CP takes the undocumented X/Y bits from the operand.
+        SetF(static_cast<u8>(f | (value & (kFlagX | kFlagY))));
+      } else {
+        SetA(r);
+        SetF(static_cast<u8>(f | (r & (kFlagX | kFlagY))));
+      }
+      break;
+    }
+    case 4: {  // AND
+      const u8 r = static_cast<u8>(a & value);
+      SetA(r);
+      SetF(static_cast<u8>(kSz53p[r] | kFlagH));
+      break;
+    }
+    case 5: {  // XOR
+      const u8 r = static_cast<u8>(a ^ value);
+      SetA(r);
+      SetF(kSz53p[r]);
+      break;
+    }
+    default: {  // OR
+      const u8 r = static_cast<u8>(a | value);
+      SetA(r);
+      SetF(kSz53p[r]);
+      break;
+    }
+  }
+}
+
+u8 Z80Cpu::Inc8(u8 value) {
+  const u8 r = static_cast<u8>(value + 1);
+  u8 f = static_cast<u8>((F() & kFlagC) | Sz53(r));
+  if ((value & 0x0F) == 0x0F) {
+    f |= kFlagH;
+  }
+  if (value == 0x7F) {
+    f |= kFlagPV;
+  }
+  SetF(f);
+  return r;
+}
+
+u8 Z80Cpu::Dec8(u8 value) {
+  const u8 r = static_cast<u8>(value - 1);
+  u8 f = static_cast<u8>((F() & kFlagC) | Sz53(r) | kFlagN);
+  if ((value & 0x0F) == 0) {
+    f |= kFlagH;
+  }
+  if (value == 0x80) {
+    f |= kFlagPV;
+  }
+  SetF(f);
+  return r;
+}
+
+u16 Z80Cpu::Add16(u16 a, u16 b) {
+  const u32 result = static_cast<u32>(a) + b;
+  u8 f = static_cast<u8>((F() & (kFlagS | kFlagZ | kFlagPV)) | ((result >> 8) & (kFlagX | kFlagY)) |
+                         (((a ^ b ^ result) >> 8) & kFlagH));
+  if (result > 0xFFFF) {
+    f |= kFlagC;
+  }
+  SetF(f);
+  return static_cast<u16>(result);
+}
+
+u16 Z80Cpu::Adc16(u16 a, u16 b) {
+  const u32 result = static_cast<u32>(a) + b + (F() & kFlagC);
+  const u16 r = static_cast<u16>(result);
+  u8 f = static_cast<u8>(((r >> 8) & (kFlagS | kFlagX | kFlagY)) | (((a ^ b ^ r) >> 8) & kFlagH));
+  if (r == 0) {
+    f |= kFlagZ;
+  }
+  if ((~(a ^ b) & (a ^ r)) & 0x8000) {
+    f |= kFlagPV;
+  }
+  if (result > 0xFFFF) {
+    f |= kFlagC;
+  }
+  SetF(f);
+  return r;
+}
+
+u16 Z80Cpu::Sbc16(u16 a, u16 b) {
+  const int result = static_cast<int>(a) - b - (F() & kFlagC);
+  const u16 r = static_cast<u16>(result);
+  u8 f = static_cast<u8>(((r >> 8) & (kFlagS | kFlagX | kFlagY)) | (((a ^ b ^ r) >> 8) & kFlagH) |
+                         kFlagN);
+  if (r == 0) {
+    f |= kFlagZ;
+  }
+  if (((a ^ b) & (a ^ r)) & 0x8000) {
+    f |= kFlagPV;
+  }
+  if (result < 0) {
+    f |= kFlagC;
+  }
+  SetF(f);
+  return r;
+}
+
+u8 Z80Cpu::Rotate(int op, u8 value) {
+  const u8 carry_in = F() & kFlagC;
+  u8 carry = 0;
+  u8 r = 0;
+  switch (op) {
+    case 0:  // RLC
+      carry = value >> 7;
+      r = static_cast<u8>((value << 1) | carry);
+      break;
+    case 1:  // RRC
+      carry = value & 1;
+      r = static_cast<u8>((value >> 1) | (carry << 7));
+      break;
+    case 2:  // RL
+      carry = value >> 7;
+      r = static_cast<u8>((value << 1) | carry_in);
+      break;
+    case 3:  // RR
+      carry = value & 1;
+      r = static_cast<u8>((value >> 1) | (carry_in << 7));
+      break;
+    case 4:  // SLA
+      carry = value >> 7;
+      r = static_cast<u8>(value << 1);
+      break;
+    case 5:  // SRA
+      carry = value & 1;
+      r = static_cast<u8>((value >> 1) | (value & 0x80));
+      break;
+    case 6:  // SLL (undocumented)
+      carry = value >> 7;
+      r = static_cast<u8>((value << 1) | 1);
+      break;
+    default:  // SRL
+      carry = value & 1;
+      r = static_cast<u8>(value >> 1);
+      break;
+  }
+  SetF(static_cast<u8>(kSz53p[r] | carry));
+  return r;
+}
+
+void Z80Cpu::Bit(int bit, u8 value, u8 xy_source) {
+  u8 f = static_cast<u8>((F() & kFlagC) | kFlagH | (xy_source & (kFlagX | kFlagY)));
+  if ((value & (1 << bit)) == 0) {
+    f |= kFlagZ | kFlagPV;
+  } else if (bit == 7) {
+    f |= kFlagS;
+  }
+  SetF(f);
+}
+
+void Z80Cpu::Daa() {
+  const u8 a = A();
+  const u8 f = F();
+  u8 diff = 0;
+  bool carry = (f & kFlagC) != 0;
+  if ((f & kFlagH) || (a & 0x0F) > 9) {
+    diff |= 0x06;
+  }
+  if (carry || a > 0x99) {
+    diff |= 0x60;
+    carry = true;
+  }
+
+  const bool subtract = (f & kFlagN) != 0;
+  const u8 r = static_cast<u8>(subtract ? a - diff : a + diff);
+  u8 half = 0;
+  if (subtract) {
+    half = ((f & kFlagH) && (a & 0x0F) < 6) ? kFlagH : 0;
+  } else {
+    half = (a & 0x0F) > 9 ? kFlagH : 0;
+  }
+  SetA(r);
+  SetF(static_cast<u8>(kSz53p[r] | half | (f & kFlagN) | (carry ? kFlagC : 0)));
+}
+
+template <bool kHooks>
+int Z80Cpu::BlockInstruction(int y, int z) {
+  const bool repeat = y >= 6;
+  const u16 step = (y & 1) ? 0xFFFF : 1;  // odd y: decrementing variants
+
+  switch (z) {
+    case 0: {  // LDI, LDD, LDIR, LDDR
+      const u8 value = Read8<kHooks>(regs_.hl);
+      Write8<kHooks>(regs_.de, value);
+      regs_.hl = static_cast<u16>(regs_.hl + step);
+      regs_.de = static_cast<u16>(regs_.de + step);
+      --regs_.bc;
+      const u8 n = static_cast<u8>(value + A());
+      SetF(static_cast<u8>((F() & (kFlagS | kFlagZ | kFlagC)) | (n & kFlagX) | ((n << 4) & kFlagY) |
+                           (regs_.bc != 0 ? kFlagPV : 0)));
+      if (repeat && regs_.bc != 0) {
+        regs_.pc = static_cast<u16>(regs_.pc - 2);
+        return 21;
+      }
+      return 16;
+    }
+    case 1: {  // CPI, CPD, CPIR, CPDR
+      const u8 value = Read8<kHooks>(regs_.hl);
+      const u8 a = A();
+      const u8 r = static_cast<u8>(a - value);
+      regs_.hl = static_cast<u16>(regs_.hl + step);
+      --regs_.bc;
+      u8 f = static_cast<u8>((F() & kFlagC) | kFlagN | (kSz53p[r] & (kFlagS | kFlagZ)) |
+                             ((a ^ value ^ r) & kFlagH) | (regs_.bc != 0 ? kFlagPV : 0));
+      const u8 n = static_cast<u8>(r - ((f & kFlagH) ? 1 : 0));
+      f |= static_cast<u8>((n & kFlagX) | ((n << 4) & kFlagY));
+      SetF(f);
+      if (repeat && regs_.bc != 0 && r != 0) {
+        regs_.pc = static_cast<u16>(regs_.pc - 2);
+        return 21;
+      }
+      return 16;
+    }
+    default: {  // INI/IND/INIR/INDR (z == 2), OUTI/OUTD/OTIR/OTDR (z == 3)
+      const u8 port = static_cast<u8>(regs_.bc);
+      u8 value = 0;
+      unsigned k = 0;
+      const u8 b = static_cast<u8>((regs_.bc >> 8) - 1);
+      regs_.bc = static_cast<u16>((regs_.bc & 0x00FF) | (b << 8));
+      if (z == 2) {
+        value = bus_->In8<kHooks>(port);
+        Write8<kHooks>(regs_.hl, value);
+        regs_.hl = static_cast<u16>(regs_.hl + step);
+        k = value + static_cast<u8>(port + step);
+      } else {
+        value = Read8<kHooks>(regs_.hl);
+        bus_->Out8<kHooks>(port, value);
+        regs_.hl = static_cast<u16>(regs_.hl + step);
+        k = value + static_cast<u8>(regs_.hl);
+      }
+      u8 f = static_cast<u8>(Sz53(b) | (kSz53p[(k & 7) ^ b] & kFlagPV));
+      if (value & 0x80) {
+        f |= kFlagN;
+      }
+      if (k > 0xFF) {
+        f |= kFlagH | kFlagC;
+      }
+      SetF(f);
+      if (repeat && b != 0) {
+        regs_.pc = static_cast<u16>(regs_.pc - 2);
+        return 21;
+      }
+      return 16;
+    }
+  }
+}
+
+template <bool kHooks>
+int Z80Cpu::ExecuteInstruction() {
+  const u8 op = FetchOpcode();
+  switch (op) {
+    case 0xCB:
+      return ExecuteCB<kHooks>();
+    case 0xDD:
+      return ExecuteIndexed<kHooks>(regs_.ix);
+    case 0xED:
+      return ExecuteED<kHooks>();
+    case 0xFD:
+      return ExecuteIndexed<kHooks>(regs_.iy);
+    default:
+      return ExecuteMain<kHooks>(op, regs_.hl, false);
+  }
+}
+
+template <bool kHooks>
+int Z80Cpu::ExecuteIndexed(u16& index) {
+  const u8 op = FetchOpcode();
+  switch (op) {
+    case 0xCB:
+      return 4 + ExecuteIndexedCB<kHooks>(index);
+    case 0xDD:
+    case 0xED:
+    case 0xFD:
+      // A second prefix restarts decoding; the first one acted as a NOP.
+      --regs_.pc;
+      regs_.r = static_cast<u8>((regs_.r & 0x80) | ((regs_.r - 1) & 0x7F));
+      return 4;
+    default:
+      return 4 + ExecuteMain<kHooks>(op, index, true);
+  }
+}
+
+// Unprefixed and DD/FD opcodes. `hl` is HL, IX or IY; with `indexed` set,
+// (HL) operands become (index+d). Returned T-states exclude the prefix.
+template <bool kHooks>
+int Z80Cpu::ExecuteMain(u8 op, u16& hl, bool indexed) {
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const int p = y >> 1;
+  const int q = y & 1;
+
+  switch (x) {
+    case 0:
+      switch (z) {
+        case 0:
+          switch (y) {
+            case 0:  // NOP
+              return 4;
+            case 1:  // EX AF,AF'
+              std::swap(regs_.af, regs_.af_alt);
+              return 4;
+            case 2: {  // DJNZ d
+              const s8 d = static_cast<s8>(Fetch8());
+              const u8 b = static_cast<u8>((regs_.bc >> 8) - 1);
+              regs_.bc = static_cast<u16>((regs_.bc & 0x00FF) | (b << 8));
+              if (b != 0) {
+                regs_.pc = static_cast<u16>(regs_.pc + d);
+                return 13;
+              }
+              return 8;
+            }
+            case 3: {  // JR d
+              const s8 d = static_cast<s8>(Fetch8());
+              regs_.pc = static_cast<u16>(regs_.pc + d);
+              return 12;
+            }
+            default: {  // JR cc,d
+              const s8 d = static_cast<s8>(Fetch8());
+              if (Condition(y - 4)) {
+                regs_.pc = static_cast<u16>(regs_.pc + d);
+                return 12;
+              }
+              return 7;
+            }
+          }
+        case 1:
+          if (q == 0) {  // LD rp,nn
+            RegPair(p, hl) = Fetch16();
+            return 10;
+          }
+          hl = Add16(hl, RegPair(p, hl));  // ADD HL,rp
+          return 11;
+        case 2:
+          switch (y) {
+            case 0:
+              Write8<kHooks>(regs_.bc, A());
+              return 7;
+            case 1:
+              SetA(Read8<kHooks>(regs_.bc));
+              return 7;
+            case 2:
+              Write8<kHooks>(regs_.de, A());
+              return 7;
+            case 3:
+              SetA(Read8<kHooks>(regs_.de));
+              return 7;
+            case 4:
+              Write16<kHooks>(Fetch16(), hl);
+              return 16;
+            case 5:
+              hl = Read16<kHooks>(Fetch16());
+              return 16;
+            case 6:
+              Write8<kHooks>(Fetch16(), A());
+              return 13;
+            default:
+              SetA(Read8<kHooks>(Fetch16()));
+              return 13;
+          }
+        case 3:
+          if (q == 0) {
+            ++RegPair(p, hl);
+          } else {
+            --RegPair(p, hl);
+          }
+          return 6;
+        case 4:
+          if (y == 6) {
+            const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+            Write8<kHooks>(addr, Inc8(Read8<kHooks>(addr)));
+            return indexed ? 19 : 11;
+          }
+          SetReg8(y, Inc8(GetReg8(y, hl)), hl);
+          return 4;
+        case 5:
+          if (y == 6) {
+            const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+            Write8<kHooks>(addr, Dec8(Read8<kHooks>(addr)));
+            return indexed ? 19 : 11;
+          }
+          SetReg8(y, Dec8(GetReg8(y, hl)), hl);
+          return 4;
+        case 6:
+          if (y == 6) {
+            const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+            Write8<kHooks>(addr, Fetch8());
+            return indexed ? 15 : 10;
+          }
+          SetReg8(y, Fetch8(), hl);
+          return 7;
+        default:
+          switch (y) {
+            case 0:
+            case 1:
+            case 2:
+            case 3: {  // RLCA, RRCA, RLA, RRA
+              const u8 preserved = F() & (kFlagS | kFlagZ | kFlagPV);
+              const u8 r = Rotate(y, A());
+              SetA(r);
+              SetF(static_cast<u8>(preserved | (r & (kFlagX | kFlagY)) | (F() & kFlagC)));
+              return 4;
+            }
+            case 4:
+              Daa();
+              return 4;
+            case 5: {  // CPL
+              const u8 r = static_cast<u8>(~A());
+              SetA(r);
+              SetF(static_cast<u8>((F() & (kFlagS | kFlagZ | kFlagPV | kFlagC)) | kFlagH | kFlagN |
+                                   (r & (kFlagX | kFlagY))));
+              return 4;
+            }
+            case 6:  // SCF
+              SetF(static_cast<u8>((F() & (kFlagS | kFlagZ | kFlagPV)) | (A() & (kFlagX | kFlagY)) |
+                                   kFlagC));
+              return 4;
+            default: {  // CCF
+              const u8 f = F();
+              SetF(static_cast<u8>((f & (kFlagS | kFlagZ | kFlagPV)) | (A() & (kFlagX | kFlagY)) |
+                                   ((f & kFlagC) ? kFlagH : kFlagC)));
+              return 4;
+            }
+          }
+      }
+    case 1:
+      if (op == 0x76) {  // HALT
+        regs_.halted = true;
+        UpdateIrqCheck();
+        return 4;
+      }
+      if (z == 6) {  // LD r,(HL) always targets the real H/L
+        const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+        SetReg8(y, Read8<kHooks>(addr), regs_.hl);
+        return indexed ? 15 : 7;
+      }
+      if (y == 6) {
+        const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+        Write8<kHooks>(addr, GetReg8(z, regs_.hl));
+        return indexed ? 15 : 7;
+      }
+      SetReg8(y, GetReg8(z, hl), hl);
+      return 4;
+    case 2:
+      if (z == 6) {
+        const u16 addr = indexed ? IndexedAddress<kHooks>(hl) : hl;
+        Alu(y, Read8<kHooks>(addr));
+        return indexed ? 15 : 7;
+      }
+      Alu(y, GetReg8(z, hl));
+      return 4;
+    default:
+      switch (z) {
+        case 0:  // RET cc
+          if (Condition(y)) {
+            regs_.pc = Pop<kHooks>();
+            return 11;
+          }
+          return 5;
+        case 1:
+          if (q == 0) {  // POP rp2
+            RegPair2(p, hl) = Pop<kHooks>();
+            return 10;
+          }
+          switch (p) {
+            case 0:  // RET
+              regs_.pc = Pop<kHooks>();
+              return 10;
+            case 1:  // EXX
+              std::swap(regs_.bc, regs_.bc_alt);
+              std::swap(regs_.de, regs_.de_alt);
+              std::swap(regs_.hl, regs_.hl_alt);
+              return 4;
+            case 2:  // JP (HL)
+              regs_.pc = hl;
+              return 4;
+            default:  // LD SP,HL
+              regs_.sp = hl;
+              return 6;
+          }
+        case 2: {  // JP cc,nn
+          const u16 target = Fetch16();
+          if (Condition(y)) {
+            regs_.pc = target;
+          }
+          return 10;
+        }
+        case 3:
+          switch (y) {
+            case 0:  // JP nn
+              regs_.pc = Fetch16();
+              return 10;
+            case 2:  // OUT (n),A
+              bus_->Out8<kHooks>(Fetch8(), A());
+              return 11;
+            case 3:  // IN A,(n)
+              SetA(bus_->In8<kHooks>(Fetch8()));
+              return 11;
+            case 4: {  // EX (SP),HL
+              const u16 value = Read16<kHooks>(regs_.sp);
+              Write16<kHooks>(regs_.sp, hl);
+              hl = value;
+              return 19;
+            }
+            case 5:  // EX DE,HL (never indexed)
+              std::swap(regs_.de, regs_.hl);
+              return 4;
+            case 6:  // DI
+              regs_.iff1 = false;
+              regs_.iff2 = false;
+              UpdateIrqCheck();
+              return 4;
+            case 7:  // EI
+              regs_.iff1 = true;
+              regs_.iff2 = true;
+              ei_shadow_ = true;
+              UpdateIrqCheck();
+              return 4;
+            default:  // CB is dispatched before reaching here
+              return 4;
+          }
+        case 4: {  // CALL cc,nn
+          const u16 target = Fetch16();
+          if (Condition(y)) {
+            Push<kHooks>(regs_.pc);
+            regs_.pc = target;
+            return 17;
+          }
+          return 10;
+        }
+        case 5:
+          if (q == 0) {  // PUSH rp2
+            Push<kHooks>(RegPair2(p, hl));
+            return 11;
+          }
+          if (p == 0) {  // CALL nn
+            const u16 target = Fetch16();
+            Push<kHooks>(regs_.pc);
+            regs_.pc = target;
+            return 17;
+          }
+          return 4;  // DD/ED/FD are dispatched before reaching here
+        case 6:  // ALU n
+          Alu(y, Fetch8());
+          return 7;
+        default:  // RST
+          Push<kHooks>(regs_.pc);
+          regs_.pc = static_cast<u16>(y * 8);
+          return 11;
+      }
+  }
+}
+
+template <bool kHooks>
+int Z80Cpu::ExecuteCB() {
+  const u8 op = FetchOpcode();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+
+  if (z == 6) {
+    const u16 addr = regs_.hl;
+    const u8 value = Read8<kHooks>(addr);
+    switch (x) {
+      case 0:
+        Write8<kHooks>(addr, Rotate(y, value));
+        return 15;
+      case 1:
+        // X/Y really come from the internal MEMPTR latch, which is not
+        // modelled; H is the closest observable approximation.
+        Bit(y, value, static_cast<u8>(addr >> 8));
+        return 12;
+      case 2:
+        Write8<kHooks>(addr, static_cast<u8>(value & ~(1 << y)));
+        return 15;
+      default:
+        Write8<kHooks>(addr, static_cast<u8>(value | (1 << y)));
+        return 15;
+    }
+  }
+
+  const u8 value = GetReg8(z, regs_.hl);
+  switch (x) {
+    case 0:
+      SetReg8(z, Rotate(y, value), regs_.hl);
+      break;
+    case 1:
+      Bit(y, value, value);
+      break;
+    case 2:
+      SetReg8(z, static_cast<u8>(value & ~(1 << y)), regs_.hl);
+      break;
+    default:
+      SetReg8(z, static_cast<u8>(value | (1 << y)), regs_.hl);
+      break;
+  }
+  return 8;
+}
+
+// DD CB d op / FD CB d op. The displacement precedes the opcode and the
+// opcode fetch is not an M1 cycle. Returned T-states exclude the prefix.
+template <bool kHooks>
+int Z80Cpu::ExecuteIndexedCB(u16 index) {
+  const u16 addr = IndexedAddress<kHooks>(index);
+  const u8 op = Fetch8();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const u8 value = Read8<kHooks>(addr);
+
+  if (x == 1) {
+    Bit(y, value, static_cast<u8>(addr >> 8));
+    return 16;
+  }
+
+  u8 result = 0;
+  switch (x) {
+    case 0:
+      result = Rotate(y, value);
+      break;
+    case 2:
+      result = static_cast<u8>(value & ~(1 << y));
+      break;
+    default:
+      result = static_cast<u8>(value | (1 << y));
+      break;
+  }
+  Write8<kHooks>(addr, result);
+  if (z != 6) {
+    SetReg8(z, result, regs_.hl);  // undocumented register copy
+  }
+  return 19;
+}
+
+template <bool kHooks>
+int Z80Cpu::ExecuteED() {
+  const u8 op = FetchOpcode();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const int p = y >> 1;
+  const int q = y & 1;
+
+  if (x == 2 && z <= 3 && y >= 4) {
+    return BlockInstruction<kHooks>(y, z);
+  }
+  if (x != 1) {
+    return 8;  // NONI
+  }
+
+  switch (z) {
+    case 0: {  // IN r,(C); y == 6 only sets flags
+      const u8 value = bus_->In8<kHooks>(static_cast<u8>(regs_.bc));
+      if (y != 6) {
+        SetReg8(y, value, regs_.hl);
+      }
+      SetF(static_cast<u8>((F() & kFlagC) | kSz53p[value]));
+      return 12;
+    }
+    case 1:  // OUT (C),r; y == 6 outputs 0
+      bus_->Out8<kHooks>(static_cast<u8>(regs_.bc), y == 6 ? 0 : GetReg8(y, regs_.hl));
+      return 12;
+    case 2:
+      if (q == 0) {
+        regs_.hl = Sbc16(regs_.hl, RegPair(p, regs_.hl));
+      } else {
+        regs_.hl = Adc16(regs_.hl, RegPair(p, regs_.hl));
+      }
+      return 15;
+    case 3: {
+      const u16 addr = Fetch16();
+      if (q == 0) {
+        Write16<kHooks>(addr, RegPair(p, regs_.hl));
+      } else {
+        RegPair(p, regs_.hl) = Read16<kHooks>(addr);
+      }
+      return 20;
+    }
+    case 4: {  // NEG
+      const u8 value = A();
+      SetA(0);
+      Alu(2, value);
+      return 8;
+    }
+    case 5:  // RETN / RETI
+      regs_.pc = Pop<kHooks>();
+      regs_.iff1 = regs_.iff2;
+      UpdateIrqCheck();
+      return 14;
+    case 6:
+      regs_.im = kInterruptModes[y];
+      return 8;
+    default:
+      switch (y) {
+        case 0:  // LD I,A
+          regs_.i = A();
+          return 9;
+        case 1:  // LD R,A
+          regs_.r = A();
+          return 9;
+        case 2:    // LD A,I
+        case 3: {  // LD A,R
+          const u8 value = y == 2 ? regs_.i : regs_.r;
+          SetA(value);
+          SetF(static_cast<u8>((F() & kFlagC) | Sz53(value) | (regs_.iff2 ? kFlagPV : 0)));
+          return 9;
+        }
+        case 4:    // RRD
+        case 5: {  // RLD
+          const u8 value = Read8<kHooks>(regs_.hl);
+          const u8 a = A();
+          if (y == 4) {
+            Write8<kHooks>(regs_.hl, static_cast<u8>((a << 4) | (value >> 4)));
+            SetA(static_cast<u8>((a & 0xF0) | (value & 0x0F)));
+          } else {
+            Write8<kHooks>(regs_.hl, static_cast<u8>((value << 4) | (a & 0x0F)));
+            SetA(static_cast<u8>((a & 0xF0) | (value >> 4)));
+          }
+          SetF(static_cast<u8>((F() & kFlagC) | kSz53p[A()]));
+          return 18;
+        }
+        default:
+          return 8;
+      }
+  }
+}
+
+}  // namespace sz::cpu
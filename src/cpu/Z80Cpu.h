@@ -0,0 +1,182 @@
+#ifndef SUPERZ80_CPU_Z80CPU_H
+#define SUPERZ80_CPU_Z80CPU_H
+
+#include <bitset>
+#include <vector>
+
+#include "core/state/SaveState.h"
+#include "core/types.h"
+#include "devices/bus/Bus.h"
+
+namespace sz::cpu {
+
+class ExecTraceWriter;
+
+struct Registers {
+  u16 af = 0xFFFF;
+  u16 bc = 0;
+  u16 de = 0;
+  u16 hl = 0;
+  u16 af_alt = 0;
+  u16 bc_alt = 0;
+  u16 de_alt = 0;
+  u16 hl_alt = 0;
+  u16 ix = 0;
+  u16 iy = 0;
+  u16 sp = 0xFFFF;
+  u16 pc = 0;
+  u8 i = 0;
+  u8 r = 0;
+  u8 im = 0;
+  bool iff1 = false;
+  bool iff2 = false;
+  bool halted = false;
+};
+
+struct DebugState {
+  int last_budget = 0;
+  Registers regs;
+  u64 tstates = 0;
+  bool int_line = false;
+  bool ei_shadow = false;
+};
+
+// Why the instrumented core stopped: an execution breakpoint at `pc`, or a
+// watchpoint hit by the instruction that ended just before `pc`.
+struct StopInfo {
+  bool watchpoint = false;
+  sz::bus::WatchHit hit{};  // watchpoints only
+  u16 pc = 0;
+};
+
+// Execution breakpoints, kept outside the CPU like sz::bus::WatchList. A
+// flag per 256-byte page keeps the list search off unflagged code.
+class BreakpointList {
+ public:
+  void Add(u16 pc);
+  void Remove(u16 pc);
+  void Clear();
+  bool IsEmpty() const { return breakpoints_.empty(); }
+  const std::vector<u16>& Get() const { return breakpoints_; }
+  bool Contains(u16 pc) const;
+
+ private:
+  std::bitset<256> pages_{};
+  std::vector<u16> breakpoints_{};
+};
+
+// Z80 interpreter. All memory and I/O goes through the Bus; the scheduler
+// decides how many T-states run per call.
+//
+// Interrupts: the /INT line is pushed in by the IRQ controller through
+// SetIntLine() on level changes only. The core folds line, IFF1 and the EI
+// shadow into one cached flag, so the per-instruction cost is a single
+// branch that is only taken around EI/DI/interrupt transitions.
+class Z80Cpu {
+ public:
+  // Set by the owner, again after every copy of the CPU.
+  void AttachBus(sz::bus::Bus* bus);
+  void AttachBreakpoints(const BreakpointList* breakpoints);
+  void Reset();
+  // Runs instructions until the budget is spent. The kHooks instantiation
+  // also checks breakpoints and watchpoints and may stop early, at an
+  // instruction boundary; IsStopped() is then true, and calling Step again
+  // with the same budget finishes the line. The plain instantiation is the
+  // interpreter with no debug checks at all.
+  template <bool kHooks = false>
+  void Step(int tstates_budget);
+  void SetIntLine(bool asserted);
+  // Records every instruction and accepted interrupt into `writer` (null
+  // stops). Tracing rides the interrupt slow path, so it costs nothing when
+  // off.
+  void SetExecTrace(ExecTraceWriter* writer);
+  DebugState GetDebugState() const;
+
+  bool IsStopped() const;
+  StopInfo GetStopInfo() const;
+
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
+ private:
+  // Everything that touches the bus is instantiated twice, with and without
+  // debug hooks (see Step).
+  template <bool kHooks>
+  int ExecuteInstruction();
+  template <bool kHooks>
+  int ExecuteMain(u8 op, u16& hl, bool indexed);
+  template <bool kHooks>
+  int ExecuteCB();
+  template <bool kHooks>
+  int ExecuteIndexedCB(u16 index);
+  template <bool kHooks>
+  int ExecuteED();
+  template <bool kHooks>
+  int ExecuteIndexed(u16& index);
+  template <bool kHooks>
+  int AcceptInterrupt();
+  void UpdateIrqCheck();
+  void RecordTrace(u8 kind, int elapsed);
+  bool CheckStop(bool resuming);
+
+  template <bool kHooks>
+  u8 Read8(u16 addr) { return bus_->Read8<kHooks>(addr); }
+  template <bool kHooks>
+  void Write8(u16 addr, u8 value) { bus_->Write8<kHooks>(addr, value); }
+  template <bool kHooks>
+  u16 Read16(u16 addr);
+  template <bool kHooks>
+  void Write16(u16 addr, u16 value);
+  u8 FetchOpcode();
+  u8 Fetch8();
+  u16 Fetch16();
+  template <bool kHooks>
+  void Push(u16 value);
+  template <bool kHooks>
+  u16 Pop();
+
+  u8 A() const { return static_cast<u8>(regs_.af >> 8); }
+  u8 F() const { return static_cast<u8>(regs_.af); }
+  void SetA(u8 value) { regs_.af = static_cast<u16>((regs_.af & 0x00FF) | (value << 8)); }
+  void SetF(u8 value) { regs_.af = static_cast<u16>((regs_.af & 0xFF00) | value); }
+  u8 GetReg8(int index, const u16& hl) const;
+  void SetReg8(int index, u8 value, u16& hl);
+  u16& RegPair(int index, u16& hl);
+  u16& RegPair2(int index, u16& hl);
+  bool Condition(int index) const;
+  template <bool kHooks>
+  u16 IndexedAddress(u16 index);
+
+  void Alu(int op, u8 value);
+  u8 Inc8(u8 value);
+  u8 Dec8(u8 value);
+  u16 Add16(u16 a, u16 b);
+  u16 Adc16(u16 a, u16 b);
+  u16 Sbc16(u16 a, u16 b);
+  u8 Rotate(int op, u8 value);
+  void Bit(int bit, u8 value, u8 xy_source);
+  void Daa();
+  template <bool kHooks>
+  int BlockInstruction(int y, int z);
+
+  sz::bus::Bus* bus_ = nullptr;
+  Registers regs_{};
+  int last_budget_ = 0;
+  int tstate_debt_ = 0;  // T-states the last instruction ran past the budget
+  u64 tstates_ = 0;
+
+  bool int_line_ = false;
+  bool ei_shadow_ = false;  // EI executed; interrupts held off one instruction
+  bool irq_check_ = false;  // ei_shadow_ || halted || (int_line_ && iff1) || exec_trace_
+
+  ExecTraceWriter* exec_trace_ = nullptr;
+
+  // Debugger state, read only by the kHooks instantiation.
+  const BreakpointList* breakpoints_ = nullptr;
+  StopInfo stop_{};
+  bool stopped_ = false;
+};
+
+}  // namespace sz::cpu
+
+#endif
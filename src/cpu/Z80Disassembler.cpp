@@ -0,0 +1,393 @@
+#include "cpu/Z80Disassembler.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace sz::cpu {
+
+namespace {
+constexpr const char* kReg8[8] = {"B", "C", "D", "E", "H", "L", "(HL)", "A"};
+constexpr const char* kRegPair[4] = {"BC", "DE", "HL", "SP"};
+constexpr const char* kRegPair2[4] = {"BC", "DE", "HL", "AF"};
+constexpr const char* kCondition[8] = {"NZ", "Z", "NC", "C", "PO", "PE", "P", "M"};
+constexpr const char* kAlu[8] = {"ADD A,", "ADC A,", "SUB ", "SBC A,", "AND ", "XOR ", "OR ", "CP "};
+constexpr const char* kRotate[8] = {"RLC", "RRC", "RL", "RR", "SLA", "SRA", "SLL", "SRL"};
+constexpr const char* kAccumulatorOps[8] = {"RLCA", "RRCA", "RLA", "RRA", "DAA", "CPL", "SCF", "CCF"};
+constexpr const char* kBlockOps[4][4] = {
+    {"LDI", "CPI", "INI", "OUTI"},
+    {"LDD", "CPD", "IND", "OUTD"},
+    {"LDIR", "CPIR", "INIR", "OTIR"},
+    {"LDDR", "CPDR", "INDR", "OTDR"},
+};
+constexpr const char* kInterruptModes[8] = {"0", "0/1", "1", "2", "0", "0/1", "1", "2"};
+
+// Walks the instruction bytes and, when given a buffer, formats operands in
+// byte order so displacements are consumed before immediates.
+class Decoder {
+ public:
+  Decoder(const u8* bytes, u16 pc, char* out, size_t size) : bytes_(bytes), pc_(pc), out_(out), size_(size) {
+    if (out_ && size_ > 0) {
+      out_[0] = '\0';
+    }
+  }
+
+  int Run();
+
+ private:
+  u8 Next() { return bytes_[length_++]; }
+
+  void Print(const char* fmt, ...) {
+    if (!out_ || used_ + 1 >= size_) {
+      return;
+    }
+    std::va_list args;
+    va_start(args, fmt);
+    const int written = std::vsnprintf(out_ + used_, size_ - used_, fmt, args);
+    va_end(args);
+    if (written > 0) {
+      used_ += static_cast<size_t>(written);
+      if (used_ >= size_) {
+        used_ = size_ - 1;
+      }
+    }
+  }
+
+  // 8-bit register operand; with an index prefix H/L/(HL) become
+  // IXH/IXL/(IX+d). `plain_hl` keeps H/L for the other operand of
+  // LD r,(IX+d) and LD (IX+d),r.
+  void Reg8(int index, bool plain_hl = false) {
+    if (index_ && index == 6) {
+      const s8 d = static_cast<s8>(Next());
+      Print("(%s%c%02Xh)", index_, d < 0 ? '-' : '+', d < 0 ? -d : d);
+    } else if (index_ && !plain_hl && (index == 4 || index == 5)) {
+      Print("%s%s", index_, index == 4 ? "H" : "L");
+    } else {
+      Print("%s", kReg8[index]);
+    }
+  }
+
+  const char* HL() const { return index_ ? index_ : "HL"; }
+  const char* Pair(int p) const { return p == 2 ? HL() : kRegPair[p]; }
+  const char* Pair2(int p) const { return p == 2 ? HL() : kRegPair2[p]; }
+
+  void Imm8() { Print("%02Xh", Next()); }
+  void Imm16() {
+    const u8 lo = Next();
+    const u8 hi = Next();
+    Print("%04Xh", lo | (hi << 8));
+  }
+  void Relative() {
+    const s8 d = static_cast<s8>(Next());
+    Print("%04Xh", static_cast<u16>(pc_ + length_ + d));
+  }
+
+  void Main(u8 op);
+  void CB();
+  void IndexedCB();
+  void ED();
+
+  const u8* bytes_;
+  u16 pc_;
+  char* out_;
+  size_t size_;
+  size_t used_ = 0;
+  int length_ = 0;
+  const char* index_ = nullptr;
+};
+
+int Decoder::Run() {
+  u8 op = Next();
+  if (op == 0xDD || op == 0xFD) {
+    const u8 next = bytes_[length_];
+    if (next == 0xDD || next == 0xED || next == 0xFD) {
+      Print("NOP*");  // prefix ignored by the following one
+      return length_;
+    }
+    index_ = op == 0xDD ? "IX" : "IY";
+    op = Next();
+    if (op == 0xCB) {
+      IndexedCB();
+      return length_;
+    }
+  }
+
+  if (op == 0xCB) {
+    CB();
+  } else if (op == 0xED) {
+    ED();
+  } else {
+    Main(op);
+  }
+  return length_;
+}
+
+void Decoder::Main(u8 op) {
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const int p = y >> 1;
+  const int q = y & 1;
+
+  switch (x) {
+    case 0:
+      switch (z) {
+        case 0:
+          if (y == 0) {
+            Print("NOP");
+          } else if (y == 1) {
+            Print("EX AF,AF'");
+          } else if (y == 2) {
+            Print("DJNZ ");
+            Relative();
+          } else if (y == 3) {
+            Print("JR ");
+            Relative();
+          } else {
+            Print("JR %s,", kCondition[y - 4]);
+            Relative();
+          }
+          return;
+        case 1:
+          if (q == 0) {
+            Print("LD %s,", Pair(p));
+            Imm16();
+          } else {
+            Print("ADD %s,%s", HL(), Pair(p));
+          }
+          return;
+        case 2:
+          switch (y) {
+            case 0:
+              Print("LD (BC),A");
+              return;
+            case 1:
+              Print("LD A,(BC)");
+              return;
+            case 2:
+              Print("LD (DE),A");
+              return;
+            case 3:
+              Print("LD A,(DE)");
+              return;
+            case 4:
+              Print("LD (");
+              Imm16();
+              Print("),%s", HL());
+              return;
+            case 5:
+              Print("LD %s,(", HL());
+              Imm16();
+              Print(")");
+              return;
+            case 6:
+              Print("LD (");
+              Imm16();
+              Print("),A");
+              return;
+            default:
+              Print("LD A,(");
+              Imm16();
+              Print(")");
+              return;
+          }
+        case 3:
+          Print("%s %s", q == 0 ? "INC" : "DEC", Pair(p));
+          return;
+        case 4:
+        case 5:
+          Print("%s ", z == 4 ? "INC" : "DEC");
+          Reg8(y);
+          return;
+        case 6:
+          Print("LD ");
+          Reg8(y);
+          Print(",");
+          Imm8();
+          return;
+        default:
+          Print("%s", kAccumulatorOps[y]);
+          return;
+      }
+    case 1:
+      if (op == 0x76) {
+        Print("HALT");
+        return;
+      }
+      Print("LD ");
+      Reg8(y, z == 6);
+      Print(",");
+      Reg8(z, y == 6);
+      return;
+    case 2:
+      Print("%s", kAlu[y]);
+      Reg8(z);
+      return;
+    default:
+      switch (z) {
+        case 0:
+          Print("RET %s", kCondition[y]);
+          return;
+        case 1:
+          if (q == 0) {
+            Print("POP %s", Pair2(p));
+          } else if (p == 0) {
+            Print("RET");
+          } else if (p == 1) {
+            Print("EXX");
+          } else if (p == 2) {
+            Print("JP (%s)", HL());
+          } else {
+            Print("LD SP,%s", HL());
+          }
+          return;
+        case 2:
+          Print("JP %s,", kCondition[y]);
+          Imm16();
+          return;
+        case 3:
+          switch (y) {
+            case 0:
+              Print("JP ");
+              Imm16();
+              return;
+            case 2:
+              Print("OUT (");
+              Imm8();
+              Print("),A");
+              return;
+            case 3:
+              Print("IN A,(");
+              Imm8();
+              Print(")");
+              return;
+            case 4:
+              Print("EX (SP),%s", HL());
+              return;
+            case 5:
+              Print("EX DE,HL");
+              return;
+            case 6:
+              Print("DI");
+              return;
+            case 7:
+              Print("EI");
+              return;
+            default:
+              Print("???");
+              return;
+          }
+        case 4:
+          Print("CALL %s,", kCondition[y]);
+          Imm16();
+          return;
+        case 5:
+          if (q == 0) {
+            Print("PUSH %s", Pair2(p));
+          } else {
+            Print("CALL ");
+            Imm16();
+          }
+          return;
+        case 6:
+          Print("%s", kAlu[y]);
+          Imm8();
+          return;
+        default:
+          Print("RST %02Xh", y * 8);
+          return;
+      }
+  }
+}
+
+void Decoder::CB() {
+  const u8 op = Next();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  if (x == 0) {
+    Print("%s %s", kRotate[y], kReg8[z]);
+  } else {
+    Print("%s %d,%s", x == 1 ? "BIT" : (x == 2 ? "RES" : "SET"), y, kReg8[z]);
+  }
+}
+
+void Decoder::IndexedCB() {
+  const s8 d = static_cast<s8>(Next());
+  const u8 op = Next();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const char sign = d < 0 ? '-' : '+';
+  const int magnitude = d < 0 ? -d : d;
+  if (x == 0) {
+    Print("%s (%s%c%02Xh)", kRotate[y], index_, sign, magnitude);
+  } else {
+    Print("%s %d,(%s%c%02Xh)", x == 1 ? "BIT" : (x == 2 ? "RES" : "SET"), y, index_, sign, magnitude);
+  }
+  if (x != 1 && z != 6) {
+    Print(",%s", kReg8[z]);
+  }
+}
+
+void Decoder::ED() {
+  const u8 op = Next();
+  const int x = op >> 6;
+  const int y = (op >> 3) & 7;
+  const int z = op & 7;
+  const int p = y >> 1;
+  const int q = y & 1;
+
+  if (x == 2 && z <= 3 && y >= 4) {
+    Print("%s", kBlockOps[y - 4][z]);
+    return;
+  }
+  if (x != 1) {
+    Print("NONI");
+    return;
+  }
+
+  switch (z) {
+    case 0:
+      Print(y == 6 ? "IN (C)" : "IN %s,(C)", kReg8[y]);
+      return;
+    case 1:
+      Print(y == 6 ? "OUT (C),0" : "OUT (C),%s", kReg8[y]);
+      return;
+    case 2:
+      Print("%s HL,%s", q == 0 ? "SBC" : "ADC", kRegPair[p]);
+      return;
+    case 3:
+      if (q == 0) {
+        Print("LD (");
+        Imm16();
+        Print("),%s", kRegPair[p]);
+      } else {
+        Print("LD %s,(", kRegPair[p]);
+        Imm16();
+        Print(")");
+      }
+      return;
+    case 4:
+      Print("NEG");
+      return;
+    case 5:
+      Print(y == 1 ? "RETI" : "RETN");
+      return;
+    case 6:
+      Print("IM %s", kInterruptModes[y]);
+      return;
+    default: {
+      constexpr const char* kMisc[8] = {"LD I,A", "LD R,A", "LD A,I", "LD A,R", "RRD", "RLD", "NOP*", "NOP*"};
+      Print("%s", kMisc[y]);
+      return;
+    }
+  }
+}
+}  // namespace
+
+int Disassemble(const u8* bytes, u16 pc, char* out, size_t out_size) {
+  Decoder decoder(bytes, pc, out, out_size);
+  return decoder.Run();
+}
+
+}  // namespace sz::cpu
@@ -0,0 +1,23 @@
+#ifndef SUPERZ80_CPU_Z80DISASSEMBLER_H
+#define SUPERZ80_CPU_Z80DISASSEMBLER_H
+
+#include <cstddef>
+
+#include "core/types.h"
+
+namespace sz::cpu {
+
+constexpr int kMaxInstructionLength = 4;
+
+// Decodes the instruction starting at `bytes` (kMaxInstructionLength bytes
+// must be readable) and returns its length. With a non-null `out`, also
+// writes the mnemonic; `pc` resolves relative jump targets.
+int Disassemble(const u8* bytes, u16 pc, char* out, size_t out_size);
+
+inline int InstructionLength(const u8* bytes) {
+  return Disassemble(bytes, 0, nullptr, 0);
+}
+
+}  // namespace sz::cpu
+
+#endif
@@ -25,6 +25,9 @@ void DebugUI::Init(SDL_Window* window, SDL_Renderer* renderer) {
   ImGui::StyleColorsDark();
   ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
   ImGui_ImplSDLRenderer2_Init(renderer);
+  tiles_viewer_.Init(renderer);
+  tilemap_viewer_.Init(renderer);
+  sprites_viewer_.Init(renderer);
   initialized_ = true;
 }
 
@@ -32,6 +35,9 @@ void DebugUI::Shutdown() {
   if (!initialized_) {
     return;
   }
+  tiles_viewer_.Shutdown();
+  tilemap_viewer_.Shutdown();
+  sprites_viewer_.Shutdown();
   ImGui_ImplSDLRenderer2_Shutdown();
   ImGui_ImplSDL2_Shutdown();
   ImGui::DestroyContext();
@@ -54,13 +60,26 @@ void DebugUI::BeginFrame() {
   ImGui::NewFrame();
 }
 
-void DebugUI::Draw(const sz::console::SuperZ80Console& console) {
+void DebugUI::Draw(const sz::console::DebugSnapshot& snapshot) {
   if (!initialized_) {
     return;
   }
 
-  ImGui::Begin("SuperZ80 Debug");
+  const bool expanded = ImGui::Begin("SuperZ80 Debug");
+  if (expanded) {
+    DrawPanels(snapshot);
+  }
+  ImGui::End();
+
+  DrawViewers(snapshot);
+  wants_snapshot_ = expanded || show_tiles_ || show_tilemap_ || show_sprites_ || show_palette_;
+}
 
+bool DebugUI::WantsSnapshot() const {
+  return initialized_ && wants_snapshot_;
+}
+
+void DebugUI::DrawPanels(const sz::console::DebugSnapshot& snapshot) {
   PanelCPU cpu_panel;
   PanelBus bus_panel;
   PanelPPU ppu_panel;
@@ -72,34 +91,68 @@ void DebugUI::Draw(const sz::console::SuperZ80Console& console) {
   PanelInput input_panel;
 
   if (ImGui::CollapsingHeader("CPU", ImGuiTreeNodeFlags_DefaultOpen)) {
-    cpu_panel.Draw(console);
+    cpu_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("Bus", ImGuiTreeNodeFlags_DefaultOpen)) {
-    bus_panel.Draw(console);
+    bus_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("PPU", ImGuiTreeNodeFlags_DefaultOpen)) {
-    ppu_panel.Draw(console);
+    ppu_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("APU", ImGuiTreeNodeFlags_DefaultOpen)) {
-    apu_panel.Draw(console);
+    apu_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("DMA", ImGuiTreeNodeFlags_DefaultOpen)) {
-    dma_panel.Draw(console);
+    dma_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("IRQ", ImGuiTreeNodeFlags_DefaultOpen)) {
-    irq_panel.Draw(console);
+    irq_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("Scheduler/Timing", ImGuiTreeNodeFlags_DefaultOpen)) {
-    scheduler_panel.Draw(console);
+    scheduler_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("Cartridge", ImGuiTreeNodeFlags_DefaultOpen)) {
-    cart_panel.Draw(console);
+    cart_panel.Draw(snapshot);
   }
   if (ImGui::CollapsingHeader("Input", ImGuiTreeNodeFlags_DefaultOpen)) {
-    input_panel.Draw(console);
+    input_panel.Draw(snapshot);
+  }
+  if (ImGui::CollapsingHeader("Viewers", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::Checkbox("Tiles", &show_tiles_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Tilemap", &show_tilemap_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Sprites", &show_sprites_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Palette", &show_palette_);
   }
+}
 
-  ImGui::End();
+void DebugUI::DrawViewers(const sz::console::DebugSnapshot& snapshot) {
+  if (show_tiles_) {
+    if (ImGui::Begin("Tiles", &show_tiles_)) {
+      tiles_viewer_.Draw(snapshot.video);
+    }
+    ImGui::End();
+  }
+  if (show_tilemap_) {
+    if (ImGui::Begin("Tilemap", &show_tilemap_)) {
+      tilemap_viewer_.Draw(snapshot.video);
+    }
+    ImGui::End();
+  }
+  if (show_sprites_) {
+    if (ImGui::Begin("Sprites", &show_sprites_)) {
+      sprites_viewer_.Draw(snapshot.video);
+    }
+    ImGui::End();
+  }
+  if (show_palette_) {
+    if (ImGui::Begin("Palette", &show_palette_)) {
+      palette_viewer_.Draw(snapshot.video);
+    }
+    ImGui::End();
+  }
 }
 
 void DebugUI::EndFrame() {
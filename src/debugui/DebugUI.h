@@ -4,6 +4,10 @@
 #include <SDL.h>
 
 #include "console/SuperZ80Console.h"
+#include "debugui/panels/PanelPalette.h"
+#include "debugui/panels/PanelSprites.h"
+#include "debugui/panels/PanelTilemap.h"
+#include "debugui/panels/PanelTiles.h"
 
 namespace sz::debugui {
 
@@ -13,11 +17,29 @@ class DebugUI {
   void Shutdown();
   void ProcessEvent(const SDL_Event* event);
   void BeginFrame();
-  void Draw(const sz::console::SuperZ80Console& console);
+  void Draw(const sz::console::DebugSnapshot& snapshot);
   void EndFrame();
+  // False while the debug window is collapsed and no viewer is open, so the
+  // emulator can stop capturing snapshots nobody looks at.
+  bool WantsSnapshot() const;
 
  private:
+  void DrawPanels(const sz::console::DebugSnapshot& snapshot);
+  void DrawViewers(const sz::console::DebugSnapshot& snapshot);
+
   bool initialized_ = false;
+  bool wants_snapshot_ = false;
+
+  // VRAM viewers keep their textures and caches between frames; a closed
+  // viewer does no work at all.
+  PanelTiles tiles_viewer_{};
+  PanelTilemap tilemap_viewer_{};
+  PanelSprites sprites_viewer_{};
+  PanelPalette palette_viewer_{};
+  bool show_tiles_ = false;
+  bool show_tilemap_ = false;
+  bool show_sprites_ = false;
+  bool show_palette_ = false;
 };
 
 }  // namespace sz::debugui
@@ -0,0 +1,41 @@
+#include "debugui/TileRaster.h"
+
+namespace sz::debugui {
+
+TileColors PaletteColors(const sz::ppu::VideoMemory& video, int palette) {
+  TileColors colors{};
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = sz::ppu::PaletteToArgb(video.palette[static_cast<size_t>(palette) * colors.size() + i]);
+  }
+  return colors;
+}
+
+u8 VideoReg(const sz::ppu::VideoMemory& video, u8 port) {
+  return video.video_regs[port - sz::ppu::kPortVideoFirst];
+}
+
+u8 SpriteReg(const sz::ppu::VideoMemory& video, u8 port) {
+  return video.sprite_regs[port - sz::ppu::kPortSprCtrl];
+}
+
+size_t PatternTile(const sz::ppu::VideoMemory& video, int index) {
+  const size_t base = static_cast<size_t>(VideoReg(video, sz::ppu::kPortPatternBase)) * sz::ppu::kVramPageSize /
+                      sz::ppu::kTileBytes;
+  return (base + (static_cast<size_t>(index) & sz::ppu::kTileIndexMask)) % sz::ppu::kVramTiles;
+}
+
+void RasterTile(const sz::ppu::VideoMemory& video, size_t tile, const TileColors& colors, bool hflip,
+                bool vflip, u32* out, int pitch) {
+  const u8* data = video.vram.data() + tile * sz::ppu::kTileBytes;
+  for (int y = 0; y < 8; ++y) {
+    const u8* row = data + (vflip ? 7 - y : y) * 4;
+    u32* dest = out + static_cast<ptrdiff_t>(y) * pitch;
+    for (int x = 0; x < 8; ++x) {
+      const int col = hflip ? 7 - x : x;
+      const u8 color = (col & 1) ? (row[col >> 1] & 0x0F) : (row[col >> 1] >> 4);
+      dest[x] = colors[color];
+    }
+  }
+}
+
+}  // namespace sz::debugui
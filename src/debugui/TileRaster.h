@@ -0,0 +1,31 @@
+#ifndef SUPERZ80_DEBUGUI_TILERASTER_H
+#define SUPERZ80_DEBUGUI_TILERASTER_H
+
+#include <array>
+#include <cstddef>
+
+#include "core/types.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::debugui {
+
+// Decoding shared by the VRAM viewers, on a sz::ppu::VideoMemory copy.
+// Tiles are numbered absolutely (0 .. kVramTiles-1), not from PATTERN_BASE.
+
+using TileColors = std::array<u32, 16>;
+
+TileColors PaletteColors(const sz::ppu::VideoMemory& video, int palette);
+
+u8 VideoReg(const sz::ppu::VideoMemory& video, u8 port);
+u8 SpriteReg(const sz::ppu::VideoMemory& video, u8 port);
+
+// Absolute tile for a 9-bit tilemap or sprite tile index.
+size_t PatternTile(const sz::ppu::VideoMemory& video, int index);
+
+// Writes one 8x8 tile to `out`, `pitch` pixels per row.
+void RasterTile(const sz::ppu::VideoMemory& video, size_t tile, const TileColors& colors, bool hflip,
+                bool vflip, u32* out, int pitch);
+
+}  // namespace sz::debugui
+
+#endif
@@ -0,0 +1,94 @@
+#include "debugui/ViewerTexture.h"
+
+#include <algorithm>
+
+#include <imgui.h>
+
+#include "core/log/Logger.h"
+
+namespace sz::debugui {
+
+ViewerTexture::~ViewerTexture() {
+  Destroy();
+}
+
+bool ViewerTexture::Create(SDL_Renderer* renderer, int width, int height) {
+  Destroy();
+  texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+  if (!texture_) {
+    SZ_LOG_WARN("Viewer texture %dx%d: %s", width, height, SDL_GetError());
+    return false;
+  }
+  width_ = width;
+  height_ = height;
+  pixels_.assign(static_cast<size_t>(width) * height, 0xFF000000u);
+  MarkRows(0, height);
+  return true;
+}
+
+void ViewerTexture::Destroy() {
+  if (texture_) {
+    SDL_DestroyTexture(texture_);
+    texture_ = nullptr;
+  }
+  pixels_.clear();
+  width_ = height_ = 0;
+  dirty_first_ = dirty_end_ = 0;
+}
+
+bool ViewerTexture::IsCreated() const {
+  return texture_ != nullptr;
+}
+
+u32* ViewerTexture::Row(int y) {
+  return pixels_.data() + static_cast<size_t>(y) * width_;
+}
+
+void ViewerTexture::MarkRows(int first, int count) {
+  if (dirty_end_ == dirty_first_) {
+    dirty_first_ = first;
+    dirty_end_ = first + count;
+  } else {
+    dirty_first_ = std::min(dirty_first_, first);
+    dirty_end_ = std::max(dirty_end_, first + count);
+  }
+}
+
+void ViewerTexture::Upload() {
+  if (!texture_ || dirty_end_ == dirty_first_) {
+    return;
+  }
+  const SDL_Rect rect{0, dirty_first_, width_, dirty_end_ - dirty_first_};
+  SDL_UpdateTexture(texture_, &rect, Row(dirty_first_), width_ * static_cast<int>(sizeof(u32)));
+  dirty_first_ = dirty_end_ = 0;
+}
+
+SDL_Texture* ViewerTexture::Get() const {
+  return texture_;
+}
+
+int ViewerTexture::GetWidth() const {
+  return width_;
+}
+
+int ViewerTexture::GetHeight() const {
+  return height_;
+}
+
+bool RefreshRate::Due() {
+  if (--countdown_ > 0) {
+    return false;
+  }
+  countdown_ = interval_;
+  return true;
+}
+
+void RefreshRate::Force() {
+  countdown_ = 0;
+}
+
+void RefreshRate::DrawControl() {
+  ImGui::SliderInt("Refresh every N frames", &interval_, 1, 60);
+}
+
+}  // namespace sz::debugui
@@ -0,0 +1,58 @@
+#ifndef SUPERZ80_DEBUGUI_VIEWERTEXTURE_H
+#define SUPERZ80_DEBUGUI_VIEWERTEXTURE_H
+
+#include <vector>
+
+#include <SDL.h>
+
+#include "core/types.h"
+
+namespace sz::debugui {
+
+// Persistent ARGB8888 texture with a CPU-side copy. Viewers rasterise only
+// what changed into Row(), mark those rows, and Upload sends the marked
+// span instead of the whole image.
+class ViewerTexture {
+ public:
+  ~ViewerTexture();
+
+  bool Create(SDL_Renderer* renderer, int width, int height);
+  void Destroy();
+  bool IsCreated() const;
+
+  u32* Row(int y);
+  void MarkRows(int first, int count);
+  void Upload();
+
+  SDL_Texture* Get() const;
+  int GetWidth() const;
+  int GetHeight() const;
+
+ private:
+  SDL_Texture* texture_ = nullptr;
+  std::vector<u32> pixels_{};
+  int width_ = 0;
+  int height_ = 0;
+  int dirty_first_ = 0;
+  int dirty_end_ = 0;
+};
+
+// Refresh throttle for one viewer, counted in UI frames, with its own
+// slider so each viewer can run at the rate it needs.
+class RefreshRate {
+ public:
+  explicit RefreshRate(int interval) : interval_(interval) {}
+
+  // True once every `interval` calls; Force makes the next call true.
+  bool Due();
+  void Force();
+  void DrawControl();
+
+ private:
+  int interval_ = 1;
+  int countdown_ = 0;
+};
+
+}  // namespace sz::debugui
+
+#endif
@@ -4,10 +4,14 @@
 
 namespace sz::debugui {
 
-void PanelAPU::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetAPUDebugState();
-  ImGui::Text("APU stub (no audio output)");
+void PanelAPU::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.apu;
   ImGui::Text("Last CPU tstates: %d", state.last_cpu_tstates);
+  ImGui::Text("Samples this frame: %d", state.frame_samples);
+  for (int ch = 0; ch < 3; ++ch) {
+    ImGui::Text("PSG tone %d: period %03X  atten %X", ch, state.tone_period[ch], state.volume[ch]);
+  }
+  ImGui::Text("PSG noise: ctrl %X  atten %X", state.noise_ctrl, state.volume[3]);
 }
 
 }  // namespace sz::debugui
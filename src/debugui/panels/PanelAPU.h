@@ -7,7 +7,7 @@ namespace sz::debugui {
 
 class PanelAPU {
  public:
-  void Draw(const sz::console::SuperZ80Console& console);
+  void Draw(const sz::console::DebugSnapshot& snapshot);
 };
 
 }  // namespace sz::debugui
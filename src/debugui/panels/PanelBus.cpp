@@ -4,8 +4,10 @@
 
 namespace sz::debugui {
 
-void PanelBus::Draw(const sz::console::SuperZ80Console& /*console*/) {
-  ImGui::Text("Bus stub (no decoding yet)");
+void PanelBus::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.bus;
+  ImGui::Text("Last IN port: %02X", state.last_in_port);
+  ImGui::Text("Last OUT: %02X <- %02X", state.last_out_port, state.last_out_value);
 }
 
 }  // namespace sz::debugui
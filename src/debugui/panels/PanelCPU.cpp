@@ -4,10 +4,17 @@
 
 namespace sz::debugui {
 
-void PanelCPU::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetCpuDebugState();
-  ImGui::Text("CPU stub (no execution)");
+void PanelCPU::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.cpu;
+  const auto& r = state.regs;
+  ImGui::Text("PC: %04X  SP: %04X", r.pc, r.sp);
+  ImGui::Text("AF: %04X  BC: %04X  DE: %04X  HL: %04X", r.af, r.bc, r.de, r.hl);
+  ImGui::Text("AF': %04X BC': %04X DE': %04X HL': %04X", r.af_alt, r.bc_alt, r.de_alt, r.hl_alt);
+  ImGui::Text("IX: %04X  IY: %04X  I: %02X  R: %02X", r.ix, r.iy, r.i, r.r);
+  ImGui::Text("IM %u  IFF1 %d  IFF2 %d  %s", r.im, r.iff1 ? 1 : 0, r.iff2 ? 1 : 0, r.halted ? "HALT" : "");
+  ImGui::Text("/INT: %s  EI shadow: %s", state.int_line ? "low" : "high", state.ei_shadow ? "true" : "false");
   ImGui::Text("Last budget: %d", state.last_budget);
+  ImGui::Text("T-states: %llu", static_cast<unsigned long long>(state.tstates));
 }
 
 }  // namespace sz::debugui
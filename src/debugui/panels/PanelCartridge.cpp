@@ -4,10 +4,14 @@
 
 namespace sz::debugui {
 
-void PanelCartridge::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetCartridgeDebugState();
-  ImGui::Text("Cartridge stub");
+void PanelCartridge::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.cartridge;
   ImGui::Text("Loaded: %s", state.loaded ? "true" : "false");
+  if (state.loaded) {
+    ImGui::Text("ROM: %zu KB, %d banks", state.rom_size / 1024, state.bank_count);
+  }
+  ImGui::Text("MAP_CTRL: %02X  ROM_BANK_0: %02X  ROM_BANK_1: %02X  SRAM_BANK: %02X", state.map_ctrl,
+              state.rom_bank_0, state.rom_bank_1, state.sram_bank);
 }
 
 }  // namespace sz::debugui
@@ -4,9 +4,11 @@
 
 namespace sz::debugui {
 
-void PanelDMA::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetDMADebugState();
-  ImGui::Text("DMA stub (no transfers yet)");
+void PanelDMA::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.dma;
+  ImGui::Text("SRC %04X  DST %04X  LEN %04X  CTRL %02X", state.src, state.dst, state.len, state.ctrl);
+  ImGui::Text("In VBlank: %s  Queued: %s", state.in_vblank ? "yes" : "no", state.queued ? "yes" : "no");
+  ImGui::Text("Transfers: %d  Dropped starts: %d", state.transfers, state.rejected);
   ImGui::Text("Tick count: %d", state.ticks);
 }
 
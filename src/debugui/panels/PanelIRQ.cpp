@@ -4,9 +4,10 @@
 
 namespace sz::debugui {
 
-void PanelIRQ::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetIRQDebugState();
-  ImGui::Text("IRQ stub (no pending bits)");
+void PanelIRQ::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.irq;
+  ImGui::Text("Pending: %02X", state.pending);
+  ImGui::Text("Enable:  %02X", state.enable);
   ImGui::Text("/INT asserted: %s", state.int_asserted ? "true" : "false");
 }
 
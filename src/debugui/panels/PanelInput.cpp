@@ -4,13 +4,18 @@
 
 namespace sz::debugui {
 
-void PanelInput::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetInputDebugState();
-  ImGui::Text("Input stub");
-  ImGui::Text("Up: %d  Down: %d  Left: %d  Right: %d", state.buttons.up, state.buttons.down,
-              state.buttons.left, state.buttons.right);
-  ImGui::Text("A: %d  B: %d  Start: %d  Select: %d", state.buttons.a, state.buttons.b,
-              state.buttons.start, state.buttons.select);
+void PanelInput::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.input;
+  ImGui::Text("Sampling: %s", state.live ? "live (at IN)" : "latched per frame");
+  for (int pad = 0; pad < sz::input::kPadCount; ++pad) {
+    const auto& buttons = state.pads[static_cast<size_t>(pad)];
+    ImGui::Separator();
+    ImGui::Text("PAD%d", pad + 1);
+    ImGui::Text("Up: %d  Down: %d  Left: %d  Right: %d", buttons.up, buttons.down, buttons.left,
+                buttons.right);
+    ImGui::Text("A: %d  B: %d  Start: %d  Select: %d", buttons.a, buttons.b, buttons.start,
+                buttons.select);
+  }
 }
 
 }  // namespace sz::debugui
@@ -4,10 +4,13 @@
 
 namespace sz::debugui {
 
-void PanelPPU::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetPPUDebugState();
-  ImGui::Text("PPU stub (no rendering logic)");
+void PanelPPU::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.ppu;
   ImGui::Text("Last scanline: %d", state.last_scanline);
+  ImGui::Text("VDP_CTRL: %02X  SPR_CTRL: %02X", state.vdp_ctrl, state.spr_ctrl);
+  ImGui::Text("VRAM addr: %04X  PAL addr: %02X", state.vram_addr, state.pal_addr);
+  ImGui::Text("Sprites on last line: %d%s", state.last_line_sprites,
+              state.sprite_overflow ? "  (overflow)" : "");
 }
 
 }  // namespace sz::debugui
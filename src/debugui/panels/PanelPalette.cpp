@@ -0,0 +1,36 @@
+#include "debugui/panels/PanelPalette.h"
+
+#include <imgui.h>
+
+namespace sz::debugui {
+
+void PanelPalette::Draw(const sz::ppu::VideoMemory& video) {
+  rate_.DrawControl();
+  if (rate_.Due() && (stale_ || seen_version_ != video.palette_version)) {
+    entries_ = video.palette;
+    for (size_t i = 0; i < colors_.size(); ++i) {
+      colors_[i] = sz::ppu::PaletteToArgb(entries_[i]);
+    }
+    seen_version_ = video.palette_version;
+    stale_ = false;
+  }
+
+  for (int palette = 0; palette < 8; ++palette) {
+    ImGui::Text("%d", palette);
+    for (int color = 0; color < 16; ++color) {
+      const size_t i = static_cast<size_t>(palette) * 16 + color;
+      const u32 argb = colors_[i];
+      const ImVec4 swatch(((argb >> 16) & 0xFF) / 255.0f, ((argb >> 8) & 0xFF) / 255.0f, (argb & 0xFF) / 255.0f,
+                          1.0f);
+      ImGui::SameLine();
+      ImGui::PushID(static_cast<int>(i));
+      ImGui::ColorButton("##swatch", swatch, 0, ImVec2(16, 16));
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%02zX: %03X", i, entries_[i] & 0x1FF);
+      }
+      ImGui::PopID();
+    }
+  }
+}
+
+}  // namespace sz::debugui
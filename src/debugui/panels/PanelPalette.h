@@ -0,0 +1,27 @@
+#ifndef SUPERZ80_DEBUGUI_PANELS_PANELPALETTE_H
+#define SUPERZ80_DEBUGUI_PANELS_PANELPALETTE_H
+
+#include <array>
+
+#include "debugui/ViewerTexture.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::debugui {
+
+// The 128 palette entries as 8 rows of 16 swatches. Colours are converted
+// only when the palette version moves, at most once per refresh interval.
+class PanelPalette {
+ public:
+  void Draw(const sz::ppu::VideoMemory& video);
+
+ private:
+  RefreshRate rate_{8};
+  std::array<u16, sz::ppu::kPaletteEntries> entries_{};
+  std::array<u32, sz::ppu::kPaletteEntries> colors_{};
+  u32 seen_version_ = 0;
+  bool stale_ = true;
+};
+
+}  // namespace sz::debugui
+
+#endif
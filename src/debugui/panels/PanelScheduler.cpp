@@ -4,12 +4,45 @@
 
 namespace sz::debugui {
 
-void PanelScheduler::Draw(const sz::console::SuperZ80Console& console) {
-  auto state = console.GetSchedulerDebugState();
+void PanelScheduler::Draw(const sz::console::DebugSnapshot& snapshot) {
+  const auto& state = snapshot.scheduler;
   ImGui::Text("Scheduler stub (scanline-based)");
   ImGui::Text("Frame: %llu", static_cast<unsigned long long>(state.frame));
   ImGui::Text("Scanline: %d", state.scanline);
   ImGui::Text("CPU budget: %d", state.cpu_budget_tstates);
+
+  const auto& profile = state.profile;
+  ImGui::Separator();
+  if (!profile.enabled) {
+    ImGui::TextDisabled("Profiler compiled out (SUPERZ80_ENABLE_PROFILER=OFF)");
+    return;
+  }
+  ImGui::Text("StepFrame host time, last %d frames (us)", profile.window_frames);
+  if (ImGui::BeginTable("profile", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Section");
+    ImGui::TableSetupColumn("Mean");
+    ImGui::TableSetupColumn("p50");
+    ImGui::TableSetupColumn("p99");
+    ImGui::TableSetupColumn("Share");
+    ImGui::TableHeadersRow();
+    for (int section = 0; section <= sz::scheduler::kProfileSectionCount; ++section) {
+      const bool is_frame = section == sz::scheduler::kProfileSectionCount;
+      const auto& stats = is_frame ? profile.frame : profile.sections[section];
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(is_frame ? "Frame" : sz::scheduler::kProfileSectionNames[section]);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", stats.mean_us);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", stats.p50_us);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", stats.p99_us);
+      ImGui::TableNextColumn();
+      const float share = profile.frame.mean_us > 0.0 ? static_cast<float>(stats.mean_us / profile.frame.mean_us) : 0.0f;
+      ImGui::ProgressBar(share);
+    }
+    ImGui::EndTable();
+  }
 }
 
 }  // namespace sz::debugui
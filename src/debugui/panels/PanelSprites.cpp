@@ -0,0 +1,128 @@
+#include "debugui/panels/PanelSprites.h"
+
+#include <algorithm>
+
+#include <imgui.h>
+
+namespace sz::debugui {
+namespace {
+constexpr u32 kCellBackground = 0xFF202020;
+
+const u8* SatEntry(const sz::ppu::VideoMemory& video, int sprite) {
+  const size_t sat = static_cast<size_t>(SpriteReg(video, sz::ppu::kPortSatBase)) * sz::ppu::kSatPageSize;
+  return video.vram.data() + (sat + static_cast<size_t>(sprite) * sz::ppu::kSpriteEntrySize) % sz::ppu::kVramSize;
+}
+}  // namespace
+
+void PanelSprites::Init(SDL_Renderer* renderer) {
+  constexpr int kRows = (sz::ppu::kSpriteCount + kColumns - 1) / kColumns;
+  sheet_.Create(renderer, kColumns * kCell, kRows * kCell);
+  keys_.fill(CellKey{});
+}
+
+void PanelSprites::Shutdown() {
+  sheet_.Destroy();
+}
+
+void PanelSprites::Draw(const sz::ppu::VideoMemory& video) {
+  ImGui::SliderInt("Zoom", &zoom_, 1, 4);
+  rate_.DrawControl();
+  if (sheet_.IsCreated() && rate_.Due()) {
+    Refresh(video);
+  }
+  ImGui::Text("SAT base %02X  SPR_CTRL %02X  redrew %d sprite(s)", SpriteReg(video, sz::ppu::kPortSatBase),
+              SpriteReg(video, sz::ppu::kPortSprCtrl), last_redrawn_);
+  ImGui::Image(static_cast<ImTextureID>(sheet_.Get()),
+               ImVec2(static_cast<float>(sheet_.GetWidth() * zoom_), static_cast<float>(sheet_.GetHeight() * zoom_)));
+  DrawAttributeTable(video);
+}
+
+void PanelSprites::Refresh(const sz::ppu::VideoMemory& video) {
+  std::array<bool, 8> palette_changed{};
+  for (size_t palette = 0; palette < colors_.size(); ++palette) {
+    const TileColors colors = PaletteColors(video, static_cast<int>(palette));
+    palette_changed[palette] = colors != colors_[palette];
+    colors_[palette] = colors;
+  }
+
+  const int size = (SpriteReg(video, sz::ppu::kPortSprCtrl) >> sz::ppu::kSprCtrlSizeShift) & 3;
+  const int tiles_wide = size == 2 ? 2 : 1;
+  const int tiles_high = size == 0 ? 1 : 2;
+  last_redrawn_ = 0;
+  for (int sprite = 0; sprite < sz::ppu::kSpriteCount; ++sprite) {
+    const u8* entry = SatEntry(video, sprite);
+    const u8 attr = entry[3];
+    const int tile = entry[2] | ((attr & sz::ppu::kSpriteTileHigh) << 8);
+    const size_t palette = (attr >> sz::ppu::kSpritePaletteShift) & 7;
+
+    CellKey key;
+    std::copy(entry, entry + sz::ppu::kSpriteEntrySize, key.entry.begin());
+    key.size = size;
+    for (int t = 0; t < tiles_wide * tiles_high; ++t) {
+      key.tile_versions[t] = video.tile_versions[PatternTile(video, tile + t)];
+    }
+    if (key == keys_[sprite] && !palette_changed[palette]) {
+      continue;
+    }
+    keys_[sprite] = key;
+
+    const int cell_x = (sprite % kColumns) * kCell;
+    const int cell_y = (sprite / kColumns) * kCell;
+    for (int y = 0; y < kCell; ++y) {
+      std::fill_n(sheet_.Row(cell_y + y) + cell_x, kCell, kCellBackground);
+    }
+    // Flips mirror the whole sprite, so tiles swap places as well.
+    const bool hflip = (attr & sz::ppu::kSpriteHFlip) != 0;
+    const bool vflip = (attr & sz::ppu::kSpriteVFlip) != 0;
+    for (int ty = 0; ty < tiles_high; ++ty) {
+      for (int tx = 0; tx < tiles_wide; ++tx) {
+        const int dx = (hflip ? tiles_wide - 1 - tx : tx) * 8;
+        const int dy = (vflip ? tiles_high - 1 - ty : ty) * 8;
+        RasterTile(video, PatternTile(video, tile + ty * tiles_wide + tx), colors_[palette], hflip, vflip,
+                   sheet_.Row(cell_y + dy) + cell_x + dx, sheet_.GetWidth());
+      }
+    }
+    sheet_.MarkRows(cell_y, kCell);
+    ++last_redrawn_;
+  }
+  sheet_.Upload();
+}
+
+void PanelSprites::DrawAttributeTable(const sz::ppu::VideoMemory& video) const {
+  if (!ImGui::CollapsingHeader("Attributes")) {
+    return;
+  }
+  if (!ImGui::BeginTable("sprites", 7)) {
+    return;
+  }
+  ImGui::TableSetupColumn("#");
+  ImGui::TableSetupColumn("Y");
+  ImGui::TableSetupColumn("X");
+  ImGui::TableSetupColumn("Tile");
+  ImGui::TableSetupColumn("Pal");
+  ImGui::TableSetupColumn("Flip");
+  ImGui::TableSetupColumn("Behind");
+  ImGui::TableHeadersRow();
+  for (int sprite = 0; sprite < sz::ppu::kSpriteCount; ++sprite) {
+    const u8* entry = SatEntry(video, sprite);
+    const u8 attr = entry[3];
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::Text("%d", sprite);
+    ImGui::TableNextColumn();
+    ImGui::Text("%d", entry[0]);
+    ImGui::TableNextColumn();
+    ImGui::Text("%d", entry[1]);
+    ImGui::TableNextColumn();
+    ImGui::Text("%03X", entry[2] | ((attr & sz::ppu::kSpriteTileHigh) << 8));
+    ImGui::TableNextColumn();
+    ImGui::Text("%d", (attr >> sz::ppu::kSpritePaletteShift) & 7);
+    ImGui::TableNextColumn();
+    ImGui::Text("%c%c", (attr & sz::ppu::kSpriteHFlip) ? 'H' : '-', (attr & sz::ppu::kSpriteVFlip) ? 'V' : '-');
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", (attr & sz::ppu::kSpriteBehind) ? "yes" : "");
+  }
+  ImGui::EndTable();
+}
+
+}  // namespace sz::debugui
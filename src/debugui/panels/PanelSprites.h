@@ -0,0 +1,48 @@
+#ifndef SUPERZ80_DEBUGUI_PANELS_PANELSPRITES_H
+#define SUPERZ80_DEBUGUI_PANELS_PANELSPRITES_H
+
+#include <array>
+
+#include <SDL.h>
+
+#include "debugui/TileRaster.h"
+#include "debugui/ViewerTexture.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::debugui {
+
+// The 48 SAT entries as a sheet of 16x16 cells (8 x 6) plus their
+// attributes. A cell is redrawn when its SAT bytes, the sprite size, one of
+// its tiles' versions or its palette's colours changed.
+class PanelSprites {
+ public:
+  void Init(SDL_Renderer* renderer);
+  void Shutdown();
+  void Draw(const sz::ppu::VideoMemory& video);
+
+ private:
+  static constexpr int kColumns = 8;
+  static constexpr int kCell = 16;
+
+  struct CellKey {
+    std::array<u8, sz::ppu::kSpriteEntrySize> entry{};
+    int size = -1;
+    std::array<u32, 4> tile_versions{};
+
+    bool operator==(const CellKey&) const = default;
+  };
+
+  void Refresh(const sz::ppu::VideoMemory& video);
+  void DrawAttributeTable(const sz::ppu::VideoMemory& video) const;
+
+  ViewerTexture sheet_{};
+  RefreshRate rate_{4};
+  std::array<CellKey, sz::ppu::kSpriteCount> keys_{};
+  std::array<TileColors, 8> colors_{};
+  int zoom_ = 2;
+  int last_redrawn_ = 0;
+};
+
+}  // namespace sz::debugui
+
+#endif
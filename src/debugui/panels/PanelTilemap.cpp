@@ -0,0 +1,77 @@
+#include "debugui/panels/PanelTilemap.h"
+
+#include <imgui.h>
+
+namespace sz::debugui {
+
+void PanelTilemap::Init(SDL_Renderer* renderer) {
+  map_.Create(renderer, sz::ppu::kTilemapWidth * 8, sz::ppu::kTilemapHeight * 8);
+  stale_ = true;
+}
+
+void PanelTilemap::Shutdown() {
+  map_.Destroy();
+}
+
+void PanelTilemap::Draw(const sz::ppu::VideoMemory& video) {
+  int plane = plane_b_ ? 1 : 0;
+  const char* const kPlanes[] = {"Plane A", "Plane B"};
+  if (ImGui::Combo("Plane", &plane, kPlanes, 2)) {
+    plane_b_ = plane == 1;
+    stale_ = true;
+    rate_.Force();
+  }
+  ImGui::SliderInt("Zoom", &zoom_, 1, 4);
+  rate_.DrawControl();
+  if (map_.IsCreated() && rate_.Due()) {
+    Refresh(video);
+  }
+
+  const u8 scroll_x = VideoReg(video, plane_b_ ? sz::ppu::kPortPlaneBScrollX : sz::ppu::kPortPlaneAScrollX);
+  const u8 scroll_y = VideoReg(video, plane_b_ ? sz::ppu::kPortPlaneBScrollY : sz::ppu::kPortPlaneAScrollY);
+  ImGui::Text("Base %02X  pattern %02X  scroll %d,%d  redrew %d cell(s)", base_, pattern_, scroll_x, scroll_y,
+              last_redrawn_);
+  ImGui::Image(static_cast<ImTextureID>(map_.Get()),
+               ImVec2(static_cast<float>(map_.GetWidth() * zoom_), static_cast<float>(map_.GetHeight() * zoom_)));
+}
+
+void PanelTilemap::Refresh(const sz::ppu::VideoMemory& video) {
+  const u8 base = VideoReg(video, plane_b_ ? sz::ppu::kPortPlaneBBase : sz::ppu::kPortPlaneABase);
+  const u8 pattern = VideoReg(video, sz::ppu::kPortPatternBase);
+  if (base != base_ || pattern != pattern_) {
+    base_ = base;
+    pattern_ = pattern;
+    stale_ = true;
+  }
+  std::array<bool, 8> palette_changed{};
+  for (size_t palette = 0; palette < colors_.size(); ++palette) {
+    const TileColors colors = PaletteColors(video, static_cast<int>(palette));
+    palette_changed[palette] = colors != colors_[palette];
+    colors_[palette] = colors;
+  }
+
+  last_redrawn_ = 0;
+  const size_t map_base = static_cast<size_t>(base_) * sz::ppu::kVramPageSize;
+  for (size_t cell = 0; cell < kCells; ++cell) {
+    const size_t addr = (map_base + cell * 2) % sz::ppu::kVramSize;
+    const u16 entry = static_cast<u16>(video.vram[addr] | (video.vram[(addr + 1) % sz::ppu::kVramSize] << 8));
+    const size_t tile = PatternTile(video, entry & sz::ppu::kTileIndexMask);
+    const size_t palette = (entry >> sz::ppu::kTilePaletteShift) & 7;
+    if (!stale_ && entry == entries_[cell] && video.tile_versions[tile] == cell_versions_[cell] &&
+        !palette_changed[palette]) {
+      continue;
+    }
+    const int x = static_cast<int>(cell % sz::ppu::kTilemapWidth) * 8;
+    const int y = static_cast<int>(cell / sz::ppu::kTilemapWidth) * 8;
+    RasterTile(video, tile, colors_[palette], (entry & sz::ppu::kTileHFlip) != 0,
+               (entry & sz::ppu::kTileVFlip) != 0, map_.Row(y) + x, map_.GetWidth());
+    map_.MarkRows(y, 8);
+    entries_[cell] = entry;
+    cell_versions_[cell] = video.tile_versions[tile];
+    ++last_redrawn_;
+  }
+  stale_ = false;
+  map_.Upload();
+}
+
+}  // namespace sz::debugui
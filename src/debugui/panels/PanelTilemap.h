@@ -0,0 +1,43 @@
+#ifndef SUPERZ80_DEBUGUI_PANELS_PANELTILEMAP_H
+#define SUPERZ80_DEBUGUI_PANELS_PANELTILEMAP_H
+
+#include <array>
+
+#include <SDL.h>
+
+#include "debugui/TileRaster.h"
+#include "debugui/ViewerTexture.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::debugui {
+
+// One plane's 32x24 tilemap in a persistent texture. A cell is redrawn only
+// when its map entry, the version of the tile it shows, or its palette's
+// colours changed; a new base or pattern register redraws the lot.
+class PanelTilemap {
+ public:
+  void Init(SDL_Renderer* renderer);
+  void Shutdown();
+  void Draw(const sz::ppu::VideoMemory& video);
+
+ private:
+  static constexpr size_t kCells = static_cast<size_t>(sz::ppu::kTilemapWidth) * sz::ppu::kTilemapHeight;
+
+  void Refresh(const sz::ppu::VideoMemory& video);
+
+  ViewerTexture map_{};
+  RefreshRate rate_{2};
+  std::array<u16, kCells> entries_{};
+  std::array<u32, kCells> cell_versions_{};
+  std::array<TileColors, 8> colors_{};
+  u8 base_ = 0;
+  u8 pattern_ = 0;
+  bool plane_b_ = false;
+  int zoom_ = 2;
+  bool stale_ = true;
+  int last_redrawn_ = 0;
+};
+
+}  // namespace sz::debugui
+
+#endif
@@ -0,0 +1,53 @@
+#include "debugui/panels/PanelTiles.h"
+
+#include <imgui.h>
+
+namespace sz::debugui {
+
+void PanelTiles::Init(SDL_Renderer* renderer) {
+  constexpr int kRows = static_cast<int>(sz::ppu::kVramTiles) / kColumns;
+  atlas_.Create(renderer, kColumns * 8, kRows * 8);
+  stale_ = true;
+}
+
+void PanelTiles::Shutdown() {
+  atlas_.Destroy();
+}
+
+void PanelTiles::Draw(const sz::ppu::VideoMemory& video) {
+  if (ImGui::SliderInt("Palette", &palette_, 0, 7)) {
+    rate_.Force();
+  }
+  ImGui::SliderInt("Zoom", &zoom_, 1, 4);
+  rate_.DrawControl();
+  if (atlas_.IsCreated() && rate_.Due()) {
+    Refresh(video);
+  }
+  ImGui::Text("Last refresh redrew %d tile(s)", last_redrawn_);
+  ImGui::Image(static_cast<ImTextureID>(atlas_.Get()),
+               ImVec2(static_cast<float>(atlas_.GetWidth() * zoom_), static_cast<float>(atlas_.GetHeight() * zoom_)));
+}
+
+void PanelTiles::Refresh(const sz::ppu::VideoMemory& video) {
+  const TileColors colors = PaletteColors(video, palette_);
+  if (colors != colors_) {
+    colors_ = colors;
+    stale_ = true;
+  }
+  last_redrawn_ = 0;
+  for (size_t tile = 0; tile < sz::ppu::kVramTiles; ++tile) {
+    if (!stale_ && seen_versions_[tile] == video.tile_versions[tile]) {
+      continue;
+    }
+    const int x = static_cast<int>(tile % kColumns) * 8;
+    const int y = static_cast<int>(tile / kColumns) * 8;
+    RasterTile(video, tile, colors_, false, false, atlas_.Row(y) + x, atlas_.GetWidth());
+    atlas_.MarkRows(y, 8);
+    seen_versions_[tile] = video.tile_versions[tile];
+    ++last_redrawn_;
+  }
+  stale_ = false;
+  atlas_.Upload();
+}
+
+}  // namespace sz::debugui
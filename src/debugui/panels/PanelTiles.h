@@ -0,0 +1,40 @@
+#ifndef SUPERZ80_DEBUGUI_PANELS_PANELTILES_H
+#define SUPERZ80_DEBUGUI_PANELS_PANELTILES_H
+
+#include <array>
+
+#include <SDL.h>
+
+#include "debugui/TileRaster.h"
+#include "debugui/ViewerTexture.h"
+#include "devices/ppu/PPU.h"
+
+namespace sz::debugui {
+
+// Every VRAM tile in one persistent atlas (32 x 48 tiles) drawn with a
+// chosen palette. A refresh re-rasterises only tiles whose version moved,
+// or all of them when the palette's colours change.
+class PanelTiles {
+ public:
+  void Init(SDL_Renderer* renderer);
+  void Shutdown();
+  void Draw(const sz::ppu::VideoMemory& video);
+
+ private:
+  static constexpr int kColumns = 32;
+
+  void Refresh(const sz::ppu::VideoMemory& video);
+
+  ViewerTexture atlas_{};
+  RefreshRate rate_{8};
+  std::array<u32, sz::ppu::kVramTiles> seen_versions_{};
+  TileColors colors_{};
+  int palette_ = 0;
+  int zoom_ = 2;
+  bool stale_ = true;  // redraw every tile at the next refresh
+  int last_redrawn_ = 0;
+};
+
+}  // namespace sz::debugui
+
+#endif
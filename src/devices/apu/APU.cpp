@@ -1,19 +1,85 @@
 #include "devices/apu/APU.h"
 
+#include "core/log/Trace.h"
+
 namespace sz::apu {
 
 void APU::Reset() {
   last_cpu_tstates_ = 0;
+  regs_.fill(0);
+  psg_.Reset();
+  psg_phase_ = 0;
+  sample_phase_ = 0;
+  mix_sum_ = 0;
+  mix_count_ = 0;
 }
 
 void APU::Tick(int cpu_tstates_elapsed) {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryApu, "apu_tick");
   last_cpu_tstates_ = cpu_tstates_elapsed;
+  psg_phase_ += cpu_tstates_elapsed;
+  while (psg_phase_ >= kTstatesPerPsgTick) {
+    psg_phase_ -= kTstatesPerPsgTick;
+    psg_.Tick();
+    mix_sum_ += psg_.Output();
+    ++mix_count_;
+    sample_phase_ += static_cast<u32>(kMasterClocksPerPsgTick) * kSampleRate;
+    if (sample_phase_ >= static_cast<u32>(kMasterClockHz)) {
+      sample_phase_ -= static_cast<u32>(kMasterClockHz);
+      if (output_enabled_) {
+        samples_->push_back(static_cast<s16>(mix_sum_ / mix_count_));
+      }
+      mix_sum_ = 0;
+      mix_count_ = 0;
+    }
+  }
+}
+
+void APU::WritePort(u8 port, u8 value) {
+  regs_[port - kPortFirst] = value;
+  if (port == kPortPsgData) {
+    psg_.Write(value);
+  }
+}
+
+void APU::SetOutputEnabled(bool enabled) {
+  output_enabled_ = enabled;
 }
 
 DebugState APU::GetDebugState() const {
   DebugState state;
   state.last_cpu_tstates = last_cpu_tstates_;
+  for (int ch = 0; ch < 3; ++ch) {
+    state.tone_period[ch] = psg_.GetTonePeriod(ch);
+  }
+  for (int ch = 0; ch < 4; ++ch) {
+    state.volume[ch] = psg_.GetVolume(ch);
+  }
+  state.noise_ctrl = psg_.GetNoiseControl();
+  state.frame_samples = static_cast<int>(samples_->size());
   return state;
 }
 
+void APU::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteS32(last_cpu_tstates_);
+  writer.WriteBytes(regs_.data(), regs_.size());
+  psg_.SaveState(writer);
+  writer.WriteS32(psg_phase_);
+  writer.WriteU32(sample_phase_);
+  writer.WriteS32(mix_sum_);
+  writer.WriteS32(mix_count_);
+}
+
+void APU::LoadState(sz::state::StateReader& reader) {
+  last_cpu_tstates_ = reader.ReadS32();
+  reader.ReadBytes(regs_.data(), regs_.size());
+  psg_.LoadState(reader);
+  psg_phase_ = reader.ReadS32();
+  sample_phase_ = reader.ReadU32();
+  mix_sum_ = reader.ReadS32();
+  mix_count_ = reader.ReadS32();
+  reader.Expect(psg_phase_ >= 0 && psg_phase_ < kTstatesPerPsgTick &&
+                sample_phase_ < static_cast<u32>(kMasterClockHz) && mix_count_ >= 0);
+}
+
 }  // namespace sz::apu
@@ -1,20 +1,70 @@
 #ifndef SUPERZ80_DEVICES_APU_APU_H
 #define SUPERZ80_DEVICES_APU_APU_H
 
+#include <array>
+#include <vector>
+
+#include "core/state/SaveState.h"
+#include "core/types.h"
+#include "devices/apu/PSG.h"
+
 namespace sz::apu {
 
+constexpr size_t kAudioRegCount = 32;  // ports 0x60-0x7F (PSG, OPM, PCM, mixer)
+constexpr u8 kPortFirst = 0x60;
+constexpr u8 kPortLast = 0x7F;
+
+// Mono signed 16-bit output. The PSG runs at master / 6 / 16, which is 24
+// CPU T-states (master / 4) per tick; each output sample averages the
+// ticks it covers.
+constexpr int kSampleRate = 44100;
+constexpr int kMasterClockHz = 21477270;
+constexpr int kTstatesPerPsgTick = 24;
+constexpr int kMasterClocksPerPsgTick = 96;
+
 struct DebugState {
   int last_cpu_tstates = 0;
+  std::array<u16, 3> tone_period{};
+  std::array<u8, 4> volume{};
+  u8 noise_ctrl = 0;
+  int frame_samples = 0;
 };
 
 class APU {
  public:
+  // Samples go to a buffer owned by the caller, since their number varies
+  // from frame to frame; set by the owner, again after every copy of the
+  // APU.
+  void AttachSamples(std::vector<s16>* samples) { samples_ = samples; }
+  // Chip state only; the attached samples are the owner's to clear.
   void Reset();
   void Tick(int cpu_tstates_elapsed);
   DebugState GetDebugState() const;
 
+  u8 ReadPort(u8 port) const { return regs_[port - kPortFirst]; }
+  void WritePort(u8 port, u8 value);
+
+  // Samples produced since the last BeginFrame.
+  void BeginFrame() { samples_->clear(); }
+  const std::vector<s16>& GetSamples() const { return *samples_; }
+
+  // Host-side switch for speculative frames. Chips still advance; generated
+  // samples are dropped. Not part of the save state.
+  void SetOutputEnabled(bool enabled);
+
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
+  bool output_enabled_ = true;
   int last_cpu_tstates_ = 0;
+  std::array<u8, kAudioRegCount> regs_{};
+  PSG psg_{};
+  int psg_phase_ = 0;     // T-states toward the next PSG tick
+  u32 sample_phase_ = 0;  // master clocks x kSampleRate toward the next sample
+  s32 mix_sum_ = 0;
+  s32 mix_count_ = 0;
+  std::vector<s16>* samples_ = nullptr;
 };
 
 }  // namespace sz::apu
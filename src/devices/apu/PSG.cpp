@@ -0,0 +1,124 @@
+#include "devices/apu/PSG.h"
+
+namespace sz::apu {
+
+namespace {
+// 2 dB per attenuation step.
+constexpr int kVolumeTable[16] = {8191, 6506, 5168, 4105, 3261, 2590, 2057, 1634,
+                                  1298, 1031, 819,  651,  517,  411,  326,  0};
+constexpr u16 kLfsrReset = 0x8000;
+constexpr u16 kWhiteNoiseTaps = 0x0009;
+}  // namespace
+
+void PSG::Reset() {
+  tone_period_.fill(1);
+  tone_counter_.fill(1);
+  tone_output_.fill(0);
+  volume_.fill(15);
+  noise_ctrl_ = 0;
+  noise_counter_ = NoisePeriod();
+  noise_phase_ = 0;
+  lfsr_ = kLfsrReset;
+  latch_ = 0;
+}
+
+void PSG::Write(u8 value) {
+  // Latch bytes (bit 7 set) carry channel, type and the low 4 bits; data
+  // bytes update the latched register.
+  if (value & 0x80) {
+    latch_ = value;
+  }
+  const int ch = (latch_ >> 5) & 3;
+  const bool volume = (latch_ & 0x10) != 0;
+  if (volume) {
+    volume_[ch] = value & 0x0F;
+    return;
+  }
+  if (ch == 3) {
+    noise_ctrl_ = value & 0x07;
+    lfsr_ = kLfsrReset;
+    return;
+  }
+  int period = tone_period_[ch];
+  if (value & 0x80) {
+    period = (period & 0x3F0) | (value & 0x0F);
+  } else {
+    period = (period & 0x00F) | ((value & 0x3F) << 4);
+  }
+  // A period of 0 behaves like 1: the output toggles every tick, which is
+  // above audible range.
+  tone_period_[ch] = period == 0 ? 1 : period;
+}
+
+int PSG::NoisePeriod() const {
+  switch (noise_ctrl_ & 3) {
+    case 0:
+      return 0x10;
+    case 1:
+      return 0x20;
+    case 2:
+      return 0x40;
+    default:
+      return tone_period_[2];
+  }
+}
+
+void PSG::ShiftNoise() {
+  // White noise feeds back the parity of the tapped bits (0 and 3);
+  // periodic noise recirculates bit 0.
+  u16 feedback = lfsr_ & 1;
+  if (noise_ctrl_ & 0x04) {
+    const u16 taps = lfsr_ & kWhiteNoiseTaps;
+    feedback = static_cast<u16>((taps ^ (taps >> 3)) & 1);
+  }
+  lfsr_ = static_cast<u16>((lfsr_ >> 1) | (feedback << 15));
+}
+
+int PSG::Output() const {
+  int sum = 0;
+  for (int ch = 0; ch < 3; ++ch) {
+    const int amplitude = kVolumeTable[volume_[ch]];
+    sum += tone_output_[ch] ? amplitude : -amplitude;
+  }
+  const int noise = kVolumeTable[volume_[3]];
+  sum += (lfsr_ & 1) ? noise : -noise;
+  return sum;
+}
+
+void PSG::SaveState(sz::state::StateWriter& writer) const {
+  for (int ch = 0; ch < 3; ++ch) {
+    writer.WriteU16(static_cast<u16>(tone_period_[ch]));
+    writer.WriteU16(static_cast<u16>(tone_counter_[ch]));
+    writer.WriteU8(tone_output_[ch]);
+  }
+  writer.WriteBytes(volume_.data(), volume_.size());
+  writer.WriteU8(noise_ctrl_);
+  writer.WriteU16(static_cast<u16>(noise_counter_));
+  writer.WriteU8(noise_phase_);
+  writer.WriteU16(lfsr_);
+  writer.WriteU8(latch_);
+}
+
+void PSG::LoadState(sz::state::StateReader& reader) {
+  for (int ch = 0; ch < 3; ++ch) {
+    tone_period_[ch] = reader.ReadU16();
+    tone_counter_[ch] = reader.ReadU16();
+    tone_output_[ch] = reader.ReadU8();
+  }
+  reader.ReadBytes(volume_.data(), volume_.size());
+  noise_ctrl_ = reader.ReadU8();
+  noise_counter_ = reader.ReadU16();
+  noise_phase_ = reader.ReadU8();
+  lfsr_ = reader.ReadU16();
+  latch_ = reader.ReadU8();
+  // Volumes index the attenuation table; periods are 10 bits and never 0.
+  for (int ch = 0; ch < 3; ++ch) {
+    reader.Expect(tone_period_[ch] >= 1 && tone_period_[ch] <= 0x3FF);
+  }
+  for (const u8 volume : volume_) {
+    reader.Expect(volume < 16);
+  }
+  reader.Expect(noise_ctrl_ <= 0x07);
+}
+
+}  // namespace sz::apu
@@ -0,0 +1,64 @@
+#ifndef SUPERZ80_DEVICES_APU_PSG_H
+#define SUPERZ80_DEVICES_APU_PSG_H
+
+#include <array>
+
+#include "core/state/SaveState.h"
+#include "core/types.h"
+
+namespace sz::apu {
+
+constexpr u8 kPortPsgData = 0x60;
+
+// SN76489-style PSG: three square-wave tones and a noise channel written
+// through one latch/data port. Tick() is one step of the chip's internal
+// divide-by-16 clock.
+class PSG {
+ public:
+  void Reset();
+  void Write(u8 value);
+
+  void Tick() {
+    for (int ch = 0; ch < 3; ++ch) {
+      if (--tone_counter_[ch] <= 0) {
+        tone_counter_[ch] = tone_period_[ch];
+        tone_output_[ch] ^= 1;
+      }
+    }
+    if (--noise_counter_ <= 0) {
+      noise_counter_ = NoisePeriod();
+      noise_phase_ ^= 1;
+      if (noise_phase_) {
+        ShiftNoise();
+      }
+    }
+  }
+
+  // Signed sum of the four channels; fits in 16 bits.
+  int Output() const;
+
+  u16 GetTonePeriod(int ch) const { return tone_period_[ch]; }
+  u8 GetVolume(int ch) const { return volume_[ch]; }
+  u8 GetNoiseControl() const { return noise_ctrl_; }
+
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
+ private:
+  int NoisePeriod() const;
+  void ShiftNoise();
+
+  std::array<int, 3> tone_period_{};
+  std::array<int, 3> tone_counter_{};
+  std::array<u8, 3> tone_output_{};
+  std::array<u8, 4> volume_{};  // attenuation, 15 is silent
+  u8 noise_ctrl_ = 0;
+  int noise_counter_ = 0;
+  u8 noise_phase_ = 0;
+  u16 lfsr_ = 0x8000;
+  u8 latch_ = 0;  // last latch byte: channel and register type
+};
+
+}  // namespace sz::apu
+
+#endif
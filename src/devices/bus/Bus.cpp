@@ -1,26 +1,219 @@
 #include "devices/bus/Bus.h"
 
+#include <algorithm>
+
 namespace sz::bus {
 
+namespace {
+bool IsPortWatch(WatchKind kind) {
+  return kind == WatchKind::In || kind == WatchKind::Out;
+}
+}  // namespace
+
+bool WatchList::Add(const Watchpoint& watch) {
+  if (watch.first > watch.last || (IsPortWatch(watch.kind) && watch.last > 0xFF)) {
+    return false;
+  }
+  if (std::find(watchpoints_.begin(), watchpoints_.end(), watch) == watchpoints_.end()) {
+    watchpoints_.push_back(watch);
+    RebuildFlags();
+  }
+  return true;
+}
+
+void WatchList::Remove(const Watchpoint& watch) {
+  std::erase(watchpoints_, watch);
+  RebuildFlags();
+}
+
+void WatchList::Clear() {
+  watchpoints_.clear();
+  RebuildFlags();
+}
+
+bool WatchList::Matches(WatchKind kind, u16 address) const {
+  return std::any_of(watchpoints_.begin(), watchpoints_.end(), [&](const Watchpoint& watch) {
+    return watch.kind == kind && address >= watch.first && address <= watch.last;
+  });
+}
+
+void WatchList::RebuildFlags() {
+  for (auto& flags : flags_) {
+    flags.reset();
+  }
+  for (const Watchpoint& watch : watchpoints_) {
+    const int shift = IsPortWatch(watch.kind) ? 0 : 8;
+    for (int i = watch.first >> shift; i <= watch.last >> shift; ++i) {
+      flags_[static_cast<int>(watch.kind)].set(static_cast<size_t>(i));
+    }
+  }
+}
+
+void Bus::Attach(const Devices& devices) {
+  devices_ = devices;
+}
+
 void Bus::Reset() {
+  last_in_port_ = 0;
+  last_out_port_ = 0;
+  last_out_value_ = 0;
+  watch_hit_pending_ = false;
 }
 
-u8 Bus::Read8(u16 /*addr*/) {
+u8 Bus::ReadMemory(u16 addr) {
+  if (addr >= kWorkRamWindowBase) {
+    return work_ram_->Read(addr - kWorkRamWindowBase);
+  }
+  if (addr < sz::cart::kRomWindowEnd) {
+    return devices_.cart->Read8(addr);
+  }
   return 0xFF;
 }
 
-void Bus::Write8(u16 /*addr*/, u8 /*value*/) {
+template <bool kWatch>
+u8 Bus::Read8(u16 addr) {
+  const u8 value = ReadMemory(addr);
+  if constexpr (kWatch) {
+    if (watches_->IsFlagged(WatchKind::Read, addr >> 8)) {
+      CheckWatch(WatchKind::Read, addr, value);
+    }
+  }
+  return value;
 }
 
-u8 Bus::In8(u8 /*port*/) {
-  return 0xFF;
+template <bool kWatch>
+void Bus::Write8(u16 addr, u8 value) {
+  if constexpr (kWatch) {
+    if (watches_->IsFlagged(WatchKind::Write, addr >> 8)) {
+      CheckWatch(WatchKind::Write, addr, value);
+    }
+  }
+  if (addr >= kWorkRamWindowBase) {
+    work_ram_->Write(addr - kWorkRamWindowBase, value);
+  }
 }
 
-void Bus::Out8(u8 /*port*/, u8 /*value*/) {
+template <bool kWatch>
+u8 Bus::In8(u8 port) {
+  last_in_port_ = port;
+  const u8 value = ReadPortDevice(port);
+  if constexpr (kWatch) {
+    if (watches_->IsFlagged(WatchKind::In, port)) {
+      CheckWatch(WatchKind::In, port, value);
+    }
+  }
+  return value;
+}
+
+template <bool kWatch>
+void Bus::Out8(u8 port, u8 value) {
+  last_out_port_ = port;
+  last_out_value_ = value;
+  if constexpr (kWatch) {
+    if (watches_->IsFlagged(WatchKind::Out, port)) {
+      CheckWatch(WatchKind::Out, port, value);
+    }
+  }
+  WritePortDevice(port, value);
+}
+
+template u8 Bus::Read8<false>(u16 addr);
+template u8 Bus::Read8<true>(u16 addr);
+template void Bus::Write8<false>(u16 addr, u8 value);
+template void Bus::Write8<true>(u16 addr, u8 value);
+template u8 Bus::In8<false>(u8 port);
+template u8 Bus::In8<true>(u8 port);
+template void Bus::Out8<false>(u8 port, u8 value);
+template void Bus::Out8<true>(u8 port, u8 value);
+
+u8 Bus::ReadPortDevice(u8 port) {
+  if (port <= sz::cart::kPortLast) {
+    return devices_.cart->ReadPort(port);
+  }
+  if (port >= sz::ppu::kPortVideoFirst && port <= sz::ppu::kPortSpriteLast) {
+    return devices_.ppu->ReadPort(port);
+  }
+  if (port >= sz::dma::kPortFirst && port <= sz::dma::kPortLast) {
+    return devices_.dma->ReadPort(port);
+  }
+  if (port >= sz::apu::kPortFirst && port <= sz::apu::kPortLast) {
+    return devices_.apu->ReadPort(port);
+  }
+  switch (port) {
+    case sz::input::kPortPad1:
+    case sz::input::kPortPad1Sys:
+    case sz::input::kPortPad2:
+    case sz::input::kPortPad2Sys:
+      return devices_.input->ReadPort(port);
+    case sz::irq::kPortIrqStatus:
+      return devices_.irq->ReadStatus();
+    case sz::irq::kPortIrqEnable:
+      return devices_.irq->ReadEnable();
+    default:
+      return 0xFF;
+  }
+}
+
+void Bus::WritePortDevice(u8 port, u8 value) {
+  if (port <= sz::cart::kPortLast) {
+    devices_.cart->WritePort(port, value);
+    return;
+  }
+  if (port >= sz::ppu::kPortVideoFirst && port <= sz::ppu::kPortSpriteLast) {
+    devices_.ppu->WritePort(port, value);
+    return;
+  }
+  if (port >= sz::dma::kPortFirst && port <= sz::dma::kPortLast) {
+    devices_.dma->WritePort(port, value);
+    return;
+  }
+  if (port >= sz::apu::kPortFirst && port <= sz::apu::kPortLast) {
+    devices_.apu->WritePort(port, value);
+    return;
+  }
+  switch (port) {
+    case sz::irq::kPortIrqEnable:
+      devices_.irq->WriteEnable(value);
+      break;
+    case sz::irq::kPortIrqAck:
+      devices_.irq->Acknowledge(value);
+      break;
+    default:
+      break;
+  }
 }
 
 DebugState Bus::GetDebugState() const {
-  return DebugState{};
+  DebugState state;
+  state.last_in_port = last_in_port_;
+  state.last_out_port = last_out_port_;
+  state.last_out_value = last_out_value_;
+  return state;
+}
+
+bool Bus::TakeWatchHit(WatchHit& out) {
+  if (!watch_hit_pending_) {
+    return false;
+  }
+  out = watch_hit_;
+  watch_hit_pending_ = false;
+  return true;
+}
+
+void Bus::CheckWatch(WatchKind kind, u16 address, u8 value) {
+  if (!watch_hit_pending_ && watches_->Matches(kind, address)) {
+    watch_hit_ = {kind, address, value};
+    watch_hit_pending_ = true;
+  }
+}
+
+void Bus::SaveState(sz::state::StateWriter& writer) const {
+  work_ram_->ForEachPage([&](const u8* page, size_t size) { writer.WriteBytes(page, size); });
+}
+
+void Bus::LoadState(sz::state::StateReader& reader) {
+  work_ram_->UpdatePages([&](u8* incoming, const u8*, size_t size) { reader.ReadBytes(incoming, size); });
+  watch_hit_pending_ = false;
 }
 
 }  // namespace sz::bus
@@ -1,22 +1,132 @@
 #ifndef SUPERZ80_DEVICES_BUS_BUS_H
 #define SUPERZ80_DEVICES_BUS_BUS_H
 
+#include <array>
+#include <bitset>
+#include <vector>
+
+#include "core/state/SaveState.h"
 #include "core/types.h"
+#include "core/util/CowMemory.h"
+#include "devices/apu/APU.h"
+#include "devices/cart/Cartridge.h"
+#include "devices/dma/DMAEngine.h"
+#include "devices/input/InputController.h"
+#include "devices/irq/IRQController.h"
+#include "devices/ppu/PPU.h"
 
 namespace sz::bus {
 
+constexpr size_t kWorkRamSize = 0x8000;       // 32 KB total
+constexpr u16 kWorkRamWindowBase = 0xC000;    // 16 KB fixed window
+constexpr size_t kWorkRamPageSize = 0x400;    // copy-on-write granule
+
+// Paged so cloned consoles copy only the pages they write (see
+// SuperZ80Console::Clone). Owned by the console, outside the bus.
+using WorkRam = sz::util::CowMemory<kWorkRamSize, kWorkRamPageSize>;
+
+// Devices the bus decodes memory and ports to. Owned by the console.
+struct Devices {
+  sz::cart::Cartridge* cart = nullptr;
+  sz::ppu::PPU* ppu = nullptr;
+  sz::apu::APU* apu = nullptr;
+  sz::dma::DMAEngine* dma = nullptr;
+  sz::irq::IRQController* irq = nullptr;
+  sz::input::InputController* input = nullptr;
+};
+
 struct DebugState {
-  bool placeholder = true;
+  u8 last_in_port = 0;
+  u8 last_out_port = 0;
+  u8 last_out_value = 0;
+};
+
+// Debugger watchpoints on CPU data accesses. Address ranges for Read/Write,
+// port ranges (0x00-0xFF) for In/Out; both ends inclusive. Instruction
+// fetches never hit a Read watch; PC breakpoints cover execution.
+enum class WatchKind : u8 { Read, Write, In, Out };
+constexpr int kWatchKindCount = 4;
+
+struct Watchpoint {
+  WatchKind kind = WatchKind::Read;
+  u16 first = 0;
+  u16 last = 0;
+
+  bool operator==(const Watchpoint&) const = default;
+};
+
+struct WatchHit {
+  WatchKind kind = WatchKind::Read;
+  u16 address = 0;  // or port
+  u8 value = 0;     // read or written
+};
+
+// The debugger's watchpoints. Kept outside the bus, so they survive Reset
+// and LoadState and the bus stays trivially copyable. One flag per
+// 256-byte page (Read/Write) or per port (In/Out), indexed by WatchKind;
+// the list is only searched on a flagged access.
+class WatchList {
+ public:
+  // False for an empty or out-of-range watch.
+  bool Add(const Watchpoint& watch);
+  void Remove(const Watchpoint& watch);
+  void Clear();
+  bool IsEmpty() const { return watchpoints_.empty(); }
+  const std::vector<Watchpoint>& Get() const { return watchpoints_; }
+  bool IsFlagged(WatchKind kind, size_t index) const { return flags_[static_cast<int>(kind)][index]; }
+  bool Matches(WatchKind kind, u16 address) const;
+
+ private:
+  void RebuildFlags();
+
+  std::array<std::bitset<256>, kWatchKindCount> flags_{};
+  std::vector<Watchpoint> watchpoints_{};
 };
 
 class Bus {
  public:
+  void Attach(const Devices& devices);
+  // Set by the owner, again after every copy of the bus.
+  void AttachWorkRam(WorkRam* work_ram) { work_ram_ = work_ram; }
+  void AttachWatchList(const WatchList* watches) { watches_ = watches; }
+  // Port latches and any pending hit; work RAM is cleared by its owner.
   void Reset();
+  // kWatch selects the instrumented accessors, which also check the
+  // attached watchpoints; the CPU uses them only while the console has
+  // something armed. Both are compiled in Bus.cpp, so the plain ones are unchanged.
+  template <bool kWatch = false>
   u8 Read8(u16 addr);
+  template <bool kWatch = false>
   void Write8(u16 addr, u8 value);
+  template <bool kWatch = false>
   u8 In8(u8 port);
+  template <bool kWatch = false>
   void Out8(u8 port, u8 value);
   DebugState GetDebugState() const;
+
+  // The first hit since the last call; later ones are dropped until then.
+  // A pending hit does not survive Reset or LoadState.
+  bool HasWatchHit() const { return watch_hit_pending_; }
+  bool TakeWatchHit(WatchHit& out);
+
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
+ private:
+  u8 ReadMemory(u16 addr);
+  u8 ReadPortDevice(u8 port);
+  void WritePortDevice(u8 port, u8 value);
+  void CheckWatch(WatchKind kind, u16 address, u8 value);
+
+  Devices devices_{};
+  WorkRam* work_ram_ = nullptr;
+  u8 last_in_port_ = 0;
+  u8 last_out_port_ = 0;
+  u8 last_out_value_ = 0;
+
+  const WatchList* watches_ = nullptr;
+  WatchHit watch_hit_{};
+  bool watch_hit_pending_ = false;
 };
 
 }  // namespace sz::bus
@@ -1,19 +1,128 @@
 #include "devices/cart/Cartridge.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "core/log/Logger.h"
+#include "core/log/Trace.h"
+
 namespace sz::cart {
 
-bool Cartridge::LoadFromFile(const std::string& /*path*/) {
-  loaded_ = false;
-  return loaded_;
+const std::vector<u8>& Cartridge::GetRom() const {
+  static const std::vector<u8> kEmpty;
+  return rom_ ? *rom_ : kEmpty;
+}
+
+RomImage ReadRomImage(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    SZ_LOG_ERROR("Cartridge: cannot open %s", path.c_str());
+    return nullptr;
+  }
+  const std::vector<u8> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return MakeRomImage(image.data(), image.size());
+}
+
+RomImage MakeRomImage(const u8* data, size_t size) {
+  if (!data || size == 0 || size > kMaxRomSize) {
+    SZ_LOG_ERROR("Cartridge: rejected ROM image of %zu bytes", size);
+    return nullptr;
+  }
+  const size_t bank_count = (size + kRomBankSize - 1) / kRomBankSize;
+  auto rom = std::make_shared<std::vector<u8>>(bank_count * kRomBankSize, 0xFF);
+  std::copy(data, data + size, rom->begin());
+  SZ_LOG_INFO("Cartridge: %zu bytes, %zu banks", size, bank_count);
+  return rom;
+}
+
+void Cartridge::Attach(const std::vector<u8>* rom) {
+  rom_ = rom;
+  rom_data_ = rom ? rom->data() : nullptr;
+  bank_count_ = rom ? rom->size() / kRomBankSize : 0;
+  loaded_ = rom != nullptr;
+  UpdateWindow();
 }
 
 void Cartridge::Reset() {
+  // Bank 0 mapped at the reset vector and bank 1 in the window, so an
+  // unbanked 32 KB image appears linearly; mapper returns to defaults.
+  map_ctrl_ = 0;
+  rom_bank_0_ = 1;
+  rom_bank_1_ = 0;
+  sram_bank_ = 0;
+  UpdateWindow();
+}
+
+u8 Cartridge::ReadPort(u8 port) const {
+  switch (port) {
+    case kPortMapCtrl:
+      return map_ctrl_;
+    case kPortRomBank0:
+      return rom_bank_0_;
+    case kPortRomBank1:
+      return rom_bank_1_;
+    case kPortSramBank:
+      return sram_bank_;
+    default:
+      return 0xFF;
+  }
+}
+
+void Cartridge::WritePort(u8 port, u8 value) {
+  switch (port) {
+    case kPortMapCtrl:
+      map_ctrl_ = value;
+      break;
+    case kPortRomBank0:
+      SZ_TRACE(sz::trace::kCategoryCart, "bank_switch", port, value);
+      rom_bank_0_ = value;
+      UpdateWindow();
+      break;
+    case kPortRomBank1:
+      SZ_TRACE(sz::trace::kCategoryCart, "bank_switch", port, value);
+      rom_bank_1_ = value;
+      break;
+    case kPortSramBank:
+      SZ_TRACE(sz::trace::kCategoryCart, "bank_switch", port, value);
+      sram_bank_ = value;
+      break;
+    default:
+      break;
+  }
+}
+
+void Cartridge::UpdateWindow() {
+  // Bank numbers past the end of the image mirror, as on a mapper that
+  // ignores the unused high address lines.
+  window_offset_ = bank_count_ == 0 ? 0 : (rom_bank_0_ % bank_count_) * kRomBankSize;
 }
 
 DebugState Cartridge::GetDebugState() const {
   DebugState state;
   state.loaded = loaded_;
+  state.rom_size = rom_ ? rom_->size() : 0;
+  state.bank_count = static_cast<int>(bank_count_);
+  state.map_ctrl = map_ctrl_;
+  state.rom_bank_0 = rom_bank_0_;
+  state.rom_bank_1 = rom_bank_1_;
+  state.sram_bank = sram_bank_;
   return state;
 }
 
+void Cartridge::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteU8(map_ctrl_);
+  writer.WriteU8(rom_bank_0_);
+  writer.WriteU8(rom_bank_1_);
+  writer.WriteU8(sram_bank_);
+}
+
+void Cartridge::LoadState(sz::state::StateReader& reader) {
+  map_ctrl_ = reader.ReadU8();
+  rom_bank_0_ = reader.ReadU8();
+  rom_bank_1_ = reader.ReadU8();
+  sram_bank_ = reader.ReadU8();
+  UpdateWindow();
+}
+
 }  // namespace sz::cart
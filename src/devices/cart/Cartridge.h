@@ -1,22 +1,80 @@
 #ifndef SUPERZ80_DEVICES_CART_CARTRIDGE_H
 #define SUPERZ80_DEVICES_CART_CARTRIDGE_H
 
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "core/state/SaveState.h"
+#include "core/types.h"
 
 namespace sz::cart {
 
+constexpr size_t kRomBankSize = 0x4000;              // 16 KB
+constexpr size_t kMaxRomSize = 256 * kRomBankSize;   // ROM_BANK_0 is 8 bits
+constexpr u16 kRomWindowEnd = 0x8000;                // 0x0000-0x7FFF
+
+// Mapper registers (ports 0x00-0x03).
+constexpr u8 kPortMapCtrl = 0x00;
+constexpr u8 kPortRomBank0 = 0x01;
+constexpr u8 kPortRomBank1 = 0x02;
+constexpr u8 kPortSramBank = 0x03;
+constexpr u8 kPortLast = 0x0F;
+
 struct DebugState {
   bool loaded = false;
+  size_t rom_size = 0;
+  int bank_count = 0;
+  u8 map_ctrl = 0;
+  u8 rom_bank_0 = 0;
+  u8 rom_bank_1 = 0;
+  u8 sram_bank = 0;
 };
 
+// ROM images are immutable once built, so consoles and their clones share
+// one. Null when the image is rejected.
+using RomImage = std::shared_ptr<const std::vector<u8>>;
+RomImage ReadRomImage(const std::string& path);
+// Copies the data, padded with 0xFF to a whole number of banks.
+RomImage MakeRomImage(const u8* data, size_t size);
+
 class Cartridge {
  public:
-  bool LoadFromFile(const std::string& path);
+  // The image stays owned by the caller, which attaches it again after
+  // every copy of the cartridge; null ejects.
+  void Attach(const std::vector<u8>* rom);
+  bool IsLoaded() const { return loaded_; }
+  const std::vector<u8>& GetRom() const;
   void Reset();
+
+  // 0x0000-0x3FFF is fixed bank 0; 0x4000-0x7FFF is the ROM_BANK_0 window.
+  u8 Read8(u16 addr) const {
+    if (!loaded_) {
+      return 0xFF;
+    }
+    return addr < kRomBankSize ? rom_data_[addr] : rom_data_[window_offset_ + (addr - kRomBankSize)];
+  }
+
+  u8 ReadPort(u8 port) const;
+  void WritePort(u8 port, u8 value);
   DebugState GetDebugState() const;
 
+  // Mapper registers only; ROM contents are immutable and never serialized.
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
+  void UpdateWindow();
+
   bool loaded_ = false;
+  const std::vector<u8>* rom_ = nullptr;
+  const u8* rom_data_ = nullptr;
+  size_t bank_count_ = 0;
+  size_t window_offset_ = kRomBankSize;
+  u8 map_ctrl_ = 0;
+  u8 rom_bank_0_ = 1;
+  u8 rom_bank_1_ = 0;
+  u8 sram_bank_ = 0;
 };
 
 }  // namespace sz::cart
@@ -1,19 +1,151 @@
 #include "devices/dma/DMAEngine.h"
 
+#include "core/log/Logger.h"
+#include "core/log/Trace.h"
+#include "core/util/Assert.h"
+#include "devices/bus/Bus.h"
+#include "devices/ppu/PPU.h"
+
 namespace sz::dma {
 
+void DMAEngine::Attach(sz::bus::Bus* bus, sz::ppu::PPU* ppu) {
+  bus_ = bus;
+  ppu_ = ppu;
+}
+
 void DMAEngine::Reset() {
   ticks_ = 0;
+  src_ = 0;
+  dst_ = 0;
+  len_ = 0;
+  ctrl_ = 0;
+  queued_ = false;
+  in_vblank_ = false;
+  transfers_ = 0;
+  rejected_ = 0;
 }
 
-void DMAEngine::Tick() {
+void DMAEngine::Tick(int next_scanline) {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryDma, "dma_tick");
   ++ticks_;
+  in_vblank_ = next_scanline >= kVBlankStartScanline && next_scanline < kTotalScanlines;
+  if (queued_ && in_vblank_) {
+    queued_ = false;
+    Transfer();
+  }
+}
+
+u8 DMAEngine::ReadPort(u8 port) const {
+  switch (port) {
+    case kPortSrcLo:
+      return static_cast<u8>(src_);
+    case kPortSrcHi:
+      return static_cast<u8>(src_ >> 8);
+    case kPortDstLo:
+      return static_cast<u8>(dst_);
+    case kPortDstHi:
+      return static_cast<u8>(dst_ >> 8);
+    case kPortLenLo:
+      return static_cast<u8>(len_);
+    case kPortLenHi:
+      return static_cast<u8>(len_ >> 8);
+    case kPortCtrl:
+      return static_cast<u8>((ctrl_ & ~(kCtrlStart | kCtrlBusy)) | (queued_ ? kCtrlBusy : 0));
+    default:
+      return 0xFF;
+  }
+}
+
+void DMAEngine::WritePort(u8 port, u8 value) {
+  switch (port) {
+    case kPortSrcLo:
+      src_ = static_cast<u16>((src_ & 0xFF00) | value);
+      break;
+    case kPortSrcHi:
+      src_ = static_cast<u16>((src_ & 0x00FF) | (value << 8));
+      break;
+    case kPortDstLo:
+      dst_ = static_cast<u16>((dst_ & 0xFF00) | value);
+      break;
+    case kPortDstHi:
+      dst_ = static_cast<u16>((dst_ & 0x00FF) | (value << 8));
+      break;
+    case kPortLenLo:
+      len_ = static_cast<u16>((len_ & 0xFF00) | value);
+      break;
+    case kPortLenHi:
+      len_ = static_cast<u16>((len_ & 0x00FF) | (value << 8));
+      break;
+    case kPortCtrl:
+      ctrl_ = value;
+      if ((value & kCtrlStart) == 0) {
+        break;
+      }
+      if (in_vblank_) {
+        Transfer();
+      } else if (value & kCtrlQueueIfNotVBlank) {
+        queued_ = true;
+      } else {
+        ++rejected_;
+        SZ_LOG_DEBUG("DMA: START outside VBlank dropped (src %04X dst %04X len %u)", src_, dst_, len_);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void DMAEngine::Transfer() {
+  SZ_ASSERT(bus_ && ppu_);
+  SZ_TRACE(sz::trace::kCategoryDma, "dma_transfer", (static_cast<u32>(src_) << 16) | dst_, len_);
+  const bool palette = (ctrl_ & kCtrlDstPalette) != 0;
+  for (u32 i = 0; i < len_; ++i) {
+    const u8 value = bus_->Read8(static_cast<u16>(src_ + i));
+    if (palette) {
+      ppu_->WritePalette(static_cast<u8>(dst_ + i), value);
+    } else {
+      ppu_->WriteVram(static_cast<u16>(dst_ + i), value);
+    }
+  }
+  ++transfers_;
 }
 
 DebugState DMAEngine::GetDebugState() const {
   DebugState state;
   state.ticks = ticks_;
+  state.src = src_;
+  state.dst = dst_;
+  state.len = len_;
+  state.ctrl = ctrl_;
+  state.queued = queued_;
+  state.in_vblank = in_vblank_;
+  state.transfers = transfers_;
+  state.rejected = rejected_;
   return state;
 }
 
+void DMAEngine::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteS32(ticks_);
+  writer.WriteU16(src_);
+  writer.WriteU16(dst_);
+  writer.WriteU16(len_);
+  writer.WriteU8(ctrl_);
+  writer.WriteBool(queued_);
+  writer.WriteBool(in_vblank_);
+  writer.WriteS32(transfers_);
+  writer.WriteS32(rejected_);
+}
+
+void DMAEngine::LoadState(sz::state::StateReader& reader) {
+  ticks_ = reader.ReadS32();
+  src_ = reader.ReadU16();
+  dst_ = reader.ReadU16();
+  len_ = reader.ReadU16();
+  ctrl_ = reader.ReadU8();
+  queued_ = reader.ReadBool();
+  in_vblank_ = reader.ReadBool();
+  transfers_ = reader.ReadS32();
+  rejected_ = reader.ReadS32();
+}
+
 }  // namespace sz::dma
@@ -1,20 +1,78 @@
 #ifndef SUPERZ80_DEVICES_DMA_DMAENGINE_H
 #define SUPERZ80_DEVICES_DMA_DMAENGINE_H
 
+#include "core/state/SaveState.h"
+#include "core/types.h"
+
+namespace sz::bus {
+class Bus;
+}
+namespace sz::ppu {
+class PPU;
+}
+
 namespace sz::dma {
 
+// DMA ports 0x30-0x36.
+constexpr u8 kPortSrcLo = 0x30;
+constexpr u8 kPortSrcHi = 0x31;
+constexpr u8 kPortDstLo = 0x32;
+constexpr u8 kPortDstHi = 0x33;
+constexpr u8 kPortLenLo = 0x34;
+constexpr u8 kPortLenHi = 0x35;
+constexpr u8 kPortCtrl = 0x36;
+constexpr u8 kPortFirst = 0x30;
+constexpr u8 kPortLast = 0x3F;
+
+// DMA_CTRL. DST_PALETTE targets palette RAM (byte address) instead of VRAM,
+// which the diagnostic cartridge relies on for its palette upload.
+constexpr u8 kCtrlStart = 0x01;
+constexpr u8 kCtrlBusy = 0x02;
+constexpr u8 kCtrlQueueIfNotVBlank = 0x04;
+constexpr u8 kCtrlDstPalette = 0x08;
+
 struct DebugState {
   int ticks = 0;
+  u16 src = 0;
+  u16 dst = 0;
+  u16 len = 0;
+  u8 ctrl = 0;
+  bool queued = false;
+  bool in_vblank = false;
+  int transfers = 0;
+  int rejected = 0;
 };
 
+// Copies CPU address space to VRAM or palette RAM, instantly, and only
+// while the beam is in VBlank. A START outside VBlank is queued for the
+// next VBlank when QUEUE_IF_NOT_VBLANK is set, otherwise dropped.
 class DMAEngine {
  public:
+  void Attach(sz::bus::Bus* bus, sz::ppu::PPU* ppu);
   void Reset();
-  void Tick();
+  // Called after each scanline; `next_scanline` is the line the CPU runs next.
+  void Tick(int next_scanline);
+  u8 ReadPort(u8 port) const;
+  void WritePort(u8 port, u8 value);
   DebugState GetDebugState() const;
 
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
+  void Transfer();
+
+  sz::bus::Bus* bus_ = nullptr;
+  sz::ppu::PPU* ppu_ = nullptr;
   int ticks_ = 0;
+  u16 src_ = 0;
+  u16 dst_ = 0;
+  u16 len_ = 0;
+  u8 ctrl_ = 0;
+  bool queued_ = false;
+  bool in_vblank_ = false;
+  int transfers_ = 0;
+  int rejected_ = 0;
 };
 
 }  // namespace sz::dma
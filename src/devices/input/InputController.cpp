@@ -2,18 +2,73 @@
 
 namespace sz::input {
 
+u8 PackButtons(const HostButtons& buttons) {
+  u8 bits = 0;
+  bits |= buttons.up ? 0x01 : 0;
+  bits |= buttons.down ? 0x02 : 0;
+  bits |= buttons.left ? 0x04 : 0;
+  bits |= buttons.right ? 0x08 : 0;
+  bits |= buttons.a ? 0x10 : 0;
+  bits |= buttons.b ? 0x20 : 0;
+  bits |= buttons.start ? 0x40 : 0;
+  bits |= buttons.select ? 0x80 : 0;
+  return bits;
+}
+
+HostButtons UnpackButtons(u8 bits) {
+  HostButtons buttons;
+  buttons.up = (bits & 0x01) != 0;
+  buttons.down = (bits & 0x02) != 0;
+  buttons.left = (bits & 0x04) != 0;
+  buttons.right = (bits & 0x08) != 0;
+  buttons.a = (bits & 0x10) != 0;
+  buttons.b = (bits & 0x20) != 0;
+  buttons.start = (bits & 0x40) != 0;
+  buttons.select = (bits & 0x80) != 0;
+  return buttons;
+}
+
 void InputController::Reset() {
-  buttons_ = HostButtons{};
+  pads_.fill(0);
+}
+
+void InputController::SetHostButtons(int pad, const HostButtons& buttons) {
+  pads_[static_cast<size_t>(pad)] = PackButtons(buttons);
 }
 
-void InputController::SetHostButtons(const HostButtons& buttons) {
-  buttons_ = buttons;
+void InputController::SetPadSampler(PadSampler sampler, void* context) {
+  sampler_ = sampler;
+  sampler_context_ = context;
+}
+
+u8 InputController::ReadPort(u8 port) {
+  const int pad = (port - kPortPad1) >> 1;
+  u8& bits = pads_[static_cast<size_t>(pad)];
+  if (sampler_) {
+    // Keep what the game saw, so snapshots taken mid-game stay consistent.
+    bits = sampler_(sampler_context_, pad);
+  }
+  if (port & 1) {
+    return static_cast<u8>(bits >> 6);  // start, select
+  }
+  return static_cast<u8>(bits & 0x3F);
 }
 
 DebugState InputController::GetDebugState() const {
   DebugState state;
-  state.buttons = buttons_;
+  for (size_t i = 0; i < pads_.size(); ++i) {
+    state.pads[i] = UnpackButtons(pads_[i]);
+  }
+  state.live = sampler_ != nullptr;
   return state;
 }
 
+void InputController::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteBytes(pads_.data(), pads_.size());
+}
+
+void InputController::LoadState(sz::state::StateReader& reader) {
+  reader.ReadBytes(pads_.data(), pads_.size());
+}
+
 }  // namespace sz::input
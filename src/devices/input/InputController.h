@@ -1,8 +1,20 @@
 #ifndef SUPERZ80_DEVICES_INPUT_INPUTCONTROLLER_H
 #define SUPERZ80_DEVICES_INPUT_INPUTCONTROLLER_H
 
+#include <array>
+
+#include "core/state/SaveState.h"
+#include "core/types.h"
+
 namespace sz::input {
 
+constexpr int kPadCount = 2;
+
+constexpr u8 kPortPad1 = 0x40;
+constexpr u8 kPortPad1Sys = 0x41;
+constexpr u8 kPortPad2 = 0x42;
+constexpr u8 kPortPad2Sys = 0x43;
+
 struct HostButtons {
   bool up = false;
   bool down = false;
@@ -14,18 +26,39 @@ struct HostButtons {
   bool select = false;
 };
 
+// One bit per button, in HostButtons field order (bit 0 = up).
+u8 PackButtons(const HostButtons& buttons);
+HostButtons UnpackButtons(u8 bits);
+
+// Returns the packed buttons currently held on `pad`. Invoked from the CPU's
+// IN instruction, so it must be cheap and must not call into the host API.
+using PadSampler = u8 (*)(void* context, int pad);
+
 struct DebugState {
-  HostButtons buttons;
+  std::array<HostButtons, kPadCount> pads{};
+  bool live = false;
 };
 
+// PAD ports (active high):
+//   PADn     bit 0-3 up/down/left/right, bit 4-5 buttons A/B
+//   PADn_SYS bit 0 start, bit 1 select
+// Without a sampler the ports return the buttons latched for the frame.
+// With one, each read samples the host, so input can change mid-frame.
 class InputController {
  public:
   void Reset();
-  void SetHostButtons(const HostButtons& buttons);
+  void SetHostButtons(int pad, const HostButtons& buttons);
+  void SetPadSampler(PadSampler sampler, void* context);
+  u8 ReadPort(u8 port);
   DebugState GetDebugState() const;
 
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
-  HostButtons buttons_{};
+  std::array<u8, kPadCount> pads_{};
+  PadSampler sampler_ = nullptr;
+  void* sampler_context_ = nullptr;
 };
 
 }  // namespace sz::input
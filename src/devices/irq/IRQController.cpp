@@ -1,12 +1,37 @@
 #include "devices/irq/IRQController.h"
 
+#include "core/log/Trace.h"
+
 namespace sz::irq {
 
 void IRQController::Reset() {
-  int_asserted_ = false;
+  pending_ = 0;
+  enable_ = 0;
+  SetLine(false);
+}
+
+void IRQController::SetIntLineCallback(IntLineCallback callback, void* context) {
+  callback_ = callback;
+  callback_context_ = context;
+}
+
+u8 IRQController::ReadStatus() const {
+  return pending_;
+}
+
+u8 IRQController::ReadEnable() const {
+  return enable_;
+}
+
+void IRQController::WriteEnable(u8 mask) {
+  enable_ = mask;
+  UpdateLine();
 }
 
-void IRQController::Tick() {
+void IRQController::Acknowledge(u8 mask) {
+  pending_ &= static_cast<u8>(~mask);
+  SZ_TRACE(sz::trace::kCategoryIrq, "irq_ack", mask, pending_);
+  UpdateLine();
 }
 
 bool IRQController::IsIntAsserted() const {
@@ -16,7 +41,38 @@ bool IRQController::IsIntAsserted() const {
 DebugState IRQController::GetDebugState() const {
   DebugState state;
   state.int_asserted = int_asserted_;
+  state.pending = pending_;
+  state.enable = enable_;
   return state;
 }
 
+void IRQController::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteU8(pending_);
+  writer.WriteU8(enable_);
+}
+
+void IRQController::LoadState(sz::state::StateReader& reader) {
+  pending_ = reader.ReadU8();
+  enable_ = reader.ReadU8();
+  // The line is derived state; re-deriving it also resynchronises the CPU.
+  int_asserted_ = (pending_ & enable_) != 0;
+  if (callback_) {
+    callback_(callback_context_, int_asserted_);
+  }
+}
+
+void IRQController::UpdateLine() {
+  const bool asserted = (pending_ & enable_) != 0;
+  if (asserted != int_asserted_) {
+    SetLine(asserted);
+  }
+}
+
+void IRQController::SetLine(bool asserted) {
+  int_asserted_ = asserted;
+  if (callback_) {
+    callback_(callback_context_, asserted);
+  }
+}
+
 }  // namespace sz::irq
@@ -1,21 +1,65 @@
 #ifndef SUPERZ80_DEVICES_IRQ_IRQCONTROLLER_H
 #define SUPERZ80_DEVICES_IRQ_IRQCONTROLLER_H
 
+#include "core/state/SaveState.h"
+#include "core/types.h"
+
 namespace sz::irq {
 
+// IRQ_STATUS / IRQ_ENABLE / IRQ_ACK bit assignments (ports 0x80-0x82).
+constexpr u8 kSourceVBlank = 0x01;
+constexpr u8 kSourceTimer = 0x02;
+constexpr u8 kSourceScanline = 0x04;
+constexpr u8 kSourceSpriteOverflow = 0x08;
+constexpr u8 kSourceDmaDone = 0x10;
+
+constexpr u8 kPortIrqStatus = 0x80;
+constexpr u8 kPortIrqEnable = 0x81;
+constexpr u8 kPortIrqAck = 0x82;
+
+// Called only when the level-sensitive /INT line changes.
+using IntLineCallback = void (*)(void* context, bool asserted);
+
 struct DebugState {
   bool int_asserted = false;
+  u8 pending = 0;
+  u8 enable = 0;
 };
 
 class IRQController {
  public:
   void Reset();
-  void Tick();
+  void SetIntLineCallback(IntLineCallback callback, void* context);
+
+  // Devices latch sources with a single OR; the line is only re-evaluated
+  // when it could newly assert.
+  void Raise(u8 sources) {
+    pending_ |= sources;
+    if (!int_asserted_ && (pending_ & enable_) != 0) {
+      SetLine(true);
+    }
+  }
+
+  u8 ReadStatus() const;
+  u8 ReadEnable() const;
+  void WriteEnable(u8 mask);
+  void Acknowledge(u8 mask);  // write-1-to-clear
+
   bool IsIntAsserted() const;
   DebugState GetDebugState() const;
 
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
+  void UpdateLine();
+  void SetLine(bool asserted);
+
+  u8 pending_ = 0;
+  u8 enable_ = 0;
   bool int_asserted_ = false;
+  IntLineCallback callback_ = nullptr;
+  void* callback_context_ = nullptr;
 };
 
 }  // namespace sz::irq
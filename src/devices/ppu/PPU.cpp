@@ -1,19 +1,426 @@
 #include "devices/ppu/PPU.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "core/log/Trace.h"
+#include "core/util/Assert.h"
+
 namespace sz::ppu {
 
+namespace {
+constexpr u8 kCoverPlaneB = 0x01;
+constexpr u8 kCoverPriority = 0x02;
+constexpr u32 kBlack = 0xFF000000u;
+
+// 9-bit palette entry (R in bits 8-6, G 5-3, B 2-0) to ARGB8888.
+constexpr std::array<u32, 512> kRgbLut = [] {
+  std::array<u32, 512> lut{};
+  for (u32 entry = 0; entry < lut.size(); ++entry) {
+    auto expand = [](u32 v) { return (v << 5) | (v << 2) | (v >> 1); };
+    lut[entry] = 0xFF000000u | (expand((entry >> 6) & 7) << 16) | (expand((entry >> 3) & 7) << 8) |
+                 expand(entry & 7);
+  }
+  return lut;
+}();
+
+// Base registers may point past the end of VRAM; fetches wrap.
+inline size_t Wrap(size_t addr) {
+  return addr < kVramSize ? addr : addr % kVramSize;
+}
+
+// Entries are two bytes, low byte first; only bit 0 of the high byte is
+// stored. Byte addresses wrap within the 256-byte palette.
+void StorePaletteByte(std::array<u16, kPaletteEntries>& palette, u8 addr, u8 value) {
+  u16& entry = palette[addr >> 1];
+  if (addr & 1) {
+    entry = static_cast<u16>((entry & 0x00FF) | ((value & 0x01) << 8));
+  } else {
+    entry = static_cast<u16>((entry & 0x0100) | value);
+  }
+}
+}  // namespace
+
+u32 PaletteToArgb(u16 entry) {
+  return kRgbLut[entry & 0x1FF];
+}
+
+void PpuMemory::Clear() {
+  vram.Fill(0);
+  for (u32& version : tile_versions) {
+    ++version;
+  }
+  ++palette_version;
+}
+
 void PPU::Reset() {
   last_scanline_ = -1;
+  video_regs_.fill(0);
+  sprite_regs_.fill(0);
+  palette_.fill(0);
+  line_sprite_count_ = 0;
+  ResetRaster();
 }
 
-void PPU::RenderScanline(int scanline, Framebuffer& /*fb*/) {
+void PPU::ResetRaster() {
+  raster_.video_regs = video_regs_;
+  raster_.sprite_regs = sprite_regs_;
+  raster_.palette = palette_;
+  write_log_size_ = 0;
+  next_line_ = OwedEnd();
+}
+
+void PPU::EndScanline(int scanline) {
   last_scanline_ = scanline;
+  if (scanline == 0) {
+    Reg(kPortVdpStatus) &= static_cast<u8>(~kStatusSpriteOverflow);
+  }
+  if (scanline == kScreenHeight - 1) {
+    CatchUp();
+  } else if (scanline == kTotalScanlines - 1) {
+    next_line_ = 0;
+  }
+}
+
+void PPU::CatchUp() {
+  const int end = OwedEnd();
+  if (next_line_ >= end) {
+    return;  // nothing owed, so nothing logged either
+  }
+  SZ_TRACE_SCOPE(sz::trace::kCategoryPpu, "ppu_catch_up");
+  SZ_ASSERT(framebuffer_ != nullptr);
+  size_t applied = 0;
+  for (; next_line_ < end; ++next_line_) {
+    for (; applied < write_log_size_ && write_log_[applied].scanline <= next_line_; ++applied) {
+      ApplyRasterWrite(write_log_[applied]);
+    }
+    RenderScanline(next_line_, *framebuffer_);
+  }
+  // The rest were made on the CPU's current line, which sees them all.
+  for (; applied < write_log_size_; ++applied) {
+    ApplyRasterWrite(write_log_[applied]);
+  }
+  write_log_size_ = 0;
+}
+
+void PPU::LogRasterWrite(u8 port, u8 palette_addr, u8 value) {
+  const RasterWrite write{static_cast<u16>(CpuLine()), port, palette_addr, value};
+  if (next_line_ < OwedEnd()) {
+    if (write_log_size_ < write_log_.size()) {
+      write_log_[write_log_size_++] = write;
+      return;
+    }
+    CatchUp();
+  }
+  ApplyRasterWrite(write);
+}
+
+void PPU::ApplyRasterWrite(const RasterWrite& write) {
+  if (write.port == kPortPalData) {
+    StorePaletteByte(raster_.palette, write.palette_addr, write.value);
+  } else if (write.port >= kPortSprCtrl) {
+    raster_.sprite_regs[write.port - kPortSprCtrl] = write.value;
+  } else {
+    raster_.video_regs[write.port - kPortVideoFirst] = write.value;
+  }
+}
+
+void PPU::RenderScanline(int scanline, Framebuffer& fb) {
+  SZ_TRACE_SCOPE(sz::trace::kCategoryPpu, "ppu_scanline");
+  if (scanline >= kScreenHeight) {
+    return;
+  }
+
+  // Evaluation latches overflow, so it runs even when output is off.
+  const u8 ctrl = RasterReg(kPortVdpCtrl);
+  const bool display = (ctrl & kCtrlDisplayEnable) != 0;
+  line_sprite_count_ = display ? EvaluateSprites(scanline) : 0;
+  if (!output_enabled_) {
+    return;
+  }
+
+  u32* out = fb.pixels.data() + static_cast<size_t>(scanline) * kScreenWidth;
+  if (!display) {
+    std::fill_n(out, kScreenWidth, kBlack);
+    return;
+  }
+
+  line_color_.fill(0);
+  line_cover_.fill(0);
+  if (ctrl & kCtrlPlaneAEnable) {
+    RenderPlane(scanline, RasterReg(kPortPlaneAScrollX), RasterReg(kPortPlaneAScrollY), RasterReg(kPortPlaneABase),
+                false);
+  }
+  if (ctrl & kCtrlPlaneBEnable) {
+    RenderPlane(scanline, RasterReg(kPortPlaneBScrollX), RasterReg(kPortPlaneBScrollY), RasterReg(kPortPlaneBBase),
+                true);
+  }
+  if (line_sprite_count_ > 0) {
+    RenderSprites(scanline, line_sprite_count_);
+  }
+
+  for (int x = 0; x < kScreenWidth; ++x) {
+    out[x] = kRgbLut[raster_.palette[line_color_[x]] & 0x1FF];
+  }
+}
+
+int PPU::EvaluateSprites(int scanline) {
+  const u8 spr_ctrl = RasterSpriteReg(kPortSprCtrl);
+  if ((spr_ctrl & kSprCtrlEnable) == 0) {
+    return 0;
+  }
+  const int height = ((spr_ctrl >> kSprCtrlSizeShift) & 3) == 0 ? 8 : 16;
+  const u8* sat = SpriteTable();
+  int count = 0;
+  for (int i = 0; i < kSpriteCount; ++i) {
+    const int dy = scanline - sat[i * kSpriteEntrySize];
+    if (dy < 0 || dy >= height) {
+      continue;
+    }
+    if (count == kSpritesPerLine) {
+      Reg(kPortVdpStatus) |= kStatusSpriteOverflow;
+      break;
+    }
+    line_sprites_[count++] = static_cast<u8>(i);
+  }
+  return count;
+}
+
+void PPU::RenderPlane(int scanline, u8 scroll_x, u8 scroll_y, u8 base, bool plane_b) {
+  const int y = (scanline + scroll_y) % (kTilemapHeight * 8);
+  const auto& vram = memory_->vram;
+  // A 64-byte map row is 64-byte aligned, so it sits inside one VRAM page;
+  // likewise every 4-byte tile row.
+  const u8* map_row =
+      vram.ReadPointer(Wrap(static_cast<size_t>(base) * kVramPageSize + static_cast<size_t>(y >> 3) * kTilemapWidth * 2));
+  const size_t pattern = static_cast<size_t>(RasterReg(kPortPatternBase)) * kVramPageSize;
+  const u8 cover_base = plane_b ? kCoverPlaneB : 0;
+
+  int x = 0;
+  int px = scroll_x;
+  while (x < kScreenWidth) {
+    const u8* map_entry = map_row + static_cast<size_t>((px & 0xFF) >> 3) * 2;
+    const u16 entry = static_cast<u16>(map_entry[0] | (map_entry[1] << 8));
+    const int fine_y = (entry & kTileVFlip) ? 7 - (y & 7) : (y & 7);
+    const u8* row = vram.ReadPointer(Wrap(pattern + (entry & kTileIndexMask) * kTileBytes + fine_y * 4));
+    const u8 palette = static_cast<u8>(((entry >> kTilePaletteShift) & 7) << 4);
+    const u8 cover = cover_base | ((entry & kTilePriority) ? kCoverPriority : 0);
+    const bool hflip = (entry & kTileHFlip) != 0;
+
+    for (int fine_x = px & 7; fine_x < 8 && x < kScreenWidth; ++fine_x, ++x, ++px) {
+      const int col = hflip ? 7 - fine_x : fine_x;
+      const u8 color = (col & 1) ? (row[col >> 1] & 0x0F) : (row[col >> 1] >> 4);
+      if (color != 0) {
+        line_color_[x] = palette | color;
+        line_cover_[x] = cover;
+      }
+    }
+  }
+}
+
+void PPU::RenderSprites(int scanline, int count) {
+  const u8 spr_ctrl = RasterSpriteReg(kPortSprCtrl);
+  const int size = (spr_ctrl >> kSprCtrlSizeShift) & 3;
+  const int height = size == 0 ? 8 : 16;
+  const int width = size == 2 ? 16 : 8;
+  const u8* sat = SpriteTable();
+  const auto& vram = memory_->vram;
+  const size_t pattern = static_cast<size_t>(RasterReg(kPortPatternBase)) * kVramPageSize;
+
+  // Back to front, so the lowest SAT index ends up on top.
+  for (int n = count - 1; n >= 0; --n) {
+    const u8* entry = sat + line_sprites_[n] * kSpriteEntrySize;
+    const int sprite_y = entry[0];
+    const int sprite_x = entry[1];
+    const u8 attr = entry[3];
+    const int tile = entry[2] | ((attr & kSpriteTileHigh) << 8);
+    const u8 palette = static_cast<u8>(((attr >> kSpritePaletteShift) & 7) << 4);
+    const u8 hidden_by = (attr & kSpriteBehind) ? (kCoverPriority | kCoverPlaneB) : kCoverPriority;
+
+    int dy = scanline - sprite_y;
+    if (attr & kSpriteVFlip) {
+      dy = height - 1 - dy;
+    }
+    // Multi-tile sprites use consecutive tiles, left to right then down.
+    const int row_tile = tile + (dy >> 3) * (width / 8);
+    const size_t row_offset = static_cast<size_t>(dy & 7) * 4;
+    std::array<const u8*, 2> rows{};
+    for (int t = 0; t < width / 8; ++t) {
+      rows[t] = vram.ReadPointer(Wrap(pattern + ((row_tile + t) & kTileIndexMask) * kTileBytes + row_offset));
+    }
+
+    for (int sx = 0; sx < width && sprite_x + sx < kScreenWidth; ++sx) {
+      const int x = sprite_x + sx;
+      const int tx = (attr & kSpriteHFlip) ? width - 1 - sx : sx;
+      const u8 byte = rows[tx >> 3][(tx & 7) >> 1];
+      const u8 color = (tx & 1) ? (byte & 0x0F) : (byte >> 4);
+      if (color != 0 && (line_cover_[x] & hidden_by) == 0) {
+        line_color_[x] = palette | color;
+      }
+    }
+  }
+}
+
+const u8* PPU::SpriteTable() const {
+  // 192 bytes from a 256-byte boundary never cross a 1 KB VRAM page.
+  static_assert(kSpriteCount * kSpriteEntrySize <= kSatPageSize && kVramPageSize % kSatPageSize == 0);
+  return memory_->vram.ReadPointer(Wrap(static_cast<size_t>(RasterSpriteReg(kPortSatBase)) * kSatPageSize));
+}
+
+u8 PPU::ReadPort(u8 port) {
+  switch (port) {
+    case kPortVdpStatus: {
+      // Overflow latches as lines are drawn and holds until line 0, so
+      // owed lines matter only while it is clear.
+      if ((Reg(kPortVdpStatus) & kStatusSpriteOverflow) == 0) {
+        CatchUp();
+      }
+      const int line = CpuLine();
+      const bool vblank = line >= kVBlankStartScanline;
+      return static_cast<u8>(Reg(kPortVdpStatus) | (vblank ? kStatusVBlank : 0));
+    }
+    case kPortVramData:
+      return memory_->vram.Read(Wrap(VramAddr()));
+    case kPortVramDataInc: {
+      const u16 addr = VramAddr();
+      SetVramAddr(static_cast<u16>(addr + 1));
+      return memory_->vram.Read(Wrap(addr));
+    }
+    case kPortPalData: {
+      const u8 addr = Reg(kPortPalAddr);
+      Reg(kPortPalAddr) = static_cast<u8>(addr + 1);
+      const u16 entry = palette_[addr >> 1];
+      return static_cast<u8>((addr & 1) ? (entry >> 8) : entry);
+    }
+    case kPortSprStatus:
+      if ((Reg(kPortVdpStatus) & kStatusSpriteOverflow) == 0) {
+        CatchUp();
+      }
+      return (Reg(kPortVdpStatus) & kStatusSpriteOverflow) ? 0x01 : 0x00;
+    default:
+      if (port >= kPortSprCtrl) {
+        return sprite_regs_[port - kPortSprCtrl];
+      }
+      return Reg(port);
+  }
+}
+
+void PPU::WritePort(u8 port, u8 value) {
+  switch (port) {
+    case kPortVdpStatus:
+      break;
+    case kPortVramData:
+      WriteVram(VramAddr(), value);
+      break;
+    case kPortVramDataInc: {
+      const u16 addr = VramAddr();
+      WriteVram(addr, value);
+      SetVramAddr(static_cast<u16>(addr + 1));
+      break;
+    }
+    case kPortPalData: {
+      const u8 addr = Reg(kPortPalAddr);
+      Reg(kPortPalAddr) = static_cast<u8>(addr + 1);
+      WritePalette(addr, value);
+      break;
+    }
+    case kPortSprStatus:
+      break;
+    default:
+      if (port >= kPortSprCtrl) {
+        sprite_regs_[port - kPortSprCtrl] = value;
+      } else {
+        Reg(port) = value;
+      }
+      LogRasterWrite(port, 0, value);
+      break;
+  }
+}
+
+void PPU::WritePalette(u8 addr, u8 value) {
+  StorePaletteByte(palette_, addr, value);
+  ++memory_->palette_version;
+  LogRasterWrite(kPortPalData, addr, value);
+}
+
+void PPU::CaptureVideoMemory(VideoMemory& out) const {
+  // Tiles never straddle a VRAM page.
+  static_assert(kVramPageSize % kTileBytes == 0);
+  for (size_t tile = 0; tile < kVramTiles; ++tile) {
+    if (out.tile_versions[tile] != memory_->tile_versions[tile]) {
+      std::memcpy(out.vram.data() + tile * kTileBytes, memory_->vram.ReadPointer(tile * kTileBytes), kTileBytes);
+      out.tile_versions[tile] = memory_->tile_versions[tile];
+    }
+  }
+  if (out.palette_version != memory_->palette_version) {
+    out.palette = palette_;
+    out.palette_version = memory_->palette_version;
+  }
+  out.video_regs = video_regs_;
+  out.sprite_regs = sprite_regs_;
+}
+
+u16 PPU::VramAddr() const {
+  return static_cast<u16>(Reg(kPortVramAddrLo) | (Reg(kPortVramAddrHi) << 8));
+}
+
+void PPU::SetVramAddr(u16 addr) {
+  Reg(kPortVramAddrLo) = static_cast<u8>(addr);
+  Reg(kPortVramAddrHi) = static_cast<u8>(addr >> 8);
+}
+
+void PPU::SetOutputEnabled(bool enabled) {
+  output_enabled_ = enabled;
 }
 
 DebugState PPU::GetDebugState() const {
   DebugState state;
   state.last_scanline = last_scanline_;
+  state.vdp_ctrl = Reg(kPortVdpCtrl);
+  state.spr_ctrl = SpriteReg(kPortSprCtrl);
+  state.vram_addr = VramAddr();
+  state.pal_addr = Reg(kPortPalAddr);
+  state.sprite_overflow = (Reg(kPortVdpStatus) & kStatusSpriteOverflow) != 0;
+  state.last_line_sprites = line_sprite_count_;
   return state;
 }
 
+void PPU::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteS32(last_scanline_);
+  writer.WriteBytes(video_regs_.data(), video_regs_.size());
+  writer.WriteBytes(sprite_regs_.data(), sprite_regs_.size());
+  for (u16 entry : palette_) {
+    writer.WriteU16(entry);
+  }
+  memory_->vram.ForEachPage([&](const u8* page, size_t size) { writer.WriteBytes(page, size); });
+}
+
+void PPU::LoadState(sz::state::StateReader& reader) {
+  last_scanline_ = reader.ReadS32();
+  // The raster resumes from this line, so it must name a real one.
+  reader.Expect(last_scanline_ >= -1 && last_scanline_ < kTotalScanlines);
+  reader.ReadBytes(video_regs_.data(), video_regs_.size());
+  reader.ReadBytes(sprite_regs_.data(), sprite_regs_.size());
+  const std::array<u16, kPaletteEntries> old_palette = palette_;
+  for (u16& entry : palette_) {
+    entry = reader.ReadU16();
+  }
+  if (palette_ != old_palette) {
+    ++memory_->palette_version;
+  }
+  // Run-ahead reloads a state every frame; only tiles that really differ
+  // get a new version, so viewers do not redraw everything each time, and
+  // only pages that differ stop being shared with clones.
+  size_t tile = 0;
+  memory_->vram.UpdatePages([&](u8* incoming, const u8* current, size_t size) {
+    reader.ReadBytes(incoming, size);
+    for (size_t offset = 0; offset < size; offset += kTileBytes, ++tile) {
+      if (std::memcmp(current + offset, incoming + offset, kTileBytes) != 0) {
+        ++memory_->tile_versions[tile];
+      }
+    }
+  });
+  ResetRaster();
+}
+
 }  // namespace sz::ppu
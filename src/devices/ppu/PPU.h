@@ -1,30 +1,241 @@
 #ifndef SUPERZ80_DEVICES_PPU_PPU_H
 #define SUPERZ80_DEVICES_PPU_PPU_H
 
-#include <vector>
+#include <array>
 
+#include "core/state/SaveState.h"
 #include "core/types.h"
+#include "core/util/CowMemory.h"
 
 namespace sz::ppu {
 
+constexpr size_t kVramSize = 0xC000;      // 48 KB shared tile/sprite pool
+constexpr size_t kPaletteEntries = 128;   // 9-bit RGB (3-3-3) per entry
+constexpr size_t kVideoRegCount = 16;     // ports 0x10-0x1F
+constexpr size_t kSpriteRegCount = 16;    // ports 0x20-0x2F
+
+// Video control (0x10-0x1F) and sprite (0x20-0x2F) ports. The register
+// file is indexed by port; VRAM and palette addresses live in it too.
+constexpr u8 kPortVideoFirst = 0x10;
+constexpr u8 kPortVdpStatus = 0x10;
+constexpr u8 kPortVdpCtrl = 0x11;
+constexpr u8 kPortPlaneAScrollX = 0x12;
+constexpr u8 kPortPlaneAScrollY = 0x13;
+constexpr u8 kPortPlaneBScrollX = 0x14;
+constexpr u8 kPortPlaneBScrollY = 0x15;
+constexpr u8 kPortPlaneABase = 0x16;
+constexpr u8 kPortPlaneBBase = 0x17;
+constexpr u8 kPortPatternBase = 0x18;
+constexpr u8 kPortWindowCtrl = 0x19;
+constexpr u8 kPortVramAddrLo = 0x1A;
+constexpr u8 kPortVramAddrHi = 0x1B;
+constexpr u8 kPortVramData = 0x1C;
+constexpr u8 kPortVramDataInc = 0x1D;
+constexpr u8 kPortPalAddr = 0x1E;
+constexpr u8 kPortPalData = 0x1F;
+constexpr u8 kPortSprCtrl = 0x20;
+constexpr u8 kPortSatBase = 0x21;
+constexpr u8 kPortSprStatus = 0x22;
+constexpr u8 kPortSpriteLast = 0x2F;
+
+// VDP_STATUS
+constexpr u8 kStatusVBlank = 0x01;
+constexpr u8 kStatusSpriteOverflow = 0x02;  // latched, cleared at line 0
+
+// VDP_CTRL
+constexpr u8 kCtrlDisplayEnable = 0x01;
+constexpr u8 kCtrlPlaneAEnable = 0x02;
+constexpr u8 kCtrlPlaneBEnable = 0x04;
+
+// SPR_CTRL: bit 0 enable, bits 1-2 size (0: 8x8, 1: 8x16, 2: 16x16).
+constexpr u8 kSprCtrlEnable = 0x01;
+constexpr int kSprCtrlSizeShift = 1;
+
+// Base registers count in these units.
+constexpr size_t kVramPageSize = 0x400;   // PLANE_A/B_BASE, PATTERN_BASE
+constexpr size_t kSatPageSize = 0x100;    // SAT_BASE
+
+// Tiles are 8x8, 4bpp packed, high nibble leftmost: 4 bytes per row.
+constexpr size_t kTileBytes = 32;
+constexpr int kTilemapWidth = 32;
+constexpr int kTilemapHeight = 24;
+
+constexpr size_t kVramTiles = kVramSize / kTileBytes;
+
+// Tilemap entry, 16-bit little endian.
+constexpr u16 kTileIndexMask = 0x01FF;
+constexpr int kTilePaletteShift = 9;  // 3 bits
+constexpr u16 kTileHFlip = 0x1000;
+constexpr u16 kTileVFlip = 0x2000;
+constexpr u16 kTilePriority = 0x4000;  // drawn above sprites
+
+// Sprite attribute table: 48 entries of Y, X, tile, attributes. A Y of 192
+// or more hides the sprite.
+constexpr int kSpriteCount = 48;
+constexpr int kSpritesPerLine = 16;
+constexpr size_t kSpriteEntrySize = 4;
+constexpr u8 kSpriteTileHigh = 0x01;   // tile index bit 8
+constexpr int kSpritePaletteShift = 1;  // 3 bits
+constexpr u8 kSpriteHFlip = 0x10;
+constexpr u8 kSpriteVFlip = 0x20;
+constexpr u8 kSpriteBehind = 0x40;     // hidden by opaque Plane B pixels
+
+// Fixed storage so the framebuffer lives inside its owner (the console)
+// rather than in a separate heap block; rows start on cache lines.
 struct Framebuffer {
-  std::vector<u32> pixels;
+  alignas(64) std::array<u32, static_cast<size_t>(kScreenWidth) * kScreenHeight> pixels{};
   int width = kScreenWidth;
   int height = kScreenHeight;
 };
 
+// Host-side copy of video memory for viewers on other threads. Every tile
+// carries the PPU's write version for it, so a copy is refreshed by moving
+// only tiles whose version changed, and a viewer re-rasterises only tiles
+// whose version moved since it last looked.
+struct VideoMemory {
+  std::array<u8, kVramSize> vram{};
+  std::array<u32, kVramTiles> tile_versions{};
+  std::array<u16, kPaletteEntries> palette{};
+  u32 palette_version = 0;
+  std::array<u8, kVideoRegCount> video_regs{};  // indexed by port - 0x10
+  std::array<u8, kSpriteRegCount> sprite_regs{};  // indexed by port - 0x20
+};
+
+// Video memory a PPU draws from, kept outside it so the PPU itself stays
+// trivially copyable (see SuperZ80Console). VRAM is paged so cloned
+// consoles share untouched pages; the versions are host-side bookkeeping
+// for CaptureVideoMemory and keep counting across Reset.
+struct PpuMemory {
+  sz::util::CowMemory<kVramSize, kVramPageSize> vram{};
+  std::array<u32, kVramTiles> tile_versions{};
+  u32 palette_version = 0;
+
+  // Zeroes VRAM and marks every tile and the palette changed.
+  void Clear();
+};
+
+// 9-bit palette entry to ARGB8888, as the PPU outputs it.
+u32 PaletteToArgb(u16 entry);
+
 struct DebugState {
   int last_scanline = -1;
+  u8 vdp_ctrl = 0;
+  u8 spr_ctrl = 0;
+  u16 vram_addr = 0;
+  u8 pal_addr = 0;
+  bool sprite_overflow = false;
+  int last_line_sprites = 0;
 };
 
+// Lines are drawn in batches rather than one per CPU line. Register and
+// palette writes land in the CPU-visible state at once and are also logged
+// with the scanline they happened on; while drawing, the log is replayed
+// into a separate raster state, each write just before the first line that
+// saw it. Mid-frame scroll, base, control and palette changes therefore
+// show on the same lines as when every line was drawn straight after the
+// CPU ran it. VRAM is not logged: a VRAM write, a status read (sprite
+// overflow) or a full log first draws every line the CPU has finished.
 class PPU {
  public:
+  // Registers, palette and line state; the attached memory is cleared by
+  // its owner.
   void Reset();
+  // Framebuffer the batches draw into and the memory they read; set by the
+  // owner, again after every copy of the PPU.
+  void AttachFramebuffer(Framebuffer* fb) { framebuffer_ = fb; }
+  void AttachMemory(PpuMemory* memory) { memory_ = memory; }
+  // Called after the CPU has run `scanline`. The visible lines are drawn
+  // when the last one ends.
+  void EndScanline(int scanline);
+  // Draws every finished line that is still owed.
+  void CatchUp();
+  // Draws one line from the raster state; for tools and the batches.
   void RenderScanline(int scanline, Framebuffer& fb);
   DebugState GetDebugState() const;
 
+  u8 ReadPort(u8 port);
+  void WritePort(u8 port, u8 value);
+
+  // Direct VRAM/palette writes for DMA; same semantics as the data ports,
+  // without touching the port address registers.
+  void WriteVram(u16 addr, u8 value) {
+    if (next_line_ < OwedEnd()) {
+      CatchUp();
+    }
+    const size_t wrapped = addr < kVramSize ? addr : addr % kVramSize;
+    memory_->vram.Write(wrapped, value);
+    ++memory_->tile_versions[wrapped / kTileBytes];
+  }
+  void WritePalette(u8 addr, u8 value);
+
+  // Brings `out` up to date, copying only tiles whose version changed.
+  void CaptureVideoMemory(VideoMemory& out) const;
+
+  // Host-side switch for speculative frames. Line state still advances;
+  // only pixel output is skipped. Not part of the save state.
+  void SetOutputEnabled(bool enabled);
+
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
+  u8& Reg(u8 port) { return video_regs_[port - kPortVideoFirst]; }
+  u8 Reg(u8 port) const { return video_regs_[port - kPortVideoFirst]; }
+  u8 SpriteReg(u8 port) const { return sprite_regs_[port - kPortSprCtrl]; }
+  u16 VramAddr() const;
+  void SetVramAddr(u16 addr);
+
+  // Register and palette contents as of the line being drawn.
+  struct RasterState {
+    std::array<u8, kVideoRegCount> video_regs{};
+    std::array<u8, kSpriteRegCount> sprite_regs{};
+    std::array<u16, kPaletteEntries> palette{};
+  };
+  // kPortPalData writes carry the palette byte address they resolved to.
+  struct RasterWrite {
+    u16 scanline = 0;
+    u8 port = 0;
+    u8 palette_addr = 0;
+    u8 value = 0;
+  };
+  static constexpr size_t kWriteLogCapacity = 1024;
+
+  u8 RasterReg(u8 port) const { return raster_.video_regs[port - kPortVideoFirst]; }
+  u8 RasterSpriteReg(u8 port) const { return raster_.sprite_regs[port - kPortSprCtrl]; }
+  // The line the CPU is running.
+  int CpuLine() const { return last_scanline_ + 1 < kTotalScanlines ? last_scanline_ + 1 : 0; }
+  // Lines before this are finished; those from next_line_ on are owed.
+  int OwedEnd() const { return CpuLine() < kScreenHeight ? CpuLine() : kScreenHeight; }
+  void LogRasterWrite(u8 port, u8 palette_addr, u8 value);
+  void ApplyRasterWrite(const RasterWrite& write);
+  void ResetRaster();
+
+  const u8* SpriteTable() const;
+  int EvaluateSprites(int scanline);
+  void RenderPlane(int scanline, u8 scroll_x, u8 scroll_y, u8 base, bool plane_b);
+  void RenderSprites(int scanline, int count);
+
+  bool output_enabled_ = true;
   int last_scanline_ = -1;
+  std::array<u8, kVideoRegCount> video_regs_{};
+  std::array<u8, kSpriteRegCount> sprite_regs_{};
+  std::array<u16, kPaletteEntries> palette_{};
+  // VRAM and its versions, which are bumped on every write (and on loads
+  // that change a tile).
+  PpuMemory* memory_ = nullptr;
+
+  // Batching; rebuilt from the registers on Reset and LoadState.
+  Framebuffer* framebuffer_ = nullptr;
+  RasterState raster_{};
+  int next_line_ = 0;  // first visible line not yet drawn this frame
+  size_t write_log_size_ = 0;
+  std::array<RasterWrite, kWriteLogCapacity> write_log_{};
+
+  // Per-line scratch, rebuilt by every RenderScanline.
+  int line_sprite_count_ = 0;
+  std::array<u8, kSpritesPerLine> line_sprites_{};
+  std::array<u8, kScreenWidth> line_color_{};  // palette index; 0 is the backdrop
+  std::array<u8, kScreenWidth> line_cover_{};  // kCover* bits of the plane pixel
 };
 
 }  // namespace sz::ppu
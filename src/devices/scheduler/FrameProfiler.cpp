@@ -0,0 +1,80 @@
+#include "devices/scheduler/FrameProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace sz::scheduler {
+
+namespace {
+s64 SteadyNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+u64 Percentile(std::array<u64, FrameProfiler::kWindowFrames> samples, int count, int percent) {
+  if (count == 0) {
+    return 0;
+  }
+  const int index = std::min(count - 1, count * percent / 100);
+  std::nth_element(samples.begin(), samples.begin() + index, samples.begin() + count);
+  return samples[index];
+}
+}  // namespace
+
+void FrameProfiler::EndFrameSlow() {
+  const u64 now = Now();
+  if (frames_ == 0) {
+    calibration_ticks_ = frame_start_;
+    calibration_ns_ = SteadyNanoseconds();
+  }
+  const size_t slot = frames_ % kWindowFrames;
+  for (int section = 0; section < kProfileSectionCount; ++section) {
+    window_[section][slot] = current_[section];
+    totals_[section] += current_[section];
+  }
+  window_[kProfileSectionCount][slot] = now - frame_start_;
+  totals_[kProfileSectionCount] += now - frame_start_;
+  ++frames_;
+}
+
+double FrameProfiler::TicksPerMicrosecond() const {
+#if defined(SUPERZ80_PROFILER_RDTSC)
+  const double elapsed_us = static_cast<double>(SteadyNanoseconds() - calibration_ns_) / 1000.0;
+  const double elapsed_ticks = static_cast<double>(Now() - calibration_ticks_);
+  return elapsed_us > 0.0 && elapsed_ticks > 0.0 ? elapsed_ticks / elapsed_us : 1.0;
+#else
+  return 1000.0;  // steady_clock nanoseconds
+#endif
+}
+
+ProfileDebugState FrameProfiler::GetDebugState() const {
+  ProfileDebugState state;
+  if constexpr (!kProfilerEnabled) {
+    return state;
+  }
+  state.frames = frames_;
+  state.window_frames = static_cast<int>(std::min<u64>(frames_, kWindowFrames));
+  if (frames_ == 0) {
+    return state;
+  }
+
+  const double us_per_tick = 1.0 / TicksPerMicrosecond();
+  const size_t last_slot = (frames_ - 1) % kWindowFrames;
+  const int count = state.window_frames;
+  for (int section = 0; section <= kProfileSectionCount; ++section) {
+    const auto& samples = window_[section];
+    u64 sum = 0;
+    for (int i = 0; i < count; ++i) {
+      sum += samples[i];
+    }
+    ProfileStats& stats = section < kProfileSectionCount ? state.sections[section] : state.frame;
+    stats.last_us = static_cast<double>(samples[last_slot]) * us_per_tick;
+    stats.mean_us = static_cast<double>(sum) / count * us_per_tick;
+    stats.p50_us = static_cast<double>(Percentile(samples, count, 50)) * us_per_tick;
+    stats.p99_us = static_cast<double>(Percentile(samples, count, 99)) * us_per_tick;
+    stats.total_ms = static_cast<double>(totals_[section]) * us_per_tick / 1000.0;
+  }
+  return state;
+}
+
+}  // namespace sz::scheduler
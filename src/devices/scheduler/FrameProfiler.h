@@ -0,0 +1,125 @@
+#ifndef SUPERZ80_DEVICES_SCHEDULER_FRAMEPROFILER_H
+#define SUPERZ80_DEVICES_SCHEDULER_FRAMEPROFILER_H
+
+#include <array>
+
+#include "core/types.h"
+
+#if !defined(SUPERZ80_ENABLE_PROFILER)
+#define SUPERZ80_ENABLE_PROFILER 0
+#endif
+
+#if SUPERZ80_ENABLE_PROFILER && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define SUPERZ80_PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+
+namespace sz::scheduler {
+
+// Host-time profiler for StepFrame. Compiled out unless
+// SUPERZ80_ENABLE_PROFILER is set; Mark()/Lap() then fold to nothing.
+constexpr bool kProfilerEnabled = SUPERZ80_ENABLE_PROFILER != 0;
+
+enum ProfileSection : int {
+  kProfileCpu,
+  kProfileIrq,
+  kProfilePpu,
+  kProfileDma,
+  kProfileApu,
+  kProfileSectionCount,
+};
+
+constexpr const char* kProfileSectionNames[kProfileSectionCount] = {"CPU", "IRQ", "PPU", "DMA", "APU"};
+
+// Microseconds per frame.
+struct ProfileStats {
+  double last_us = 0.0;
+  double mean_us = 0.0;  // rolling window
+  double p50_us = 0.0;
+  double p99_us = 0.0;
+  double total_ms = 0.0;  // since the profiler started
+};
+
+struct ProfileDebugState {
+  bool enabled = kProfilerEnabled;
+  u64 frames = 0;
+  int window_frames = 0;
+  std::array<ProfileStats, kProfileSectionCount> sections{};
+  ProfileStats frame{};  // whole StepFrame, including the scheduler itself
+};
+
+// Sections are timed as laps: each Lap() charges the time since the previous
+// Mark()/Lap() to one section, so one clock read covers one subsystem.
+class FrameProfiler {
+ public:
+  static constexpr int kWindowFrames = 256;
+
+  static u64 Now() {
+#if defined(SUPERZ80_PROFILER_RDTSC)
+    return __rdtsc();
+#elif SUPERZ80_ENABLE_PROFILER
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+#else
+    return 0;
+#endif
+  }
+
+  void BeginFrame() {
+    if constexpr (kProfilerEnabled) {
+      frame_start_ = Now();
+      last_ = frame_start_;
+      current_.fill(0);
+    }
+  }
+
+  void Mark() {
+    if constexpr (kProfilerEnabled) {
+      last_ = Now();
+    }
+  }
+
+  void Lap(ProfileSection section) {
+    if constexpr (kProfilerEnabled) {
+      const u64 now = Now();
+      current_[section] += now - last_;
+      last_ = now;
+    }
+  }
+
+  void EndFrame() {
+    if constexpr (kProfilerEnabled) {
+      EndFrameSlow();
+    }
+  }
+
+  ProfileDebugState GetDebugState() const;
+
+ private:
+  void EndFrameSlow();
+  double TicksPerMicrosecond() const;
+
+  u64 frame_start_ = 0;
+  u64 last_ = 0;
+  std::array<u64, kProfileSectionCount> current_{};
+
+  // Rolling window of per-frame ticks; slot kProfileSectionCount is the frame.
+  std::array<std::array<u64, kWindowFrames>, kProfileSectionCount + 1> window_{};
+  std::array<u64, kProfileSectionCount + 1> totals_{};
+  u64 frames_ = 0;
+
+  // First frame's clock pair, used to calibrate the TSC against steady_clock.
+  u64 calibration_ticks_ = 0;
+  s64 calibration_ns_ = 0;
+};
+
+}  // namespace sz::scheduler
+
+#endif
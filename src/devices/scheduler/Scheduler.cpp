@@ -7,6 +7,8 @@ namespace sz::scheduler {
 void Scheduler::Reset() {
   scanline_ = 0;
   frame_ = 0;
+  master_clock_remainder_ = 0;
+  cpu_tstates_total_ = 0;
 }
 
 void Scheduler::BeginFrame() {
@@ -26,6 +28,10 @@ u64 Scheduler::GetFrame() const {
 }
 
 void Scheduler::StepScanline() {
+  cpu_tstates_total_ += static_cast<u64>(ComputeCpuBudgetTstatesForScanline());
+  master_clock_remainder_ =
+      (master_clock_remainder_ + kMasterClocksPerScanline) % kCpuClockDivider;
+
   ++scanline_;
   if (scanline_ >= kTotalScanlines) {
     scanline_ = 0;
@@ -33,15 +39,33 @@ void Scheduler::StepScanline() {
 }
 
 int Scheduler::ComputeCpuBudgetTstatesForScanline() const {
-  return cpu_budget_tstates_;
+  return (master_clock_remainder_ + kMasterClocksPerScanline) / kCpuClockDivider;
 }
 
 DebugState Scheduler::GetDebugState() const {
   DebugState state;
   state.scanline = scanline_;
   state.frame = frame_;
-  state.cpu_budget_tstates = cpu_budget_tstates_;
+  state.cpu_budget_tstates = ComputeCpuBudgetTstatesForScanline();
+  state.master_clock_remainder = master_clock_remainder_;
+  state.cpu_tstates_total = cpu_tstates_total_;
   return state;
 }
 
+void Scheduler::SaveState(sz::state::StateWriter& writer) const {
+  writer.WriteS32(scanline_);
+  writer.WriteU64(frame_);
+  writer.WriteS32(master_clock_remainder_);
+  writer.WriteU64(cpu_tstates_total_);
+}
+
+void Scheduler::LoadState(sz::state::StateReader& reader) {
+  scanline_ = reader.ReadS32();
+  frame_ = reader.ReadU64();
+  master_clock_remainder_ = reader.ReadS32();
+  cpu_tstates_total_ = reader.ReadU64();
+  reader.Expect(scanline_ >= 0 && scanline_ < kTotalScanlines && master_clock_remainder_ >= 0 &&
+                master_clock_remainder_ < kCpuClockDivider);
+}
+
 }  // namespace sz::scheduler
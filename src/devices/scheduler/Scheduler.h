@@ -1,14 +1,24 @@
 #ifndef SUPERZ80_DEVICES_SCHEDULER_SCHEDULER_H
 #define SUPERZ80_DEVICES_SCHEDULER_SCHEDULER_H
 
+#include "core/state/SaveState.h"
 #include "core/types.h"
+#include "devices/scheduler/FrameProfiler.h"
 
 namespace sz::scheduler {
 
+// CPU_HZ / LINE_HZ = (21.47727 MHz / 4) / (21.47727 MHz / 1365) = 341.25
+// T-states per scanline. Kept exact by accumulating master clocks.
+constexpr int kMasterClocksPerScanline = 1365;
+constexpr int kCpuClockDivider = 4;
+
 struct DebugState {
   int scanline = 0;
   u64 frame = 0;
   int cpu_budget_tstates = 0;
+  int master_clock_remainder = 0;
+  u64 cpu_tstates_total = 0;
+  ProfileDebugState profile{};  // filled in by the console, which owns the profiler
 };
 
 class Scheduler {
@@ -22,10 +32,14 @@ class Scheduler {
   int ComputeCpuBudgetTstatesForScanline() const;
   DebugState GetDebugState() const;
 
+  void SaveState(sz::state::StateWriter& writer) const;
+  void LoadState(sz::state::StateReader& reader);
+
  private:
   int scanline_ = 0;
   u64 frame_ = 0;
-  int cpu_budget_tstates_ = 228;  // placeholder only
+  int master_clock_remainder_ = 0;  // master clocks not yet converted to T-states
+  u64 cpu_tstates_total_ = 0;
 };
 
 }  // namespace sz::scheduler
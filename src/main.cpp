@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <string>
 
@@ -13,23 +14,83 @@ int ParseScale(const char* value) {
     return 1;
   }
 }
+
+int ParseNonNegative(const char* value, int fallback) {
+  try {
+    int parsed = std::stoi(value);
+    return parsed >= 0 ? parsed : fallback;
+  } catch (...) {
+    return fallback;
+  }
+}
 }
 
 int main(int argc, char** argv) {
   sz::app::AppConfig config;
+  bool async_log = false;
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
     if (arg == "--scale" && i + 1 < argc) {
       config.scale = ParseScale(argv[++i]);
+    } else if (arg == "--filter" && i + 1 < argc) {
+      const std::string name = argv[++i];
+      if (!sz::app::ParseUpscaleFilter(name, config.upscale_filter)) {
+        SZ_LOG_WARN("Unknown --filter %s (none, nearest, scale2x, scale3x, xbr, crt)", name.c_str());
+      }
+    } else if (arg == "--filter-threads" && i + 1 < argc) {
+      config.upscale_threads = static_cast<unsigned>(ParseNonNegative(argv[++i], 0));
     } else if (arg == "--no-imgui") {
       config.enable_imgui = false;
+    } else if (arg == "--rewind-frames" && i + 1 < argc) {
+      config.rewind_interval_frames = ParseNonNegative(argv[++i], config.rewind_interval_frames);
+    } else if (arg == "--rewind-mb" && i + 1 < argc) {
+      config.rewind_budget_mb = ParseNonNegative(argv[++i], config.rewind_budget_mb);
+    } else if (arg == "--debug-interval" && i + 1 < argc) {
+      config.debug_interval_frames = std::max(1, ParseNonNegative(argv[++i], config.debug_interval_frames));
+    } else if (arg == "--no-rewind") {
+      config.rewind_interval_frames = 0;
+    } else if (arg == "--run-ahead" && i + 1 < argc) {
+      config.run_ahead_frames = ParseNonNegative(argv[++i], config.run_ahead_frames);
+    } else if (arg == "--run-ahead-thread") {
+      config.run_ahead_second_core = true;
+    } else if (arg == "--no-vsync") {
+      config.vsync = false;
+    } else if (arg == "--audio-latency" && i + 1 < argc) {
+      config.audio_latency_ms = ParseNonNegative(argv[++i], config.audio_latency_ms);
+    } else if (arg == "--headless") {
+      config.headless = true;
+    } else if (arg == "--frames" && i + 1 < argc) {
+      config.max_frames = static_cast<u64>(ParseNonNegative(argv[++i], 0));
+    } else if (arg == "--record" && i + 1 < argc) {
+      config.record_path = argv[++i];
+    } else if (arg == "--replay" && i + 1 < argc) {
+      config.replay_path = argv[++i];
+    } else if (arg == "--trace" && i + 1 < argc) {
+      config.trace_path = argv[++i];
+    } else if (arg == "--cpu-trace" && i + 1 < argc) {
+      config.cpu_trace_path = argv[++i];
+    } else if (arg == "--capture" && i + 1 < argc) {
+      config.capture_path = argv[++i];
+    } else if (arg == "--rom" && i + 1 < argc) {
+      config.rom_path = argv[++i];
+    } else if (arg == "--async-log") {
+      async_log = true;
     } else if (arg == "--help") {
-      SZ_LOG_INFO("Usage: superz80_app [--scale N] [--no-imgui]");
+      SZ_LOG_INFO("Usage: superz80_app [--rom PATH] [--scale N] [--filter NAME] [--filter-threads N] [--no-imgui] "
+                  "[--debug-interval N] [--rewind-frames N] [--rewind-mb N] [--no-rewind] [--run-ahead N] "
+                  "[--run-ahead-thread] [--no-vsync] [--audio-latency MS] "
+                  "[--headless] [--frames N] [--record PATH] [--replay PATH] [--trace PATH] "
+                  "[--cpu-trace PATH] [--capture PATH] [--async-log]");
       return 0;
     }
   }
 
+  if (async_log) {
+    sz::log::Logger::StartAsync();
+  }
   sz::app::App app(config);
-  return app.Run();
+  const int result = app.Run();
+  sz::log::Logger::StopAsync();
+  return result;
 }
@@ -0,0 +1,229 @@
+// superz80_batch: runs many short, independent cartridge sessions on a
+// work-stealing pool, one console per task. Each session powers on, plays
+// pseudo-random pad input seeded by its index for N frames, and records its
+// final framebuffer and state hashes. Sessions share nothing mutable: the
+// ROM image is read-only, results go to per-session slots, and each task
+// captures its own log messages.
+//
+// Reports aggregate throughput (frames/s across the pool) and, with
+// --scaling, repeats the batch at 1, 2, 4, ... threads and prints the
+// scaling efficiency of each step against the single-thread run.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "console/SuperZ80Console.h"
+#include "core/log/Logger.h"
+#include "core/util/WorkStealingPool.h"
+#include "devices/input/InputController.h"
+#include "tools/BenchCartridge.h"
+
+namespace {
+struct Options {
+  std::string rom_path;
+  u64 sessions = 64;
+  u64 frames = 300;
+  unsigned threads = 0;  // 0: one per hardware thread
+  bool scaling = false;
+  bool verbose = false;
+};
+
+struct Session {
+  bool loaded = false;
+  u64 framebuffer_hash = 0;
+  u64 state_hash = 0;
+  double wall_ms = 0.0;
+  int worker = -1;
+  std::vector<std::string> log;
+};
+
+struct BatchResult {
+  unsigned threads = 0;
+  double wall_s = 0.0;
+  u64 frames = 0;
+  u64 stolen = 0;
+  std::vector<Session> sessions;
+};
+
+// xorshift64; seeded per session so runs are reproducible.
+u64 NextRandom(u64& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+void RunSession(const std::vector<u8>& rom, u64 index, u64 frames, Session& session) {
+  const auto start = std::chrono::steady_clock::now();
+  sz::log::ScopedLogCapture capture(session.log);
+  session.worker = sz::util::WorkStealingPool::CurrentWorker();
+
+  auto console = std::make_unique<sz::console::SuperZ80Console>();
+  console->PowerOn();
+  session.loaded = console->LoadCartridge(rom.data(), rom.size());
+  if (!session.loaded) {
+    return;
+  }
+  console->Reset();
+
+  // Hold each random pad state for a few frames, like a player would.
+  u64 seed = 0x9E3779B97F4A7C15ull ^ (index + 1) * 0xBF58476D1CE4E5B9ull;
+  sz::input::HostButtons buttons;
+  for (u64 frame = 0; frame < frames; ++frame) {
+    if (frame % 8 == 0) {
+      buttons = sz::input::UnpackButtons(static_cast<u8>(NextRandom(seed)));
+    }
+    console->SetHostButtons(0, buttons);
+    console->StepFrame();
+  }
+  session.framebuffer_hash = console->GetFramebufferHash();
+  session.state_hash = console->GetStateHash();
+  session.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+BatchResult RunBatch(const std::vector<u8>& rom, const Options& options, unsigned threads) {
+  BatchResult result;
+  result.sessions.resize(options.sessions);
+  const auto start = std::chrono::steady_clock::now();
+  {
+    sz::util::WorkStealingPool pool(threads);
+    result.threads = pool.GetThreadCount();
+    for (u64 i = 0; i < options.sessions; ++i) {
+      pool.Submit([&rom, &options, &result, i] { RunSession(rom, i, options.frames, result.sessions[i]); });
+    }
+    pool.Wait();
+    for (const auto& stats : pool.GetStats()) {
+      result.stolen += stats.stolen;
+    }
+  }
+  result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (const Session& session : result.sessions) {
+    result.frames += session.loaded ? options.frames : 0;
+  }
+  return result;
+}
+
+double Throughput(const BatchResult& result) {
+  return result.wall_s > 0.0 ? static_cast<double>(result.frames) / result.wall_s : 0.0;
+}
+
+void PrintSessions(const BatchResult& result, bool verbose) {
+  for (size_t i = 0; i < result.sessions.size(); ++i) {
+    const Session& session = result.sessions[i];
+    if (verbose) {
+      std::printf("session %4zu worker %2d %8.1f ms  fb %016" PRIx64 "  state %016" PRIx64 "\n", i, session.worker,
+                  session.wall_ms, session.framebuffer_hash, session.state_hash);
+    }
+    for (const std::string& line : session.log) {
+      std::printf("session %4zu: %s\n", i, line.c_str());
+    }
+  }
+}
+
+bool ParseU64(const char* text, u64& out) {
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 10);
+  if (end == text || *end != '\0') {
+    return false;
+  }
+  out = value;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    bool ok = true;
+    u64 value = 0;
+    if (arg == "--rom" && i + 1 < argc) {
+      options.rom_path = argv[++i];
+    } else if (arg == "--sessions" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.sessions) && options.sessions > 0;
+    } else if (arg == "--frames" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.frames) && options.frames > 0;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], value) && value > 0;
+      options.threads = static_cast<unsigned>(value);
+    } else if (arg == "--scaling") {
+      options.scaling = true;
+    } else if (arg == "--verbose") {
+      options.verbose = true;
+    } else if (arg == "--help") {
+      SZ_LOG_INFO("Usage: superz80_batch [--rom PATH] [--sessions N] [--frames N] [--threads N] [--scaling] "
+                  "[--verbose]");
+      return 0;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      SZ_LOG_ERROR("Bad argument: %s", arg.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<u8> rom(std::begin(sz::tools::kBenchCartridge), std::end(sz::tools::kBenchCartridge));
+  if (!options.rom_path.empty()) {
+    std::ifstream file(options.rom_path, std::ios::binary);
+    if (!file) {
+      SZ_LOG_ERROR("Cannot open ROM %s", options.rom_path.c_str());
+      return 2;
+    }
+    rom.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  const unsigned max_threads =
+      options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<unsigned> steps;
+  if (options.scaling) {
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+      steps.push_back(threads);
+    }
+  }
+  steps.push_back(max_threads);
+
+  std::printf("%llu sessions x %llu frames\n", static_cast<unsigned long long>(options.sessions),
+              static_cast<unsigned long long>(options.frames));
+  std::printf("%8s %10s %12s %14s %10s %8s\n", "threads", "wall s", "frames/s", "per thread", "efficiency",
+              "stolen");
+  double single_thread = 0.0;
+  int failures = 0;
+  for (unsigned threads : steps) {
+    const BatchResult result = RunBatch(rom, options, threads);
+    const double throughput = Throughput(result);
+    if (result.threads == 1) {
+      single_thread = throughput;
+    }
+    const double per_thread = throughput / result.threads;
+    std::printf("%8u %10.3f %12.0f %14.0f", result.threads, result.wall_s, throughput, per_thread);
+    if (single_thread > 0.0) {
+      std::printf(" %9.1f%%", per_thread / single_thread * 100.0);
+    } else {
+      std::printf(" %10s", "-");
+    }
+    std::printf(" %8llu\n", static_cast<unsigned long long>(result.stolen));
+    std::fflush(stdout);
+
+    // Sessions are deterministic, so only the last run's details are shown.
+    if (threads == steps.back()) {
+      PrintSessions(result, options.verbose);
+      failures = static_cast<int>(std::count_if(result.sessions.begin(), result.sessions.end(),
+                                                [](const Session& session) { return !session.loaded; }));
+    }
+  }
+  if (failures > 0) {
+    SZ_LOG_ERROR("%d session(s) failed to load the ROM", failures);
+    return 1;
+  }
+  return 0;
+}
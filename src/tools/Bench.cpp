@@ -0,0 +1,561 @@
+// superz80_bench: micro-benchmarks of the hot paths (CPU opcode groups, bus
+// accesses, PPU lines, APU ticks, save states, host upscalers) and a
+// macro-benchmark that runs the bundled cartridge for N frames. Prints a
+// table, optionally writes JSON, and with --baseline flags any result that
+// got slower than the threshold (exit code 1).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/Upscaler.h"
+#include "console/SuperZ80Console.h"
+#include "core/log/Logger.h"
+#include "cpu/Z80Cpu.h"
+#include "devices/apu/APU.h"
+#include "devices/bus/Bus.h"
+#include "devices/cart/Cartridge.h"
+#include "devices/input/InputController.h"
+#include "devices/irq/IRQController.h"
+#include "devices/ppu/PPU.h"
+#include "tools/BenchCartridge.h"
+
+namespace {
+struct Options {
+  std::string filter;
+  std::string json_path;
+  std::string baseline_path;
+  double threshold_pct = 5.0;
+  double min_time_s = 0.2;
+  int repetitions = 5;
+  u64 frames = 600;
+  bool list = false;
+};
+
+struct Benchmark {
+  std::string name;
+  const char* unit;
+  // Performs about `iterations` units of work and returns how many it did.
+  std::function<u64(u64 iterations)> run;
+  // Non-zero: every sample runs exactly this many units, no calibration.
+  u64 fixed_iterations = 0;
+};
+
+struct Result {
+  std::string name;
+  const char* unit = "";
+  u64 iterations = 0;  // per sample
+  double ns_per_op = 0.0;  // median over samples
+  double ns_per_op_min = 0.0;
+  double ns_per_op_max = 0.0;
+};
+
+// Keeps reads the optimizer would otherwise drop.
+volatile u64 g_sink = 0;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+// A console's CPU and bus without the scheduler, so a single device can be
+// driven in isolation.
+struct Rig {
+  sz::cart::RomImage rom;
+  sz::bus::WorkRam work_ram;
+  sz::ppu::PpuMemory video_memory;
+  std::vector<s16> samples;
+  sz::cart::Cartridge cart;
+  sz::ppu::PPU ppu;
+  sz::apu::APU apu;
+  sz::irq::IRQController irq;
+  sz::input::InputController input;
+  // Aligned like the console's, so growing an unrelated device does not
+  // shift the CPU across cache lines and move the opcode numbers.
+  alignas(64) sz::bus::Bus bus;
+  alignas(64) sz::cpu::Z80Cpu cpu;
+
+  explicit Rig(const std::vector<u8>& image) {
+    sz::bus::Devices devices;
+    devices.cart = &cart;
+    devices.ppu = &ppu;
+    devices.apu = &apu;
+    devices.irq = &irq;
+    devices.input = &input;
+    bus.Attach(devices);
+    bus.AttachWorkRam(&work_ram);
+    ppu.AttachMemory(&video_memory);
+    apu.AttachSamples(&samples);
+    cpu.AttachBus(&bus);
+    rom = sz::cart::MakeRomImage(image.data(), image.size());
+    cart.Attach(rom.get());
+    cart.Reset();
+    ppu.Reset();
+    apu.Reset();
+    irq.Reset();
+    input.Reset();
+    bus.Reset();
+    cpu.Reset();
+  }
+};
+
+// Opcode-group loops: registers point into work RAM, then the body repeats
+// eight times before jumping back. CALL targets a RET at 0x0100.
+constexpr u8 kLoopPrologue[] = {
+    0xF3,                    // DI
+    0x31, 0xF0, 0xDF,        // LD SP,DFF0h
+    0x21, 0x00, 0xC0,        // LD HL,C000h
+    0x11, 0x00, 0xC2,        // LD DE,C200h
+    0x01, 0x00, 0xC3,        // LD BC,C300h
+    0xDD, 0x21, 0x00, 0xC1,  // LD IX,C100h
+    0xFD, 0x21, 0x80, 0xC1,  // LD IY,C180h
+};
+constexpr u16 kSubroutine = 0x0100;
+
+struct OpcodeGroup {
+  const char* name;
+  std::vector<u8> body;
+};
+
+const std::vector<OpcodeGroup>& OpcodeGroups() {
+  static const std::vector<OpcodeGroup> groups = {
+      // LD B,A / LD C,B / LD D,C / LD E,D / ADD A,B / SUB C / AND D / OR E /
+      // XOR 5Ah / CP 33h / INC A / DEC B / ADC A,C / SBC A,D / RLCA / CPL
+      {"ld_alu", {0x47, 0x48, 0x51, 0x5A, 0x80, 0x91, 0xA2, 0xB3, 0xEE, 0x5A, 0xFE, 0x33, 0x3C, 0x05, 0x89,
+                  0x9A, 0x07, 0x2F}},
+      // LD (HL),A / INC L / LD A,(HL) / LD (DE),A / INC E / PUSH BC / POP BC /
+      // LD (C080h),A / LD A,(C081h) / INC (HL) / LD A,(BC)
+      {"memory", {0x77, 0x2C, 0x7E, 0x12, 0x1C, 0xC5, 0xC1, 0x32, 0x80, 0xC0, 0x3A, 0x81, 0xC0, 0x34, 0x0A}},
+      // LD B,4 / DJNZ $ / CALL 0100h / JR $+2 / OR A / JR Z,$+2 / JR NZ,$+2
+      {"branch", {0x06, 0x04, 0x10, 0xFE, 0xCD, 0x00, 0x01, 0x18, 0x00, 0xB7, 0x28, 0x00, 0x20, 0x00}},
+      // RLC B / SRL C / BIT 3,A / SET 1,D / RES 1,D / RL (HL) / BIT 7,(HL) / SLA A
+      {"cb_bit", {0xCB, 0x00, 0xCB, 0x39, 0xCB, 0x5F, 0xCB, 0xCA, 0xCB, 0x8A, 0xCB, 0x16, 0xCB, 0x7E, 0xCB, 0x27}},
+      // LD A,(IX+5) / ADD A,(IX+6) / LD (IX+7),A / INC (IX+8) / LD B,(IY+2) /
+      // BIT 2,(IX+3)
+      {"indexed", {0xDD, 0x7E, 0x05, 0xDD, 0x86, 0x06, 0xDD, 0x77, 0x07, 0xDD, 0x34, 0x08, 0xFD, 0x46, 0x02, 0xDD,
+                   0xCB, 0x03, 0x56}},
+      // LD HL,C000h / LD DE,C400h / LD BC,0100h / LDIR
+      {"block", {0x21, 0x00, 0xC0, 0x11, 0x00, 0xC4, 0x01, 0x00, 0x01, 0xED, 0xB0}},
+      // LD BC,101Dh / LD HL,C000h / OTIR / IN A,(10h) / OUT (1Ch),A / IN A,(40h)
+      {"io", {0x01, 0x1D, 0x10, 0x21, 0x00, 0xC0, 0xED, 0xB3, 0xDB, 0x10, 0xD3, 0x1C, 0xDB, 0x40}},
+  };
+  return groups;
+}
+
+std::vector<u8> MakeLoopRom(const std::vector<u8>& body) {
+  std::vector<u8> rom(std::begin(kLoopPrologue), std::end(kLoopPrologue));
+  const u16 loop = static_cast<u16>(rom.size());
+  for (int i = 0; i < 8; ++i) {
+    rom.insert(rom.end(), body.begin(), body.end());
+  }
+  rom.push_back(0xC3);  // JP loop
+  rom.push_back(static_cast<u8>(loop));
+  rom.push_back(static_cast<u8>(loop >> 8));
+  if (rom.size() > kSubroutine) {
+    SZ_LOG_ERROR("Opcode group body too long");
+    std::exit(2);
+  }
+  rom.resize(kSubroutine + 1, 0xFF);
+  rom[kSubroutine] = 0xC9;  // RET
+  return rom;
+}
+
+// A PPU with its own video memory.
+struct PpuRig {
+  sz::ppu::PpuMemory memory;
+  sz::ppu::PPU ppu;
+
+  PpuRig() {
+    ppu.AttachMemory(&memory);
+    ppu.Reset();
+  }
+};
+
+// Synthetic VRAM: both planes scrolled over pseudo-random tiles, and a
+// sprite table with 48 16x16 sprites whose rows all cross lines 96-111.
+void FillSyntheticVram(sz::ppu::PPU& ppu, bool sprites) {
+  using namespace sz::ppu;
+  u32 seed = 0x12345678u;
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<u8>(seed >> 24);
+  };
+  ppu.WritePort(kPortVramAddrLo, 0);
+  ppu.WritePort(kPortVramAddrHi, 0);
+  for (size_t i = 0; i < kVramSize; ++i) {
+    ppu.WritePort(kPortVramDataInc, next());
+  }
+  ppu.WritePort(kPortPalAddr, 0);
+  for (size_t i = 0; i < kPaletteEntries * 2; ++i) {
+    ppu.WritePort(kPortPalData, next());
+  }
+  ppu.WritePort(kPortPlaneABase, 0x00);
+  ppu.WritePort(kPortPlaneBBase, 0x02);
+  ppu.WritePort(kPortPatternBase, 0x08);
+  ppu.WritePort(kPortPlaneAScrollX, 3);
+  ppu.WritePort(kPortPlaneAScrollY, 5);
+  ppu.WritePort(kPortPlaneBScrollX, 130);
+  ppu.WritePort(kPortPlaneBScrollY, 77);
+  ppu.WritePort(kPortVdpCtrl, kCtrlDisplayEnable | kCtrlPlaneAEnable | kCtrlPlaneBEnable);
+  if (sprites) {
+    ppu.WritePort(kPortSatBase, 0x10);
+    ppu.WritePort(kPortVramAddrLo, 0x00);
+    ppu.WritePort(kPortVramAddrHi, 0x10);
+    for (int i = 0; i < kSpriteCount; ++i) {
+      ppu.WritePort(kPortVramDataInc, 96);
+      ppu.WritePort(kPortVramDataInc, static_cast<u8>(i * 5));
+      ppu.WritePort(kPortVramDataInc, static_cast<u8>(i));
+      ppu.WritePort(kPortVramDataInc, static_cast<u8>(i & 0x7E));
+    }
+    ppu.WritePort(kPortSprCtrl, kSprCtrlEnable | (2 << kSprCtrlSizeShift));
+  }
+}
+
+std::vector<u8> BenchCartridge() {
+  return std::vector<u8>(std::begin(sz::tools::kBenchCartridge), std::end(sz::tools::kBenchCartridge));
+}
+
+// Console running the bench cartridge, warmed up past its setup code.
+void StartBenchConsole(sz::console::SuperZ80Console& console) {
+  const std::vector<u8> rom = BenchCartridge();
+  console.PowerOn();
+  console.LoadCartridge(rom.data(), rom.size());
+  console.Reset();
+  for (int i = 0; i < 4; ++i) {
+    console.StepFrame();
+  }
+}
+
+// Fixtures are built up front and owned by the closures, so calibration
+// runs and samples continue on the same warmed-up state.
+std::vector<Benchmark> MakeBenchmarks(const Options& options) {
+  std::vector<Benchmark> benchmarks;
+
+  for (const OpcodeGroup& group : OpcodeGroups()) {
+    auto rig = std::make_shared<Rig>(MakeLoopRom(group.body));
+    benchmarks.push_back({std::string("cpu/") + group.name, "tstate", [rig](u64 iterations) {
+                            const u64 before = rig->cpu.GetDebugState().tstates;
+                            rig->cpu.Step(static_cast<int>(std::min<u64>(iterations, 1u << 30)));
+                            return rig->cpu.GetDebugState().tstates - before;
+                          }});
+  }
+
+  auto bus_rig = std::make_shared<Rig>(BenchCartridge());
+  benchmarks.push_back({"bus/read8", "access", [bus_rig](u64 iterations) {
+                          u64 sum = 0;
+                          u16 addr = 0;
+                          for (u64 i = 0; i < iterations; ++i) {
+                            sum += bus_rig->bus.Read8(addr);
+                            addr = static_cast<u16>(addr + 0x0101);  // ROM, open bus and RAM
+                          }
+                          g_sink = g_sink + sum;
+                          return iterations;
+                        }});
+  benchmarks.push_back({"bus/write8", "access", [bus_rig](u64 iterations) {
+                          u16 addr = 0;
+                          for (u64 i = 0; i < iterations; ++i) {
+                            bus_rig->bus.Write8(addr, static_cast<u8>(i));
+                            addr = static_cast<u16>(addr + 0x0101);
+                          }
+                          return iterations;
+                        }});
+
+  auto fb = std::make_shared<sz::ppu::Framebuffer>();
+  auto planes = std::make_shared<PpuRig>();
+  FillSyntheticVram(planes->ppu, false);
+  benchmarks.push_back({"ppu/scanline", "line", [planes, fb](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            planes->ppu.RenderScanline(static_cast<int>(i % kScreenHeight), *fb);
+                          }
+                          return iterations;
+                        }});
+  auto sprites = std::make_shared<PpuRig>();
+  FillSyntheticVram(sprites->ppu, true);
+  benchmarks.push_back({"ppu/sprite_line", "line", [sprites, fb](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            sprites->ppu.RenderScanline(96 + static_cast<int>(i % 16), *fb);
+                          }
+                          return iterations;
+                        }});
+
+  auto apu = std::make_shared<sz::apu::APU>();
+  auto samples = std::make_shared<std::vector<s16>>();
+  apu->AttachSamples(samples.get());
+  apu->Reset();
+  benchmarks.push_back({"apu/frame", "frame", [apu, samples](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            apu->BeginFrame();
+                            for (int line = 0; line < kTotalScanlines; ++line) {
+                              apu->Tick(228);
+                            }
+                          }
+                          return iterations;
+                        }});
+
+  auto console = std::make_shared<sz::console::SuperZ80Console>();
+  auto snapshot = std::make_shared<std::vector<u8>>();
+  StartBenchConsole(*console);
+  console->SaveState(*snapshot);
+  benchmarks.push_back({"state/save", "state", [console, snapshot](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            console->SaveState(snapshot->data(), snapshot->size());
+                          }
+                          return iterations;
+                        }});
+  benchmarks.push_back({"state/load", "state", [console, snapshot](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            console->LoadState(snapshot->data(), snapshot->size());
+                          }
+                          return iterations;
+                        }});
+  benchmarks.push_back({"state/clone", "clone", [console](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            g_sink = g_sink + console->Clone()->GetDebugState().frame;
+                          }
+                          return iterations;
+                        }});
+  auto reset = std::make_shared<sz::console::SuperZ80Console>();
+  StartBenchConsole(*reset);
+  benchmarks.push_back({"state/reset", "reset", [reset](u64 iterations) {
+                          for (u64 i = 0; i < iterations; ++i) {
+                            reset->Reset();
+                          }
+                          return iterations;
+                        }});
+
+  // A real frame, since the edge filters' cost depends on the picture.
+  auto upscaler = std::make_shared<sz::app::Upscaler>();
+  auto upscaled = std::make_shared<std::vector<u32>>(static_cast<size_t>(kScreenWidth) * kScreenHeight * 16);
+  for (sz::app::UpscaleFilter filter : {sz::app::UpscaleFilter::Nearest, sz::app::UpscaleFilter::Scale2x,
+                                        sz::app::UpscaleFilter::Scale3x, sz::app::UpscaleFilter::Xbr,
+                                        sz::app::UpscaleFilter::Crt}) {
+    benchmarks.push_back({std::string("upscale/") + sz::app::UpscaleFilterName(filter) + "_x4", "frame",
+                          [console, upscaler, upscaled, filter](u64 iterations) {
+                            for (u64 i = 0; i < iterations; ++i) {
+                              upscaler->Run(filter, 4, console->GetFramebuffer(), upscaled->data(),
+                                            kScreenWidth * 4);
+                            }
+                            return iterations;
+                          }});
+  }
+
+  benchmarks.push_back({"macro/bench_cart", "frame",
+                        [](u64 iterations) {
+                          sz::console::SuperZ80Console machine;
+                          StartBenchConsole(machine);
+                          for (u64 i = 0; i < iterations; ++i) {
+                            machine.StepFrame();
+                          }
+                          g_sink = g_sink + machine.GetFramebufferHash();
+                          return iterations;
+                        },
+                        options.frames});
+  return benchmarks;
+}
+
+Result RunBenchmark(const Benchmark& benchmark, const Options& options) {
+  Result result;
+  result.name = benchmark.name;
+  result.unit = benchmark.unit;
+
+  u64 iterations = benchmark.fixed_iterations;
+  if (iterations == 0) {
+    // Grow until one sample takes min_time; the short runs double as warm-up.
+    iterations = 1;
+    for (;;) {
+      const auto start = Clock::now();
+      const u64 done = benchmark.run(iterations);
+      const double elapsed = Seconds(Clock::now() - start);
+      if (elapsed >= options.min_time_s || iterations >= (1ull << 40)) {
+        iterations = done;
+        break;
+      }
+      const double scale = elapsed > 0.0 ? options.min_time_s / elapsed : 10.0;
+      iterations = std::max<u64>(iterations + 1, static_cast<u64>(static_cast<double>(done) * std::min(scale * 1.2, 10.0)));
+    }
+  }
+
+  std::vector<double> samples;
+  for (int rep = 0; rep < options.repetitions; ++rep) {
+    const auto start = Clock::now();
+    const u64 done = benchmark.run(iterations);
+    const double elapsed = Seconds(Clock::now() - start);
+    samples.push_back(elapsed * 1e9 / static_cast<double>(std::max<u64>(done, 1)));
+  }
+  std::sort(samples.begin(), samples.end());
+  result.iterations = iterations;
+  result.ns_per_op = samples[samples.size() / 2];
+  result.ns_per_op_min = samples.front();
+  result.ns_per_op_max = samples.back();
+  return result;
+}
+
+bool WriteJson(const std::string& path, const std::vector<Result>& results) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    SZ_LOG_ERROR("Cannot write %s", path.c_str());
+    return false;
+  }
+  std::fprintf(file, "{\n  \"version\": 1,\n  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::fprintf(file,
+                 "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.4f, "
+                 "\"ns_per_op_min\": %.4f, \"ns_per_op_max\": %.4f, \"ops_per_sec\": %.1f}%s\n",
+                 r.name.c_str(), r.unit, static_cast<unsigned long long>(r.iterations), r.ns_per_op,
+                 r.ns_per_op_min, r.ns_per_op_max, 1e9 / r.ns_per_op, i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+  return std::fclose(file) == 0;
+}
+
+// Reads back what WriteJson produced: name -> ns_per_op.
+bool ReadBaseline(const std::string& path, std::map<std::string, double>& out) {
+  std::ifstream file(path);
+  if (!file) {
+    SZ_LOG_ERROR("Cannot open baseline %s", path.c_str());
+    return false;
+  }
+  const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  const std::string name_key = "\"name\": \"";
+  const std::string value_key = "\"ns_per_op\": ";
+  size_t pos = 0;
+  while ((pos = text.find(name_key, pos)) != std::string::npos) {
+    pos += name_key.size();
+    const size_t end = text.find('"', pos);
+    const size_t value = text.find(value_key, end);
+    if (end == std::string::npos || value == std::string::npos) {
+      break;
+    }
+    out[text.substr(pos, end - pos)] = std::strtod(text.c_str() + value + value_key.size(), nullptr);
+    pos = value;
+  }
+  if (out.empty()) {
+    SZ_LOG_ERROR("%s: no benchmarks found", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Prints the comparison and returns the number of regressions.
+int CompareWithBaseline(const std::vector<Result>& results, const std::map<std::string, double>& baseline,
+                        double threshold_pct) {
+  int regressions = 0;
+  std::printf("\n%-22s %14s %14s %9s\n", "vs baseline", "base ns/op", "ns/op", "change");
+  for (const Result& r : results) {
+    const auto it = baseline.find(r.name);
+    if (it == baseline.end() || it->second <= 0.0) {
+      std::printf("%-22s %14s %14.3f %9s\n", r.name.c_str(), "-", r.ns_per_op, "new");
+      continue;
+    }
+    const double change = (r.ns_per_op - it->second) / it->second * 100.0;
+    const bool regressed = change > threshold_pct;
+    regressions += regressed ? 1 : 0;
+    std::printf("%-22s %14.3f %14.3f %+8.1f%%%s\n", r.name.c_str(), it->second, r.ns_per_op, change,
+                regressed ? "  REGRESSION" : "");
+  }
+  return regressions;
+}
+
+bool ParseDouble(const char* text, double& out) {
+  char* end = nullptr;
+  const double value = std::strtod(text, &end);
+  if (end == text || *end != '\0' || value < 0.0) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+bool ParseU64(const char* text, u64& out) {
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 10);
+  if (end == text || *end != '\0') {
+    return false;
+  }
+  out = value;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    bool ok = true;
+    u64 value = 0;
+    if (arg == "--filter" && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      options.json_path = argv[++i];
+    } else if (arg == "--baseline" && i + 1 < argc) {
+      options.baseline_path = argv[++i];
+    } else if (arg == "--threshold" && i + 1 < argc) {
+      ok = ParseDouble(argv[++i], options.threshold_pct);
+    } else if (arg == "--min-time" && i + 1 < argc) {
+      ok = ParseDouble(argv[++i], options.min_time_s);
+    } else if (arg == "--repetitions" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], value) && value > 0;
+      options.repetitions = static_cast<int>(value);
+    } else if (arg == "--frames" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.frames) && options.frames > 0;
+    } else if (arg == "--list") {
+      options.list = true;
+    } else if (arg == "--help") {
+      SZ_LOG_INFO("Usage: superz80_bench [--filter SUBSTR] [--json PATH] [--baseline PATH] "
+                  "[--threshold PCT] [--min-time SEC] [--repetitions N] [--frames N] [--list]");
+      return 0;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      SZ_LOG_ERROR("Bad argument: %s", arg.c_str());
+      return 2;
+    }
+  }
+
+  std::map<std::string, double> baseline;
+  if (!options.baseline_path.empty() && !ReadBaseline(options.baseline_path, baseline)) {
+    return 2;
+  }
+
+  // Device setup logs (cartridge loads, power-on) would interleave with the table.
+  sz::log::Logger::SetLevel(sz::log::Level::Warn);
+
+  std::vector<Result> results;
+  if (!options.list) {
+    std::printf("%-22s %8s %14s %14s %16s\n", "benchmark", "unit", "ns/op", "spread", "ops/s");
+  }
+  for (const Benchmark& benchmark : MakeBenchmarks(options)) {
+    if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    if (options.list) {
+      std::printf("%s\n", benchmark.name.c_str());
+      continue;
+    }
+    const Result result = RunBenchmark(benchmark, options);
+    std::printf("%-22s %8s %14.3f %13.1f%% %16.0f\n", result.name.c_str(), result.unit, result.ns_per_op,
+                (result.ns_per_op_max - result.ns_per_op_min) / result.ns_per_op * 100.0,
+                1e9 / result.ns_per_op);
+    std::fflush(stdout);
+    results.push_back(result);
+  }
+
+  if (!options.json_path.empty() && !WriteJson(options.json_path, results)) {
+    return 2;
+  }
+  if (!baseline.empty() && CompareWithBaseline(results, baseline, options.threshold_pct) > 0) {
+    return 1;
+  }
+  return 0;
+}
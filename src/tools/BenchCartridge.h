@@ -0,0 +1,162 @@
+#ifndef SUPERZ80_TOOLS_BENCHCARTRIDGE_H
+#define SUPERZ80_TOOLS_BENCHCARTRIDGE_H
+
+#include "core/types.h"
+
+namespace sz::tools {
+
+// Macro-benchmark workload for superz80_bench. Fills both tilemaps, eight
+// patterns and the palette through the VRAM/palette ports, then runs a
+// frame loop shaped like a game: the main loop moves 48 16x16 sprites and
+// checksums a RAM table, the VBlank ISR uploads the sprite table with OTIR
+// and scrolls Plane B. Sprites bunch up on lines 64-107, so those lines hit
+// the 16-per-line limit. Unbanked; runs from bank 0.
+//
+// Work RAM: C000 frame counter, C002 scroll, C004 checksum, C006 PAD1,
+// C100-C1BF sprite table shadow. VRAM: maps at 0000/0800, SAT at 1000,
+// patterns at 2000.
+inline constexpr u8 kBenchCartridge[] = {
+    0xF3,                        // 0000 DI
+    0x31, 0xF0, 0xFF,            // 0001 LD SP,FFF0h
+    0xED, 0x56,                  // 0004 IM 1
+    0xC3, 0x66, 0x00,            // 0006 JP 0066h
+    // 0009-0037 unused
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    // vblank_isr:
+    0xF5,                        // 0038 PUSH AF
+    0xC5,                        // 0039 PUSH BC
+    0xE5,                        // 003A PUSH HL
+    0xAF,                        // 003B XOR A
+    0xD3, 0x1A,                  // 003C OUT (1Ah),A
+    0x3E, 0x10,                  // 003E LD A,10h
+    0xD3, 0x1B,                  // 0040 OUT (1Bh),A
+    0x21, 0x00, 0xC1,            // 0042 LD HL,C100h
+    0x01, 0x1D, 0xC0,            // 0045 LD BC,C01Dh
+    0xED, 0xB3,                  // 0048 OTIR
+    0x3A, 0x02, 0xC0,            // 004A LD A,(C002h)
+    0x3C,                        // 004D INC A
+    0x32, 0x02, 0xC0,            // 004E LD (C002h),A
+    0xD3, 0x14,                  // 0051 OUT (14h),A
+    0xD3, 0x15,                  // 0053 OUT (15h),A
+    0x2A, 0x00, 0xC0,            // 0055 LD HL,(C000h)
+    0x23,                        // 0058 INC HL
+    0x22, 0x00, 0xC0,            // 0059 LD (C000h),HL
+    0x3E, 0x01,                  // 005C LD A,01h
+    0xD3, 0x82,                  // 005E OUT (82h),A
+    0xE1,                        // 0060 POP HL
+    0xC1,                        // 0061 POP BC
+    0xF1,                        // 0062 POP AF
+    0xFB,                        // 0063 EI
+    0xED, 0x4D,                  // 0064 RETI
+    // init:
+    0xAF,                        // 0066 XOR A
+    0xD3, 0x16,                  // 0067 OUT (16h),A
+    0x3E, 0x02,                  // 0069 LD A,02h
+    0xD3, 0x17,                  // 006B OUT (17h),A
+    0x3E, 0x08,                  // 006D LD A,08h
+    0xD3, 0x18,                  // 006F OUT (18h),A
+    0x3E, 0x10,                  // 0071 LD A,10h
+    0xD3, 0x21,                  // 0073 OUT (21h),A
+    0xAF,                        // 0075 XOR A
+    0xD3, 0x1A,                  // 0076 OUT (1Ah),A
+    0xD3, 0x1B,                  // 0078 OUT (1Bh),A
+    0x11, 0x00, 0x08,            // 007A LD DE,0800h
+    0x21, 0x00, 0x00,            // 007D LD HL,0000h
+    // fill_map:
+    0x7D,                        // 0080 LD A,L
+    0xE6, 0x07,                  // 0081 AND 07h
+    0xD3, 0x1D,                  // 0083 OUT (1Dh),A
+    0x7D,                        // 0085 LD A,L
+    0x0F,                        // 0086 RRCA
+    0x0F,                        // 0087 RRCA
+    0xE6, 0x0E,                  // 0088 AND 0Eh
+    0xD3, 0x1D,                  // 008A OUT (1Dh),A
+    0x23,                        // 008C INC HL
+    0x1B,                        // 008D DEC DE
+    0x7A,                        // 008E LD A,D
+    0xB3,                        // 008F OR E
+    0x20, 0xEE,                  // 0090 JR NZ,0080h
+    0xAF,                        // 0092 XOR A
+    0xD3, 0x1A,                  // 0093 OUT (1Ah),A
+    0x3E, 0x20,                  // 0095 LD A,20h
+    0xD3, 0x1B,                  // 0097 OUT (1Bh),A
+    0x01, 0x00, 0x00,            // 0099 LD BC,0000h
+    // fill_patterns:
+    0x79,                        // 009C LD A,C
+    0xD3, 0x1D,                  // 009D OUT (1Dh),A
+    0x0C,                        // 009F INC C
+    0x10, 0xFA,                  // 00A0 DJNZ 009Ch
+    0xAF,                        // 00A2 XOR A
+    0xD3, 0x1E,                  // 00A3 OUT (1Eh),A
+    0x06, 0x00,                  // 00A5 LD B,00h
+    // fill_palette:
+    0x78,                        // 00A7 LD A,B
+    0xD3, 0x1F,                  // 00A8 OUT (1Fh),A
+    0x10, 0xFB,                  // 00AA DJNZ 00A7h
+    0x21, 0x00, 0xC1,            // 00AC LD HL,C100h
+    0x06, 0x30,                  // 00AF LD B,30h
+    0x0E, 0x00,                  // 00B1 LD C,00h
+    // build_sat:
+    0x79,                        // 00B3 LD A,C
+    0xE6, 0x07,                  // 00B4 AND 07h
+    0x87,                        // 00B6 ADD A,A
+    0x87,                        // 00B7 ADD A,A
+    0xC6, 0x40,                  // 00B8 ADD A,40h
+    0x77,                        // 00BA LD (HL),A
+    0x23,                        // 00BB INC HL
+    0x79,                        // 00BC LD A,C
+    0x87,                        // 00BD ADD A,A
+    0x87,                        // 00BE ADD A,A
+    0x81,                        // 00BF ADD A,C
+    0x77,                        // 00C0 LD (HL),A
+    0x23,                        // 00C1 INC HL
+    0x79,                        // 00C2 LD A,C
+    0xE6, 0x07,                  // 00C3 AND 07h
+    0x77,                        // 00C5 LD (HL),A
+    0x23,                        // 00C6 INC HL
+    0x87,                        // 00C7 ADD A,A
+    0x77,                        // 00C8 LD (HL),A
+    0x23,                        // 00C9 INC HL
+    0x0C,                        // 00CA INC C
+    0x10, 0xE6,                  // 00CB DJNZ 00B3h
+    0x3E, 0x07,                  // 00CD LD A,07h
+    0xD3, 0x11,                  // 00CF OUT (11h),A
+    0x3E, 0x05,                  // 00D1 LD A,05h
+    0xD3, 0x20,                  // 00D3 OUT (20h),A
+    0x3E, 0x01,                  // 00D5 LD A,01h
+    0xD3, 0x81,                  // 00D7 OUT (81h),A
+    0xFB,                        // 00D9 EI
+    // main:
+    0x21, 0x01, 0xC1,            // 00DA LD HL,C101h
+    0x06, 0x30,                  // 00DD LD B,30h
+    0x11, 0x04, 0x00,            // 00DF LD DE,0004h
+    // move_sprites:
+    0x34,                        // 00E2 INC (HL)
+    0x19,                        // 00E3 ADD HL,DE
+    0x10, 0xFC,                  // 00E4 DJNZ 00E2h
+    0xDD, 0x21, 0x00, 0xC1,      // 00E6 LD IX,C100h
+    0x06, 0x00,                  // 00EA LD B,00h
+    0x21, 0x00, 0x00,            // 00EC LD HL,0000h
+    // checksum:
+    0xDD, 0x5E, 0x00,            // 00EF LD E,(IX+00h)
+    0x16, 0x00,                  // 00F2 LD D,00h
+    0x19,                        // 00F4 ADD HL,DE
+    0xDD, 0x23,                  // 00F5 INC IX
+    0x10, 0xF6,                  // 00F7 DJNZ 00EFh
+    0x22, 0x04, 0xC0,            // 00F9 LD (C004h),HL
+    0xDB, 0x40,                  // 00FC IN A,(40h)
+    0x32, 0x06, 0xC0,            // 00FE LD (C006h),A
+    0x21, 0x00, 0xC0,            // 0101 LD HL,C000h
+    0x7E,                        // 0104 LD A,(HL)
+    // wait_frame:
+    0xBE,                        // 0105 CP (HL)
+    0x28, 0xFD,                  // 0106 JR Z,0105h
+    0xC3, 0xDA, 0x00,            // 0108 JP 00DAh
+};
+
+}  // namespace sz::tools
+
+#endif
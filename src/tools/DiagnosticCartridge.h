@@ -0,0 +1,204 @@
+#ifndef SUPERZ80_TOOLS_DIAGNOSTICCARTRIDGE_H
+#define SUPERZ80_TOOLS_DIAGNOSTICCARTRIDGE_H
+
+#include "core/types.h"
+
+namespace sz::tools {
+
+// The bring-up diagnostic ROM (docs/design/super_z80_diagnostic_cartridge_rom_spec.md).
+// Copies the palette and four tiles into RAM, builds one tilemap row, then
+// waits for VBlank and DMAs palette, patterns and 24 map rows. The VBlank
+// ISR counts, flips palette entry 1 between red and blue with a 2-byte DMA
+// and acknowledges the IRQ; the main loop counts frames off the ISR.
+//
+// Work RAM: C000 frame counter, C002 VBlank counter, C004 ISR counter,
+// C006 palette toggle, C100-C11F palette, C120-C19F tiles, C200-C23F map
+// row. The spec reserves C120-C17F for tiles, which only holds three 4bpp
+// tiles, so the buffer runs to C19F. VRAM: Plane A map at 0000, patterns
+// at 2000.
+inline constexpr u8 kDiagnosticCartridge[] = {
+    0xF3,                        // 0000 DI
+    0x31, 0xFE, 0xFF,            // 0001 LD SP,FFFEh
+    0xED, 0x56,                  // 0004 IM 1
+    0xC3, 0x8F, 0x00,            // 0006 JP 008Fh
+    // 0009-0037 unused
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    // vblank_isr:
+    0xF5,                        // 0038 PUSH AF
+    0xC5,                        // 0039 PUSH BC
+    0xD5,                        // 003A PUSH DE
+    0xE5,                        // 003B PUSH HL
+    0x2A, 0x04, 0xC0,            // 003C LD HL,(C004h)
+    0x23,                        // 003F INC HL
+    0x22, 0x04, 0xC0,            // 0040 LD (C004h),HL
+    0x2A, 0x02, 0xC0,            // 0043 LD HL,(C002h)
+    0x23,                        // 0046 INC HL
+    0x22, 0x02, 0xC0,            // 0047 LD (C002h),HL
+    0x3A, 0x06, 0xC0,            // 004A LD A,(C006h)
+    0xEE, 0x01,                  // 004D XOR 01h
+    0x32, 0x06, 0xC0,            // 004F LD (C006h),A
+    0x28, 0x05,                  // 0052 JR Z,0059h
+    0x21, 0x07, 0x00,            // 0054 LD HL,0007h
+    0x18, 0x03,                  // 0057 JR 005Ch
+    // red:
+    0x21, 0xC0, 0x01,            // 0059 LD HL,01C0h
+    // set_palette:
+    0x22, 0x02, 0xC1,            // 005C LD (C102h),HL
+    0x21, 0x02, 0xC1,            // 005F LD HL,C102h
+    0x11, 0x02, 0x00,            // 0062 LD DE,0002h
+    0x01, 0x02, 0x00,            // 0065 LD BC,0002h
+    0x3E, 0x09,                  // 0068 LD A,09h
+    0xCD, 0x78, 0x00,            // 006A CALL 0078h
+    0x3E, 0x01,                  // 006D LD A,01h
+    0xD3, 0x82,                  // 006F OUT (82h),A
+    0xE1,                        // 0071 POP HL
+    0xD1,                        // 0072 POP DE
+    0xC1,                        // 0073 POP BC
+    0xF1,                        // 0074 POP AF
+    0xFB,                        // 0075 EI
+    0xED, 0x4D,                  // 0076 RETI
+    // dma:
+    0xF5,                        // 0078 PUSH AF
+    0x7D,                        // 0079 LD A,L
+    0xD3, 0x30,                  // 007A OUT (30h),A
+    0x7C,                        // 007C LD A,H
+    0xD3, 0x31,                  // 007D OUT (31h),A
+    0x7B,                        // 007F LD A,E
+    0xD3, 0x32,                  // 0080 OUT (32h),A
+    0x7A,                        // 0082 LD A,D
+    0xD3, 0x33,                  // 0083 OUT (33h),A
+    0x79,                        // 0085 LD A,C
+    0xD3, 0x34,                  // 0086 OUT (34h),A
+    0x78,                        // 0088 LD A,B
+    0xD3, 0x35,                  // 0089 OUT (35h),A
+    0xF1,                        // 008B POP AF
+    0xD3, 0x36,                  // 008C OUT (36h),A
+    0xC9,                        // 008E RET
+    // init:
+    0x21, 0x00, 0xC0,            // 008F LD HL,C000h
+    0x11, 0x01, 0xC0,            // 0092 LD DE,C001h
+    0x01, 0xFF, 0x03,            // 0095 LD BC,03FFh
+    0x36, 0x00,                  // 0098 LD (HL),00h
+    0xED, 0xB0,                  // 009A LDIR
+    0x21, 0x2B, 0x01,            // 009C LD HL,012Bh
+    0x11, 0x00, 0xC1,            // 009F LD DE,C100h
+    0x01, 0x20, 0x00,            // 00A2 LD BC,0020h
+    0xED, 0xB0,                  // 00A5 LDIR
+    0x21, 0x4B, 0x01,            // 00A7 LD HL,014Bh
+    0x11, 0x20, 0xC1,            // 00AA LD DE,C120h
+    0x01, 0x80, 0x00,            // 00AD LD BC,0080h
+    0xED, 0xB0,                  // 00B0 LDIR
+    0x21, 0x00, 0xC2,            // 00B2 LD HL,C200h
+    0x06, 0x20,                  // 00B5 LD B,20h
+    0x0E, 0x00,                  // 00B7 LD C,00h
+    // map_row:
+    0x79,                        // 00B9 LD A,C
+    0xE6, 0x03,                  // 00BA AND 03h
+    0x77,                        // 00BC LD (HL),A
+    0x23,                        // 00BD INC HL
+    0x36, 0x00,                  // 00BE LD (HL),00h
+    0x23,                        // 00C0 INC HL
+    0x0C,                        // 00C1 INC C
+    0x10, 0xF5,                  // 00C2 DJNZ 00B9h
+    0xAF,                        // 00C4 XOR A
+    0xD3, 0x16,                  // 00C5 OUT (16h),A
+    0x3E, 0x08,                  // 00C7 LD A,08h
+    0xD3, 0x18,                  // 00C9 OUT (18h),A
+    0xAF,                        // 00CB XOR A
+    0xD3, 0x20,                  // 00CC OUT (20h),A
+    0x3E, 0x03,                  // 00CE LD A,03h
+    0xD3, 0x11,                  // 00D0 OUT (11h),A
+    // wait_active:
+    0xDB, 0x10,                  // 00D2 IN A,(10h)
+    0xE6, 0x01,                  // 00D4 AND 01h
+    0x20, 0xFA,                  // 00D6 JR NZ,00D2h
+    // wait_vblank:
+    0xDB, 0x10,                  // 00D8 IN A,(10h)
+    0xE6, 0x01,                  // 00DA AND 01h
+    0x28, 0xFA,                  // 00DC JR Z,00D8h
+    0x21, 0x00, 0xC1,            // 00DE LD HL,C100h
+    0x11, 0x00, 0x00,            // 00E1 LD DE,0000h
+    0x01, 0x20, 0x00,            // 00E4 LD BC,0020h
+    0x3E, 0x09,                  // 00E7 LD A,09h
+    0xCD, 0x78, 0x00,            // 00E9 CALL 0078h
+    0x21, 0x20, 0xC1,            // 00EC LD HL,C120h
+    0x11, 0x00, 0x20,            // 00EF LD DE,2000h
+    0x01, 0x80, 0x00,            // 00F2 LD BC,0080h
+    0x3E, 0x01,                  // 00F5 LD A,01h
+    0xCD, 0x78, 0x00,            // 00F7 CALL 0078h
+    0x11, 0x00, 0x00,            // 00FA LD DE,0000h
+    0x06, 0x18,                  // 00FD LD B,18h
+    // map_rows:
+    0xC5,                        // 00FF PUSH BC
+    0x21, 0x00, 0xC2,            // 0100 LD HL,C200h
+    0x01, 0x40, 0x00,            // 0103 LD BC,0040h
+    0x3E, 0x01,                  // 0106 LD A,01h
+    0xCD, 0x78, 0x00,            // 0108 CALL 0078h
+    0x21, 0x40, 0x00,            // 010B LD HL,0040h
+    0x19,                        // 010E ADD HL,DE
+    0xEB,                        // 010F EX DE,HL
+    0xC1,                        // 0110 POP BC
+    0x10, 0xEC,                  // 0111 DJNZ 00FFh
+    0x3E, 0x01,                  // 0113 LD A,01h
+    0xD3, 0x81,                  // 0115 OUT (81h),A
+    0xFB,                        // 0117 EI
+    // main:
+    0x3A, 0x02, 0xC0,            // 0118 LD A,(C002h)
+    0x47,                        // 011B LD B,A
+    // wait_frame:
+    0x3A, 0x02, 0xC0,            // 011C LD A,(C002h)
+    0xB8,                        // 011F CP B
+    0x28, 0xFA,                  // 0120 JR Z,011Ch
+    0x2A, 0x00, 0xC0,            // 0122 LD HL,(C000h)
+    0x23,                        // 0125 INC HL
+    0x22, 0x00, 0xC0,            // 0126 LD (C000h),HL
+    0x18, 0xED,                  // 0129 JR 0118h
+    // palette:
+    0x00, 0x00, 0xC0, 0x01, 0x38, 0x00, 0x07, 0x00,  // 012B
+    0xFF, 0x01, 0x00, 0x00, 0x00, 0x00, 0x49, 0x00,  // 0133
+    0x92, 0x00, 0x92, 0x00, 0xDB, 0x00, 0x24, 0x01,  // 013B
+    0x24, 0x01, 0x6D, 0x01, 0xB6, 0x01, 0xFF, 0x01,  // 0143
+    // tile_solid:
+    0x11, 0x11, 0x11, 0x11,  // 014B
+    0x11, 0x11, 0x11, 0x11,  // 014F
+    0x11, 0x11, 0x11, 0x11,  // 0153
+    0x11, 0x11, 0x11, 0x11,  // 0157
+    0x11, 0x11, 0x11, 0x11,  // 015B
+    0x11, 0x11, 0x11, 0x11,  // 015F
+    0x11, 0x11, 0x11, 0x11,  // 0163
+    0x11, 0x11, 0x11, 0x11,  // 0167
+    // tile_checker:
+    0x24, 0x24, 0x24, 0x24,  // 016B
+    0x42, 0x42, 0x42, 0x42,  // 016F
+    0x24, 0x24, 0x24, 0x24,  // 0173
+    0x42, 0x42, 0x42, 0x42,  // 0177
+    0x24, 0x24, 0x24, 0x24,  // 017B
+    0x42, 0x42, 0x42, 0x42,  // 017F
+    0x24, 0x24, 0x24, 0x24,  // 0183
+    0x42, 0x42, 0x42, 0x42,  // 0187
+    // tile_vstripes:
+    0x33, 0x44, 0x33, 0x44,  // 018B
+    0x33, 0x44, 0x33, 0x44,  // 018F
+    0x33, 0x44, 0x33, 0x44,  // 0193
+    0x33, 0x44, 0x33, 0x44,  // 0197
+    0x33, 0x44, 0x33, 0x44,  // 019B
+    0x33, 0x44, 0x33, 0x44,  // 019F
+    0x33, 0x44, 0x33, 0x44,  // 01A3
+    0x33, 0x44, 0x33, 0x44,  // 01A7
+    // tile_hstripes:
+    0x22, 0x22, 0x22, 0x22,  // 01AB
+    0x00, 0x00, 0x00, 0x00,  // 01AF
+    0x22, 0x22, 0x22, 0x22,  // 01B3
+    0x00, 0x00, 0x00, 0x00,  // 01B7
+    0x22, 0x22, 0x22, 0x22,  // 01BB
+    0x00, 0x00, 0x00, 0x00,  // 01BF
+    0x22, 0x22, 0x22, 0x22,  // 01C3
+    0x00, 0x00, 0x00, 0x00,  // 01C7
+};
+
+}  // namespace sz::tools
+
+#endif
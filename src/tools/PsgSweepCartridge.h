@@ -0,0 +1,86 @@
+#ifndef SUPERZ80_TOOLS_PSGSWEEPCARTRIDGE_H
+#define SUPERZ80_TOOLS_PSGSWEEPCARTRIDGE_H
+
+#include "core/types.h"
+
+namespace sz::tools {
+
+// Audio workload for superz80_regress; the video stays blank. Tone 1 holds
+// a fixed pitch, white noise runs underneath, and the VBlank ISR sweeps the
+// tone 0 period from the frame counter and cycles the noise mode every 16
+// frames, so every PSG path contributes to the audio hash.
+//
+// Work RAM: C000 frame counter.
+inline constexpr u8 kPsgSweepCartridge[] = {
+    0xF3,                        // 0000 DI
+    0x31, 0xFE, 0xFF,            // 0001 LD SP,FFFEh
+    0xED, 0x56,                  // 0004 IM 1
+    0xC3, 0x6C, 0x00,            // 0006 JP 006Ch
+    // 0009-0037 unused
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    // vblank_isr:
+    0xF5,                        // 0038 PUSH AF
+    0xE5,                        // 0039 PUSH HL
+    0x2A, 0x00, 0xC0,            // 003A LD HL,(C000h)
+    0x23,                        // 003D INC HL
+    0x22, 0x00, 0xC0,            // 003E LD (C000h),HL
+    0x7D,                        // 0041 LD A,L
+    0xE6, 0x0F,                  // 0042 AND 0Fh
+    0xF6, 0x80,                  // 0044 OR 80h
+    0xD3, 0x60,                  // 0046 OUT (60h),A
+    0x7D,                        // 0048 LD A,L
+    0x0F,                        // 0049 RRCA
+    0x0F,                        // 004A RRCA
+    0x0F,                        // 004B RRCA
+    0x0F,                        // 004C RRCA
+    0xE6, 0x0F,                  // 004D AND 0Fh
+    0xC6, 0x04,                  // 004F ADD A,04h
+    0xD3, 0x60,                  // 0051 OUT (60h),A
+    0x7D,                        // 0053 LD A,L
+    0xE6, 0x0F,                  // 0054 AND 0Fh
+    0x20, 0x0B,                  // 0056 JR NZ,0063h
+    0x7D,                        // 0058 LD A,L
+    0x0F,                        // 0059 RRCA
+    0x0F,                        // 005A RRCA
+    0x0F,                        // 005B RRCA
+    0x0F,                        // 005C RRCA
+    0xE6, 0x07,                  // 005D AND 07h
+    0xF6, 0xE0,                  // 005F OR E0h
+    0xD3, 0x60,                  // 0061 OUT (60h),A
+    // ack:
+    0x3E, 0x01,                  // 0063 LD A,01h
+    0xD3, 0x82,                  // 0065 OUT (82h),A
+    0xE1,                        // 0067 POP HL
+    0xF1,                        // 0068 POP AF
+    0xFB,                        // 0069 EI
+    0xED, 0x4D,                  // 006A RETI
+    // init:
+    0x21, 0x00, 0x00,            // 006C LD HL,0000h
+    0x22, 0x00, 0xC0,            // 006F LD (C000h),HL
+    0x3E, 0x92,                  // 0072 LD A,92h
+    0xD3, 0x60,                  // 0074 OUT (60h),A
+    0x3E, 0xAE,                  // 0076 LD A,AEh
+    0xD3, 0x60,                  // 0078 OUT (60h),A
+    0x3E, 0x0F,                  // 007A LD A,0Fh
+    0xD3, 0x60,                  // 007C OUT (60h),A
+    0x3E, 0xB4,                  // 007E LD A,B4h
+    0xD3, 0x60,                  // 0080 OUT (60h),A
+    0x3E, 0xDF,                  // 0082 LD A,DFh
+    0xD3, 0x60,                  // 0084 OUT (60h),A
+    0x3E, 0xE4,                  // 0086 LD A,E4h
+    0xD3, 0x60,                  // 0088 OUT (60h),A
+    0x3E, 0xF6,                  // 008A LD A,F6h
+    0xD3, 0x60,                  // 008C OUT (60h),A
+    0x3E, 0x01,                  // 008E LD A,01h
+    0xD3, 0x81,                  // 0090 OUT (81h),A
+    0xFB,                        // 0092 EI
+    // idle:
+    0x18, 0xFE,                  // 0093 JR 0093h
+};
+
+}  // namespace sz::tools
+
+#endif
@@ -0,0 +1,457 @@
+// superz80_regress: frame-hash regression harness. Runs each ROM headless
+// for a fixed number of frames from power-on, hashes every framebuffer and
+// every frame's audio, and compares the sequence against a golden file
+// (<golden dir>/<rom name>.golden; by default tests/regress in the source
+// tree, where the bundled ROMs' files are committed). ROMs run in parallel
+// on a work-stealing pool, one console per ROM. --update rewrites the
+// golden files instead of comparing; without it a missing file fails.
+//
+// Golden file: one line per frame, "<frame> <video hash> <audio hash>" in
+// hex; lines starting with '#' are comments. Exit code 1 on any mismatch or
+// missing golden file, 2 on usage errors.
+//
+// Every ROM also gets a save-state round trip: a state saved halfway
+// through is loaded after the run, and the frames that followed it must
+// repeat with the same video, audio and state hashes. Copies of that state
+// with a field out of range or a section mangled must be rejected without
+// changing the console.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "console/SuperZ80Console.h"
+#include "core/log/Logger.h"
+#include "core/state/SaveState.h"
+#include "core/util/WorkStealingPool.h"
+#include "tools/BenchCartridge.h"
+#include "tools/DiagnosticCartridge.h"
+#include "tools/PsgSweepCartridge.h"
+
+#ifndef SUPERZ80_REGRESS_GOLDEN_DIR
+#define SUPERZ80_REGRESS_GOLDEN_DIR "tests/regress"
+#endif
+
+namespace {
+struct Options {
+  std::string golden_dir = SUPERZ80_REGRESS_GOLDEN_DIR;
+  std::string filter;
+  std::vector<std::string> rom_paths;
+  u64 frames = 300;
+  unsigned jobs = 0;  // 0: one per hardware thread
+  bool update = false;
+};
+
+struct FrameHash {
+  u64 video = 0;
+  u64 audio = 0;
+};
+
+struct Job {
+  std::string name;
+  std::vector<u8> rom;
+  bool reads_pads = false;  // a fork with a button held must diverge
+
+  // Filled by the worker.
+  std::vector<FrameHash> hashes;
+  double wall_ms = 0.0;
+  bool loaded = false;
+  std::string determinism_error;  // empty when the state checks passed
+};
+
+enum class Outcome { Pass, Updated, Mismatch, NoGolden, LoadFailed, Nondeterministic };
+
+// Frames replayed after the save-state round trip, and stepped by the
+// clones taken at the same point.
+constexpr u64 kReplayFrames = 30;
+
+struct Report {
+  Outcome outcome = Outcome::Pass;
+  u64 first_bad_frame = 0;
+  bool video_bad = false;
+  bool audio_bad = false;
+};
+
+Job MakeJob(std::string name, std::vector<u8> rom) {
+  Job job;
+  job.name = std::move(name);
+  job.rom = std::move(rom);
+  return job;
+}
+
+template <size_t N>
+Job MakeJob(std::string name, const u8 (&rom)[N]) {
+  return MakeJob(std::move(name), std::vector<u8>(rom, rom + N));
+}
+
+std::string StemOf(const std::string& path) {
+  const size_t slash = path.find_last_of("/\\");
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  const size_t dot = name.find_last_of('.');
+  return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+struct ReplayFrame {
+  FrameHash hash;
+  u64 state = 0;
+};
+
+ReplayFrame HashFrame(const sz::console::SuperZ80Console& console) {
+  return {{console.GetFramebufferHash(), console.GetAudioHash()}, console.GetStateHash()};
+}
+
+bool SameFrame(const ReplayFrame& a, const ReplayFrame& b) {
+  return a.hash.video == b.hash.video && a.hash.audio == b.hash.audio && a.state == b.state;
+}
+
+std::string FrameError(const char* what, u64 frame) {
+  char text[64];
+  std::snprintf(text, sizeof(text), "%s at frame %" PRIu64, what, frame);
+  return text;
+}
+
+// Loads the state saved after frame `saved_after` and checks that the
+// frames after it repeat `expected`.
+void CheckRoundTrip(Job& job, sz::console::SuperZ80Console& console, const std::vector<u8>& state,
+                    u64 saved_after, const std::vector<ReplayFrame>& expected) {
+  if (!console.LoadState(state.data(), state.size())) {
+    job.determinism_error = "state did not load";
+    return;
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    console.StepFrame();
+    if (!SameFrame(HashFrame(console), expected[i])) {
+      job.determinism_error = FrameError("round trip differs", saved_after + 1 + i);
+      return;
+    }
+  }
+}
+
+// Offset of the payload of the section tagged `tag`, or 0 when absent.
+size_t FindSection(const std::vector<u8>& state, u32 tag) {
+  const auto read_u32 = [&](size_t pos) {
+    return static_cast<u32>(state[pos] | (state[pos + 1] << 8) | (state[pos + 2] << 16) | (state[pos + 3] << 24));
+  };
+  for (size_t pos = sz::state::kHeaderSize; pos + 8 <= state.size(); pos += 8 + read_u32(pos + 4)) {
+    if (read_u32(pos) == tag) {
+      return pos + 8;
+    }
+  }
+  return 0;
+}
+
+void PutS32(std::vector<u8>& state, size_t pos, s32 value) {
+  for (size_t i = 0; i < 4; ++i) {
+    state[pos + i] = static_cast<u8>(static_cast<u32>(value) >> (8 * i));
+  }
+}
+
+// Loads damaged copies of `state`; each must fail and leave the console
+// exactly as it was.
+void CheckCorruptLoads(Job& job, sz::console::SuperZ80Console& console, const std::vector<u8>& state) {
+  using sz::state::MakeTag;
+  const size_t ppu = FindSection(state, MakeTag('P', 'P', 'U', ' '));
+  const size_t scheduler = FindSection(state, MakeTag('S', 'C', 'H', 'D'));
+  const size_t input = FindSection(state, MakeTag('I', 'N', 'P', 'T'));
+  if (ppu == 0 || scheduler == 0 || input == 0) {
+    job.determinism_error = "state is missing a section";
+    return;
+  }
+  std::vector<std::vector<u8>> corrupt(3, state);
+  PutS32(corrupt[0], ppu, -5);                     // PPU last scanline
+  PutS32(corrupt[1], scheduler, kTotalScanlines);  // scheduler scanline
+  corrupt[2][input - 8] ^= 0xFF;                   // last section's tag, after the rest decoded
+  const ReplayFrame before = HashFrame(console);
+  for (const std::vector<u8>& bad : corrupt) {
+    if (console.LoadState(bad.data(), bad.size())) {
+      job.determinism_error = "corrupt state loaded";
+      return;
+    }
+    if (!SameFrame(HashFrame(console), before)) {
+      job.determinism_error = "rejected state changed the console";
+      return;
+    }
+  }
+}
+
+// Steps a clone taken after frame `cloned_after` with the parent's input
+// and checks that it repeats the parent's frames.
+void CheckTwin(Job& job, sz::console::SuperZ80Console& twin, u64 cloned_after,
+               const std::vector<ReplayFrame>& expected) {
+  for (size_t i = 0; i < expected.size(); ++i) {
+    twin.StepFrame();
+    if (!SameFrame(HashFrame(twin), expected[i])) {
+      job.determinism_error = FrameError("clone differs", cloned_after + 1 + i);
+      return;
+    }
+  }
+}
+
+// Power-on to frame N with no input; the console is deterministic, so the
+// hash sequence depends only on the ROM and the emulator. At the midpoint
+// the state is saved and two clones are taken: a fork that holds A and
+// runs ahead, so its page writes would show in the parent's goldens if
+// they leaked, and a twin that must repeat the parent once the parent has
+// run past it. The twin first reloads the saved state, which must leave
+// all of its pages shared. Only the parent's own frames are timed.
+void RunJob(Job& job, u64 frames) {
+  auto start = std::chrono::steady_clock::now();
+  auto console = std::make_unique<sz::console::SuperZ80Console>();
+  console->PowerOn();
+  job.loaded = console->LoadCartridge(job.rom.data(), job.rom.size());
+  if (!job.loaded) {
+    return;
+  }
+  console->Reset();
+  job.hashes.reserve(frames);
+  const u64 save_frame = (frames - 1) / 2;
+  std::vector<u8> saved;
+  std::vector<ReplayFrame> replay;
+  std::unique_ptr<sz::console::SuperZ80Console> twin;
+  std::vector<ReplayFrame> forked;
+  for (u64 frame = 0; frame < frames; ++frame) {
+    console->StepFrame();
+    job.hashes.push_back({console->GetFramebufferHash(), console->GetAudioHash()});
+    if (frame == save_frame) {
+      const auto paused = std::chrono::steady_clock::now();
+      console->SaveState(saved);
+      twin = console->Clone();
+      // Reloading the state the twin already holds must keep every page shared.
+      if (!twin->LoadState(saved.data(), saved.size()) || twin->GetPrivatePageCount() != 0) {
+        job.determinism_error = "reloading an identical state unshared pages";
+      }
+      auto fork = console->Clone();
+      sz::input::HostButtons held;
+      held.a = true;
+      fork->SetHostButtons(0, held);
+      for (u64 i = 0; i < kReplayFrames; ++i) {
+        fork->StepFrame();
+        forked.push_back(HashFrame(*fork));
+      }
+      start += std::chrono::steady_clock::now() - paused;
+    } else if (frame > save_frame && replay.size() < kReplayFrames) {
+      replay.push_back({job.hashes.back(), console->GetStateHash()});
+    }
+  }
+  job.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  CheckTwin(job, *twin, save_frame, replay);
+  if (job.determinism_error.empty() && job.reads_pads &&
+      std::equal(forked.begin(), forked.end(), replay.begin(), replay.end(), SameFrame)) {
+    job.determinism_error = "fork ignored its input";
+  }
+  if (job.determinism_error.empty()) {
+    CheckCorruptLoads(job, *console, saved);
+  }
+  if (job.determinism_error.empty()) {
+    CheckRoundTrip(job, *console, saved, save_frame, replay);
+  }
+}
+
+void RunAll(std::vector<Job>& jobs, u64 frames, unsigned threads) {
+  sz::util::WorkStealingPool pool(threads);
+  for (Job& job : jobs) {
+    pool.Submit([&job, frames] { RunJob(job, frames); });
+  }
+  pool.Wait();
+}
+
+bool ReadGolden(const std::string& path, std::vector<FrameHash>& out) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    unsigned long long frame = 0;
+    unsigned long long video = 0;
+    unsigned long long audio = 0;
+    if (std::sscanf(line.c_str(), "%llu %llx %llx", &frame, &video, &audio) != 3 || frame != out.size()) {
+      SZ_LOG_ERROR("%s: malformed line %zu", path.c_str(), out.size() + 1);
+      return false;
+    }
+    out.push_back({video, audio});
+  }
+  return true;
+}
+
+bool WriteGolden(const std::string& path, const Job& job) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    SZ_LOG_ERROR("Cannot write %s", path.c_str());
+    return false;
+  }
+  std::fprintf(file, "# superz80_regress %s: frame, framebuffer hash, audio hash\n", job.name.c_str());
+  for (size_t frame = 0; frame < job.hashes.size(); ++frame) {
+    std::fprintf(file, "%zu %016" PRIx64 " %016" PRIx64 "\n", frame, job.hashes[frame].video,
+                 job.hashes[frame].audio);
+  }
+  return std::fclose(file) == 0;
+}
+
+Report Check(const Job& job, const Options& options) {
+  Report report;
+  if (!job.loaded) {
+    report.outcome = Outcome::LoadFailed;
+    return report;
+  }
+  if (!job.determinism_error.empty()) {
+    report.outcome = Outcome::Nondeterministic;
+    return report;
+  }
+  const std::string path = options.golden_dir + "/" + job.name + ".golden";
+  if (options.update) {
+    report.outcome = WriteGolden(path, job) ? Outcome::Updated : Outcome::Mismatch;
+    return report;
+  }
+  std::vector<FrameHash> golden;
+  if (!ReadGolden(path, golden) || golden.empty()) {
+    report.outcome = Outcome::NoGolden;
+    return report;
+  }
+  // A golden file recorded with fewer frames only covers that prefix.
+  if (golden.size() < job.hashes.size()) {
+    SZ_LOG_WARN("%s: golden has %zu frames, checking those only", job.name.c_str(), golden.size());
+  }
+  const size_t count = std::min(golden.size(), job.hashes.size());
+  for (size_t frame = 0; frame < count; ++frame) {
+    report.video_bad = golden[frame].video != job.hashes[frame].video;
+    report.audio_bad = golden[frame].audio != job.hashes[frame].audio;
+    if (report.video_bad || report.audio_bad) {
+      report.outcome = Outcome::Mismatch;
+      report.first_bad_frame = frame;
+      return report;
+    }
+  }
+  return report;
+}
+
+const char* OutcomeText(Outcome outcome) {
+  switch (outcome) {
+    case Outcome::Pass:
+      return "pass";
+    case Outcome::Updated:
+      return "updated";
+    case Outcome::Mismatch:
+      return "MISMATCH";
+    case Outcome::NoGolden:
+      return "NO GOLDEN";
+    case Outcome::LoadFailed:
+      return "LOAD FAILED";
+    case Outcome::Nondeterministic:
+      return "NONDETERMINISTIC";
+  }
+  return "?";
+}
+
+bool ParseU64(const char* text, u64& out) {
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 10);
+  if (end == text || *end != '\0') {
+    return false;
+  }
+  out = value;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    bool ok = true;
+    u64 value = 0;
+    if (arg == "--golden" && i + 1 < argc) {
+      options.golden_dir = argv[++i];
+    } else if (arg == "--rom" && i + 1 < argc) {
+      options.rom_paths.push_back(argv[++i]);
+    } else if (arg == "--filter" && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--frames" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.frames) && options.frames > 0;
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], value) && value > 0;
+      options.jobs = static_cast<unsigned>(value);
+    } else if (arg == "--update") {
+      options.update = true;
+    } else if (arg == "--help") {
+      SZ_LOG_INFO("Usage: superz80_regress [--golden DIR] [--rom PATH]... [--filter SUBSTR] [--frames N] "
+                  "[--jobs N] [--update]");
+      return 0;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      SZ_LOG_ERROR("Bad argument: %s", arg.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<Job> jobs;
+  jobs.push_back(MakeJob("diagnostic", sz::tools::kDiagnosticCartridge));
+  jobs.push_back(MakeJob("bench_cart", sz::tools::kBenchCartridge));
+  jobs.back().reads_pads = true;
+  jobs.push_back(MakeJob("psg_sweep", sz::tools::kPsgSweepCartridge));
+  for (const std::string& path : options.rom_paths) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      SZ_LOG_ERROR("Cannot open ROM %s", path.c_str());
+      return 2;
+    }
+    jobs.push_back(MakeJob(StemOf(path), std::vector<u8>(std::istreambuf_iterator<char>(file), {})));
+  }
+  if (!options.filter.empty()) {
+    std::erase_if(jobs, [&](const Job& job) { return job.name.find(options.filter) == std::string::npos; });
+  }
+
+  unsigned threads = options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(jobs.size(), 1)));
+
+  // Power-on and cartridge logs from several workers would interleave.
+  sz::log::Logger::SetLevel(sz::log::Level::Warn);
+
+  const auto start = std::chrono::steady_clock::now();
+  RunAll(jobs, options.frames, threads);
+  const double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  int failures = 0;
+  int missing = 0;
+  double cpu_ms = 0.0;
+  std::printf("%-20s %8s %10s %10s  %s\n", "rom", "frames", "wall ms", "frames/s", "result");
+  for (const Job& job : jobs) {
+    const Report report = Check(job, options);
+    cpu_ms += job.wall_ms;
+    std::printf("%-20s %8zu %10.1f %10.0f  %s", job.name.c_str(), job.hashes.size(), job.wall_ms,
+                job.wall_ms > 0.0 ? job.hashes.size() * 1000.0 / job.wall_ms : 0.0, OutcomeText(report.outcome));
+    if (report.outcome == Outcome::Mismatch && (report.video_bad || report.audio_bad)) {
+      std::printf(" at frame %" PRIu64 " (%s%s%s)", report.first_bad_frame, report.video_bad ? "video" : "",
+                  report.video_bad && report.audio_bad ? ", " : "", report.audio_bad ? "audio" : "");
+    } else if (report.outcome == Outcome::Nondeterministic) {
+      std::printf(" (%s)", job.determinism_error.c_str());
+    }
+    std::printf("\n");
+    if (report.outcome != Outcome::Pass && report.outcome != Outcome::Updated) {
+      ++failures;
+    }
+    missing += report.outcome == Outcome::NoGolden ? 1 : 0;
+  }
+  std::printf("%zu ROM(s) on %u thread(s): %.1f ms wall, %.1f ms summed (%.2fx)\n", jobs.size(), threads, total_ms,
+              cpu_ms, total_ms > 0.0 ? cpu_ms / total_ms : 0.0);
+  if (missing > 0) {
+    std::printf("%d ROM(s) have no golden file in %s; record them with --update\n", missing,
+                options.golden_dir.c_str());
+  }
+  return failures > 0 ? 1 : 0;
+}
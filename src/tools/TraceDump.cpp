@@ -0,0 +1,134 @@
+// superz80_tracedump: decodes a --cpu-trace file and prints one line per
+// instruction with disassembly and registers, optionally filtered by frame
+// range and PC range.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "core/log/Logger.h"
+#include "cpu/ExecTrace.h"
+#include "cpu/Z80Disassembler.h"
+
+namespace {
+struct Options {
+  std::string path;
+  u64 from_frame = 0;
+  u64 to_frame = ~0ull;
+  u32 addr_lo = 0x0000;
+  u32 addr_hi = 0xFFFF;
+  u64 limit = 0;  // 0 prints everything
+};
+
+bool ParseU64(const char* text, u64& out, int base = 10) {
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, base);
+  if (end == text || *end != '\0') {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+// "C000" or "C000-C0FF", hex.
+bool ParseAddressRange(const std::string& text, Options& options) {
+  const size_t dash = text.find('-');
+  u64 lo = 0;
+  u64 hi = 0;
+  if (!ParseU64(text.substr(0, dash).c_str(), lo, 16)) {
+    return false;
+  }
+  hi = lo;
+  if (dash != std::string::npos && !ParseU64(text.substr(dash + 1).c_str(), hi, 16)) {
+    return false;
+  }
+  if (lo > hi || hi > 0xFFFF) {
+    return false;
+  }
+  options.addr_lo = static_cast<u32>(lo);
+  options.addr_hi = static_cast<u32>(hi);
+  return true;
+}
+
+void PrintRecord(u64 frame, const sz::cpu::ExecTraceRecord& record) {
+  char bytes[3 * sz::cpu::kMaxInstructionLength + 1] = {};
+  char mnemonic[32];
+  const char* text = "INT";
+  int length = 0;
+  if (record.kind == sz::cpu::kExecTraceInstruction) {
+    length = sz::cpu::Disassemble(record.opcode.data(), record.pc, mnemonic, sizeof(mnemonic));
+    text = mnemonic;
+  }
+  for (int i = 0; i < length; ++i) {
+    std::snprintf(bytes + 3 * i, sizeof(bytes) - 3 * i, "%02X ", record.opcode[i]);
+  }
+  std::printf("%6llu %12llu  %04X  %-12s %-18s AF=%04X BC=%04X DE=%04X HL=%04X IX=%04X IY=%04X SP=%04X %s IM%u\n",
+              static_cast<unsigned long long>(frame), static_cast<unsigned long long>(record.cycle), record.pc,
+              bytes, text, record.af, record.bc, record.de, record.hl, record.ix, record.iy, record.sp,
+              (record.flags & 0x01) ? "EI" : "DI", (record.flags >> 2) & 0x03);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    bool ok = true;
+    if (arg == "--from-frame" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.from_frame);
+    } else if (arg == "--to-frame" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.to_frame);
+    } else if (arg == "--addr" && i + 1 < argc) {
+      ok = ParseAddressRange(argv[++i], options);
+    } else if (arg == "--limit" && i + 1 < argc) {
+      ok = ParseU64(argv[++i], options.limit);
+    } else if (arg == "--help") {
+      SZ_LOG_INFO("Usage: superz80_tracedump FILE [--from-frame N] [--to-frame N] [--addr HEX[-HEX]] "
+                  "[--limit N]");
+      return 0;
+    } else if (options.path.empty() && arg[0] != '-') {
+      options.path = arg;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      SZ_LOG_ERROR("Bad argument: %s", arg.c_str());
+      return 2;
+    }
+  }
+  if (options.path.empty()) {
+    SZ_LOG_ERROR("No trace file given (see --help)");
+    return 2;
+  }
+
+  sz::cpu::ExecTraceReader reader;
+  if (!reader.Open(options.path)) {
+    return 1;
+  }
+
+  sz::cpu::ExecTraceRecord record;
+  u64 frame = 0;
+  u64 printed = 0;
+  while (reader.Next(record)) {
+    if (record.kind == sz::cpu::kExecTraceFrame) {
+      frame = record.cycle;
+      if (frame > options.to_frame) {
+        break;
+      }
+      continue;
+    }
+    if (frame < options.from_frame || frame > options.to_frame || record.pc < options.addr_lo ||
+        record.pc > options.addr_hi) {
+      continue;
+    }
+    PrintRecord(frame, record);
+    if (options.limit != 0 && ++printed >= options.limit) {
+      break;
+    }
+  }
+  if (!reader.Ok()) {
+    SZ_LOG_ERROR("%s: trace is truncated or corrupt", options.path.c_str());
+    return 1;
+  }
+  return 0;
+}